@@ -3,6 +3,15 @@
 
 import PackageDescription
 
+// Build with BOX2D_DETERMINISTIC=1 in the environment to get the same results on every
+// platform, see B2_DETERMINISTIC in b2_math.h. Only the library is compiled differently.
+var cxxSettings: [CXXSetting] = [
+    .define("B2_LIBRARY_BUILD")
+]
+if Context.environment["BOX2D_DETERMINISTIC"] == "1" {
+    cxxSettings.append(.define("B2_DETERMINISTIC"))
+}
+
 let package = Package(
     name: "box2d",
     platforms: [
@@ -17,6 +26,14 @@ let package = Package(
     targets: [
         .target(
             name: "box2d",
+            cxxSettings: cxxSettings,
+            swiftSettings: [
+                .interoperabilityMode(.Cxx)
+            ]
+        ),
+        .testTarget(
+            name: "box2dTests",
+            dependencies: ["box2d"],
             swiftSettings: [
                 .interoperabilityMode(.Cxx)
             ]
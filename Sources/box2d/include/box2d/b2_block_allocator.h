@@ -48,6 +48,12 @@ public:
 
 	void Clear();
 
+	/// Release chunks that have no live blocks back to the system and sort the free
+	/// lists by address so that later allocations fill the remaining chunks front to back.
+	/// Live blocks are never moved.
+	/// @return the number of chunks released.
+	int32 Compact();
+
 private:
 
 	b2Chunk* m_chunks;
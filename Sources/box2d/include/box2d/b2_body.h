@@ -26,6 +26,7 @@
 #include <swift/bridging>
 
 #include "b2_api.h"
+#include "b2_id.h"
 #include "b2_math.h"
 #include "b2_shape.h"
 
@@ -34,6 +35,7 @@ class b2Joint;
 class b2Contact;
 class b2Controller;
 class b2World;
+struct b2Compound;
 struct b2FixtureDef;
 struct b2JointEdge;
 struct b2ContactEdge;
@@ -66,6 +68,8 @@ struct B2_API b2BodyDef
 		awake = true;
 		fixedRotation = false;
 		bullet = false;
+		speculative = false;
+		compound = false;
 		type = b2_staticBody;
 		enabled = true;
 		gravityScale = 1.0f;
@@ -116,6 +120,16 @@ struct B2_API b2BodyDef
 	/// @warning You should use this flag sparingly since it increases processing time.
 	bool bullet;
 
+	/// Use speculative contacts instead of time of impact events for the continuous
+	/// collision of this body. See b2World::SetSpeculativeContacts.
+	bool speculative;
+
+	/// Give the body a single broad-phase proxy that covers its solid fixtures. The
+	/// fixtures are kept in a tree in body coordinates and pair up through that tree.
+	/// This reduces the broad-phase work of bodies with many fixtures, at the price of
+	/// looser bounds. Fixture AABBs of a compound body are in body coordinates.
+	bool compound;
+
 	/// Does this body start out enabled?
 	bool enabled;
 
@@ -319,6 +333,15 @@ public:
 	/// Is this body treated like a bullet for continuous collision detection?
 	bool IsBullet() const;
 
+	/// Should this body use speculative contacts for continuous collision detection?
+	void SetSpeculative(bool flag);
+
+	/// Does this body use speculative contacts for continuous collision detection?
+	bool IsSpeculative() const;
+
+	/// Does this body have a single broad-phase proxy? See b2BodyDef::compound.
+	bool IsCompound() const;
+
 	/// You can disable sleeping on this body. If you disable sleeping, the
 	/// body will be woken.
 	void SetSleepingAllowed(bool flag);
@@ -381,6 +404,13 @@ public:
 	b2BodyUserData& GetUserData();
 	const b2BodyUserData& GetUserData() const;
 
+	/// Get the index of this body in the world. Indices are dense and are reused after
+	/// a body is destroyed. See b2World::GetBody.
+	int32 GetIndex() const;
+
+	/// Get the generation-checked handle of this body.
+	b2BodyId GetId() const;
+
 	/// Get the parent world of this body.
 	b2World* GetWorld();
 	const b2World* GetWorld() const;
@@ -393,7 +423,10 @@ private:
 	friend class b2World;
 	friend class b2Island;
 	friend class b2ContactManager;
+	friend class b2SensorManager;
 	friend class b2ContactSolver;
+	friend class b2Fixture;
+	friend struct b2Compound;
 	friend class b2Contact;
 
 	friend class b2DistanceJoint;
@@ -416,7 +449,10 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_enabledFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_speculativeFlag	= 0x0080,
+		e_movedFlag			= 0x0100,
+		e_movedListedFlag	= 0x0200
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -425,17 +461,25 @@ private:
 	void SynchronizeFixtures();
 	void SynchronizeTransform();
 
+	// The transforms the broad-phase bounds of the fixtures cover.
+	void GetSweptTransforms(b2Transform* xf1, b2Transform* xf2) const;
+
 	// This is used to prevent connected bodies from colliding.
 	// It may lie, depending on the collideConnected flag.
 	bool ShouldCollide(const b2Body* other) const;
 
 	void Advance(float t);
 
+	// Record a sleep or wake event in the world.
+	void ReportAwake(bool flag);
+
 	b2BodyType m_type;
 
 	uint16 m_flags;
 
 	int32 m_islandIndex;
+	int32 m_index;
+	uint32 m_generation;
 
 	b2Transform m_xf;		// the body origin transform
 	b2Sweep m_sweep;		// the swept motion for CCD
@@ -453,6 +497,9 @@ private:
 	b2Fixture* m_fixtureList;
 	int32 m_fixtureCount;
 
+	// The shared proxy of a compound body, otherwise null.
+	b2Compound* m_compound;
+
 	b2JointEdge* m_jointList;
 	b2ContactEdge* m_contactList;
 
@@ -636,6 +683,16 @@ inline bool b2Body::IsBullet() const
 	return (m_flags & e_bulletFlag) == e_bulletFlag;
 }
 
+inline bool b2Body::IsSpeculative() const
+{
+	return (m_flags & e_speculativeFlag) == e_speculativeFlag;
+}
+
+inline bool b2Body::IsCompound() const
+{
+	return m_compound != nullptr;
+}
+
 inline void b2Body::SetAwake(bool flag)
 {
 	if (m_type == b2_staticBody)
@@ -643,6 +700,11 @@ inline void b2Body::SetAwake(bool flag)
 		return;
 	}
 
+	if (flag != IsAwake())
+	{
+		ReportAwake(flag);
+	}
+
 	if (flag)
 	{
 		m_flags |= e_awakeFlag;
@@ -860,7 +922,7 @@ inline void b2Body::ApplyAngularImpulse(float impulse, bool wake)
 
 inline void b2Body::SynchronizeTransform()
 {
-	m_xf.q.Set(m_sweep.a);
+	m_xf.q = m_sweep.q;
 	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
 }
 
@@ -870,10 +932,24 @@ inline void b2Body::Advance(float alpha)
 	m_sweep.Advance(alpha);
 	m_sweep.c = m_sweep.c0;
 	m_sweep.a = m_sweep.a0;
-	m_xf.q.Set(m_sweep.a);
+	m_sweep.q = m_sweep.q0;
+	m_xf.q = m_sweep.q;
 	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
 }
 
+inline int32 b2Body::GetIndex() const
+{
+	return m_index;
+}
+
+inline b2BodyId b2Body::GetId() const
+{
+	b2BodyId id;
+	id.index = m_index;
+	id.generation = m_generation;
+	return id;
+}
+
 inline b2World* b2Body::GetWorld()
 {
 	return m_world;
@@ -60,6 +60,10 @@ public:
 	/// call UpdatePairs to finalized the proxy pairs (for your time step).
 	void MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement);
 
+	/// Find which of many proxies MoveProxy would re-insert, so the others can be skipped.
+	/// @see b2DynamicTree::TestMoves
+	void TestMoves(const int32* proxyIds, const b2AABB* aabbs, const b2Vec2* displacements, int32 count, bool* needsMove) const;
+
 	/// Call to trigger a re-processing of it's pairs on the next call to UpdatePairs.
 	void TouchProxy(int32 proxyId);
 
@@ -108,12 +112,49 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Compact the proxy tree and trim the move and pair buffers to their contents.
+	/// Compacting the tree can give proxies new ids. The callback is told about each
+	/// one through ProxyMoved(userData, newProxyId).
+	/// @param maxMoves the maximum number of tree nodes to move in this call, zero for no limit.
+	/// @return true if compaction is complete, false if more calls are needed.
+	template <typename T>
+	bool Compact(T* callback, int32 maxMoves);
+
+	/// Get the number of bytes written by SaveState.
+	int32 GetStateSize() const;
+
+	/// Copy the tree and the pending moves into a buffer of GetStateSize() bytes.
+	void SaveState(void* buffer) const;
+
+	/// Overwrite the broad-phase with a state written by SaveState.
+	/// @return the number of bytes read.
+	int32 RestoreState(const void* buffer);
+
+	/// Get the size of a state written by SaveState from its first bytes.
+	/// @return zero if the state is malformed or does not fit in size bytes.
+	static int32 ReadStateSize(const void* buffer, int32 size);
+
 private:
 
 	friend class b2DynamicTree;
 
+	template <typename T>
+	struct CompactCallback
+	{
+		void ProxyMoved(int32 oldProxyId, int32 newProxyId)
+		{
+			broadPhase->RemapMove(oldProxyId, newProxyId);
+			callback->ProxyMoved(broadPhase->m_tree.GetUserData(newProxyId), newProxyId);
+		}
+
+		b2BroadPhase* broadPhase;
+		T* callback;
+	};
+
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
+	void RemapMove(int32 oldProxyId, int32 newProxyId);
+	void ShrinkBuffers();
 
 	bool QueryCallback(int32 proxyId);
 
@@ -144,6 +185,11 @@ inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 	return b2TestOverlap(aabbA, aabbB);
 }
 
+inline void b2BroadPhase::TestMoves(const int32* proxyIds, const b2AABB* aabbs, const b2Vec2* displacements, int32 count, bool* needsMove) const
+{
+	m_tree.TestMoves(proxyIds, aabbs, displacements, count, needsMove);
+}
+
 inline const b2AABB& b2BroadPhase::GetFatAABB(int32 proxyId) const
 {
 	return m_tree.GetFatAABB(proxyId);
@@ -235,4 +281,16 @@ inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 	m_tree.ShiftOrigin(newOrigin);
 }
 
+template <typename T>
+inline bool b2BroadPhase::Compact(T* callback, int32 maxMoves)
+{
+	CompactCallback<T> compactCallback;
+	compactCallback.broadPhase = this;
+	compactCallback.callback = callback;
+
+	bool done = m_tree.Compact(&compactCallback, maxMoves);
+	ShrinkBuffers();
+	return done;
+}
+
 #endif
@@ -33,6 +33,7 @@
 /// queries, and TOI queries.
 
 class b2Shape;
+class b2CapsuleShape;
 class b2CircleShape;
 class b2EdgeShape;
 class b2PolygonShape;
@@ -236,6 +237,37 @@ B2_API void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygonA, const b2Transform& xfA,
 					   const b2PolygonShape* polygonB, const b2Transform& xfB);
 
+/// Compute the collision manifold between two polygons with the scalar loops, even
+/// where b2CollidePolygons uses vector instructions. The result is the same, this
+/// exists to check that.
+B2_API void b2CollidePolygonsScalar(b2Manifold* manifold,
+							 const b2PolygonShape* polygonA, const b2Transform& xfA,
+							 const b2PolygonShape* polygonB, const b2Transform& xfB);
+
+/// The edge normal that separated two polygons in the last call to b2CollidePolygons.
+/// Keep one per polygon pair across time steps so that axis is tested first.
+struct B2_API b2SeparatingAxisCache
+{
+	enum Type
+	{
+		e_empty,
+		e_edgeA,
+		e_edgeB
+	};
+
+	uint8 type;		///< the polygon that owns the edge, e_empty if they overlapped
+	uint8 edge;		///< the edge index on that polygon
+};
+
+/// Compute the collision manifold between two polygons, testing the cached separating
+/// axis first. The result is the same as without the cache.
+/// @return true if the cached axis still separates the polygons. The manifold is
+/// empty then and the full test was skipped.
+B2_API bool b2CollidePolygons(b2Manifold* manifold,
+					   const b2PolygonShape* polygonA, const b2Transform& xfA,
+					   const b2PolygonShape* polygonB, const b2Transform& xfB,
+					   b2SeparatingAxisCache* cache);
+
 /// Compute the collision manifold between an edge and a circle.
 B2_API void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							   const b2EdgeShape* polygonA, const b2Transform& xfA,
@@ -246,11 +278,32 @@ B2_API void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							   const b2EdgeShape* edgeA, const b2Transform& xfA,
 							   const b2PolygonShape* circleB, const b2Transform& xfB);
 
+/// Compute the collision manifold between a capsule and a circle.
+B2_API void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between two capsules.
+B2_API void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a polygon and a capsule.
+B2_API void b2CollidePolygonAndCapsule(b2Manifold* manifold,
+							   const b2PolygonShape* polygonA, const b2Transform& xfA,
+							   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between an edge and a capsule.
+B2_API void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							   const b2EdgeShape* edgeA, const b2Transform& xfA,
+							   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
 /// Clipping for contact manifolds.
 B2_API int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float offset, int32 vertexIndexA);
 
 /// Determine if two generic shapes overlap.
+/// A mesh or height field is tested as a whole, its child index is ignored.
 B2_API bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB);
@@ -73,6 +73,10 @@
 /// Making it larger may create artifacts for vertex collision.
 #define b2_polygonRadius		(2.0f * b2_linearSlop)
 
+/// Speculative contact points are created for shapes that are closer than this
+/// plus the distance they can close in one time step. In meters.
+#define b2_speculativeDistance	(4.0f * b2_linearSlop)
+
 /// Maximum number of sub-steps per contact in continuous physics simulation.
 #define b2_maxSubSteps			8
 
@@ -0,0 +1,91 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_COMPOUND_H
+#define B2_COMPOUND_H
+
+#include "b2_api.h"
+#include "b2_dynamic_tree.h"
+#include "b2_fixture.h"
+
+class b2Body;
+class b2BroadPhase;
+
+/// The broad-phase representation of a compound body, see b2BodyDef::compound.
+/// A single broad-phase proxy covers the solid fixtures of the body. The fixture
+/// proxies live in a tree in body coordinates and their proxy ids refer to that tree,
+/// so moving the body moves one proxy. The contact manager pairs the fixtures through
+/// the tree.
+struct B2_API b2Compound
+{
+	b2Compound(b2Body* body);
+
+	// Insert a fixture proxy. The proxy AABB must be set in body coordinates.
+	void CreateProxy(b2FixtureProxy* proxy);
+
+	// Remove a fixture proxy.
+	void DestroyProxy(b2FixtureProxy* proxy);
+
+	// Create, move or destroy the broad-phase proxy so that it covers the fixtures
+	// over the motion from transform1 to transform2. The proxy is touched when the
+	// body moves far enough that the fixtures must pair up again, even if the proxy
+	// does not leave its fat AABB.
+	void Synchronize(b2BroadPhase* broadPhase, const b2Transform& transform1, const b2Transform& transform2);
+
+	// Bound a fixture proxy in world coordinates over the motion it was last paired
+	// with. This is what pairs the fixture.
+	b2AABB GetFatAABB(int32 proxyId) const;
+
+	// Bound a world AABB in body coordinates over the same motion.
+	b2AABB GetLocalAABB(const b2AABB& aabb) const;
+
+	// Query the fixture proxies that may overlap a world AABB.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	// The proxy comes first so that broad-phase user data can always be read as a
+	// fixture proxy. Its fixture is null.
+	b2FixtureProxy m_proxy;
+
+	b2Body* m_body;
+
+	b2DynamicTree m_tree;
+	int32 m_proxyCount;
+
+	// The bounds of the fixtures in body coordinates and the farthest distance of
+	// these bounds from the body origin. These are computed again on the next
+	// synchronize after a fixture is added or removed.
+	b2AABB m_localAABB;
+	float m_radius;
+	bool m_dirty;
+
+	// The motion the fixtures were last paired over.
+	b2Transform m_transform1, m_transform2;
+};
+
+template <typename T>
+inline void b2Compound::Query(T* callback, const b2AABB& aabb) const
+{
+	m_tree.Query(callback, GetLocalAABB(aabb));
+}
+
+#endif
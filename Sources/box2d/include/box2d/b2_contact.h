@@ -38,6 +38,7 @@ class b2World;
 class b2BlockAllocator;
 class b2StackAllocator;
 class b2ContactListener;
+class b2ContactManager;
 
 /// Friction mixing law. The idea is to allow either fixture to drive the friction to zero.
 /// For example, anything slides on ice.
@@ -63,11 +64,13 @@ typedef b2Contact* b2ContactCreateFcn(	b2Fixture* fixtureA, int32 indexA,
 										b2Fixture* fixtureB, int32 indexB,
 										b2BlockAllocator* allocator);
 typedef void b2ContactDestroyFcn(b2Contact* contact, b2BlockAllocator* allocator);
+typedef void b2ContactManifoldFcn(b2Contact** contacts, int32 count, b2ContactManager* manager);
 
 struct B2_API b2ContactRegister
 {
 	b2ContactCreateFcn* createFcn;
 	b2ContactDestroyFcn* destroyFcn;
+	b2ContactManifoldFcn* manifoldFcn;
 	bool primary;
 };
 
@@ -171,6 +174,7 @@ protected:
 	friend class b2ContactManager;
 	friend class b2World;
 	friend class b2ContactSolver;
+	friend class b2Island;
 	friend class b2Body;
 	friend class b2Fixture;
 
@@ -193,14 +197,29 @@ protected:
 		e_bulletHitFlag		= 0x0010,
 
 		// This contact has a valid TOI in m_toi
-		e_toiFlag			= 0x0020
+		e_toiFlag			= 0x0020,
+
+		// This contact uses speculative points instead of TOI events
+		e_speculativeFlag	= 0x0040,
+
+		// The manifold holds a speculative point, the shapes are not touching
+		e_speculativePointFlag	= 0x0080,
+
+		// One of the fixtures wants hit events
+		e_hitEventFlag		= 0x0100,
+
+		// The last narrow phase stopped at the cached separating axis
+		e_cachedAxisFlag	= 0x0200,
+
+		// The last narrow phase kept the old manifold
+		e_reusedManifoldFlag	= 0x0400
 	};
 
 	/// Flag this contact for filtering. Filtering will occur the next time step.
 	void FlagForFiltering();
 
 	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
-						b2Shape::Type typeA, b2Shape::Type typeB);
+						b2ContactManifoldFcn* manifoldFcn, b2Shape::Type typeA, b2Shape::Type typeB);
 	static void InitializeRegisters();
 	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2Shape::Type typeA, b2Shape::Type typeB, b2BlockAllocator* allocator);
@@ -210,7 +229,21 @@ protected:
 	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	virtual ~b2Contact() {}
 
-	void Update(b2ContactListener* listener);
+	void Update(b2ContactManager* manager);
+
+	// The parts of Update around the narrow phase, for updating contacts in batches.
+	void BeginUpdate();
+	void FinishUpdate(b2ContactManager* manager, const b2Manifold& oldManifold);
+
+	// Compute the manifolds of contacts of type T with direct calls.
+	template <typename T>
+	static void UpdateManifolds(b2Contact** contacts, int32 count, b2ContactManager* manager);
+
+	// Compute m_manifold for the current body transforms. Contact types can override
+	// this to keep narrow phase state across time steps.
+	virtual void UpdateManifold(b2ContactManager* manager, const b2Transform& xfA, const b2Transform& xfB);
+	void AddSpeculativePoint(float dt);
+	void UpdateSpeculativeFlag(bool speculativeContacts);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
@@ -236,6 +269,10 @@ protected:
 	int32 m_toiCount;
 	float m_toi;
 
+	// Larger for contacts nearer the head of the contact list. Breaks ties between
+	// equal TOIs, see b2World::SolveTOI.
+	uint32 m_toiOrder;
+
 	float m_friction;
 	float m_restitution;
 	float m_restitutionThreshold;
@@ -25,11 +25,16 @@
 
 #include "b2_api.h"
 #include "b2_broad_phase.h"
+#include "b2_growable_array.h"
+#include "b2_sensor_manager.h"
+#include "b2_world_callbacks.h"
 
 class b2Contact;
-class b2ContactFilter;
-class b2ContactListener;
 class b2BlockAllocator;
+class b2Fixture;
+struct b2Compound;
+struct b2FixtureProxy;
+class b2TaskExecutor;
 
 // Delegate of b2World.
 class B2_API b2ContactManager
@@ -40,18 +45,101 @@ public:
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
+	// Pair two fixture proxies. Meshes and height fields pair up their children.
+	void AddPair(const b2FixtureProxy* proxyA, const b2FixtureProxy* proxyB);
+
+	// Create a contact for two fixture children unless it exists or is filtered.
+	void AddPair(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
+
+	// Pair the fixtures of a compound body with a proxy, which may be another compound body.
+	void AddCompoundPairs(const b2Compound* compound, const b2FixtureProxy* proxy);
+
+	// Pair the mesh segments near a proxy with its fixture child.
+	void AddMeshPairs(b2Fixture* mesh, const b2FixtureProxy* proxy);
+
+	// Pair the height field cells under a proxy with its fixture child.
+	void AddHeightFieldPairs(b2Fixture* heightField, const b2FixtureProxy* proxy);
+
+	// The fat AABB of a fixture proxy in world coordinates. The proxies of a compound
+	// body are bounded by their fat AABB in the body tree.
+	b2AABB GetFatAABB(const b2FixtureProxy* proxy) const;
+
+	// Broad-phase callback for compaction.
+	void ProxyMoved(void* proxyUserData, int32 proxyId);
+
 	void FindNewContacts();
 
+	// Link a new contact into the world and body contact lists.
+	void InsertContact(b2Contact* c);
+
 	void Destroy(b2Contact* c);
 
 	void Collide();
 
+	// Compute the manifolds of the contacts in m_updateContacts grouped by shape pair,
+	// then finish their updates in list order.
+	void UpdateContacts();
+
+	// Report events to the listener and to the event buffers.
+	void BeginContact(b2Contact* c);
+	void EndContact(b2Contact* c);
+	void BeginSensorOverlap(b2Fixture* sensor, b2Fixture* visitor);
+	void EndSensorOverlap(b2Fixture* sensor, b2Fixture* visitor);
+	void HitContact(b2Contact* c, const b2ContactHitEvent* event);
+
+	// Drop the buffered events the user could read after the last step. Events
+	// buffered between steps are kept.
+	void DiscardReportedEvents();
+	void MarkEventsReported();
+	void ClearEvents();
+
 	b2BroadPhase m_broadPhase;
+	b2SensorManager m_sensorManager;
 	b2Contact* m_contactList;
 	int32 m_contactCount;
+
+	// Handed to each inserted contact as b2Contact::m_toiOrder.
+	uint32 m_nextToiOrder;
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
+	b2TaskExecutor* m_taskExecutor;
 	b2BlockAllocator* m_allocator;
+
+	// Use speculative contacts for all pairs.
+	bool m_speculativeContacts;
+
+	// The time step being simulated, used to limit speculative points.
+	float m_dt;
+
+	// Buffered events, see b2World::GetContactEvents.
+	bool m_contactEvents;
+	b2GrowableArray<b2ContactBeginTouchEvent> m_beginEvents;
+	b2GrowableArray<b2ContactEndTouchEvent> m_endEvents;
+	b2GrowableArray<b2SensorTouchEvent> m_sensorBeginEvents;
+	b2GrowableArray<b2SensorTouchEvent> m_sensorEndEvents;
+	b2GrowableArray<b2ContactHitEvent> m_hitEvents;
+	int32 m_reportedBeginCount;
+	int32 m_reportedEndCount;
+	int32 m_reportedSensorBeginCount;
+	int32 m_reportedSensorEndCount;
+	int32 m_reportedHitCount;
+
+	// Contacts must approach faster than this to report a hit event.
+	float m_hitEventThreshold;
+
+	// Polygon contacts keep their manifold within this relative motion.
+	float m_reuseLinearTolerance;
+	float m_reuseAngularTolerance;
+
+	// Update contacts in batches, see b2World::SetBatchedNarrowPhase.
+	bool m_batchedNarrowPhase;
+	b2GrowableArray<b2Contact*> m_updateContacts;
+	b2GrowableArray<b2Contact*> m_batchContacts;
+	b2GrowableArray<b2Manifold> m_oldManifolds;
+
+	// Narrow phase shortcuts taken in the last call to Collide.
+	int32 m_separatingAxisHits;
+	int32 m_manifoldReuses;
 };
 
 #endif
@@ -27,6 +27,7 @@
 #include "b2_math.h"
 
 class b2Shape;
+class b2TaskExecutor;
 
 /// A distance proxy is used by the GJK algorithm.
 /// It encapsulates any shape.
@@ -98,6 +99,29 @@ B2_API void b2Distance(b2DistanceOutput* output,
 				b2SimplexCache* cache,
 				const b2DistanceInput* input);
 
+/// Input for b2DistanceMany. The shapes are read directly, so no b2DistanceProxy is needed.
+struct B2_API b2ShapeDistanceInput
+{
+	const b2Shape* shapeA;
+	const b2Shape* shapeB;
+	int32 childIndexA;
+	int32 childIndexB;
+	b2Transform transformA;
+	b2Transform transformB;
+	bool useRadii;
+};
+
+/// Compute the closest points between many pairs of shapes, each like b2Distance with its
+/// own simplex cache. Pairs of circles, and a circle outside a polygon, are solved in closed
+/// form and report zero iterations. The caches they leave warm start GJK as usual.
+/// @param outputs, caches, inputs arrays of count entries.
+/// @param executor runs the pairs in parallel, may be nullptr.
+B2_API void b2DistanceMany(b2DistanceOutput* outputs,
+				b2SimplexCache* caches,
+				const b2ShapeDistanceInput* inputs,
+				int32 count,
+				b2TaskExecutor* executor = nullptr);
+
 /// Input parameters for b2ShapeCast
 struct B2_API b2ShapeCastInput
 {
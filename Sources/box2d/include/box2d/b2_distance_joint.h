@@ -141,6 +141,10 @@ protected:
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
 
+	int32 GetStateSize() const override;
+	void SaveState(void* data) const override;
+	void RestoreState(const void* data) override;
+
 	float m_stiffness;
 	float m_damping;
 	float m_bias;
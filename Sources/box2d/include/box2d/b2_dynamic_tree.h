@@ -86,6 +86,10 @@ public:
 	/// @return true if the proxy was re-inserted.
 	bool MoveProxy(int32 proxyId, const b2AABB& aabb1, const b2Vec2& displacement);
 
+	/// Run the containment test of MoveProxy over many proxies without changing the tree.
+	/// @param needsMove set to true for each proxy that MoveProxy would re-insert.
+	void TestMoves(const int32* proxyIds, const b2AABB* aabbs, const b2Vec2* displacements, int32 count, bool* needsMove) const;
+
 	/// Get proxy user data.
 	/// @return the proxy user data or 0 if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
@@ -133,11 +137,39 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Move live nodes to the front of the node pool and shrink the pool. Useful after
+	/// destroying a large number of proxies. Leaf nodes are proxies, so moving a leaf
+	/// changes its proxy id. The callback is told about each one through
+	/// ProxyMoved(oldProxyId, newProxyId).
+	/// @param maxMoves the maximum number of nodes to move in this call, zero for no limit.
+	/// @return true if the pool is compact, false if more calls are needed.
+	template <typename T>
+	bool Compact(T* callback, int32 maxMoves);
+
+	/// Get the number of bytes written by SaveState.
+	int32 GetStateSize() const;
+
+	/// Copy the tree into a buffer of GetStateSize() bytes. User data pointers are
+	/// copied as they are, so the state can only be restored into the same process.
+	void SaveState(void* buffer) const;
+
+	/// Overwrite the tree with a state written by SaveState.
+	/// @return the number of bytes read.
+	int32 RestoreState(const void* buffer);
+
+	/// Get the size of a state written by SaveState from its first bytes.
+	/// @param nodeCapacity receives the size of the node pool, may be nullptr.
+	/// @return zero if the state is malformed or does not fit in size bytes.
+	static int32 ReadStateSize(const void* buffer, int32 size, int32* nodeCapacity = nullptr);
+
 private:
 
 	int32 AllocateNode();
 	void FreeNode(int32 node);
 
+	void MoveNode(int32 fromId, int32 toId);
+	void ShrinkPool();
+
 	void InsertLeaf(int32 node);
 	void RemoveLeaf(int32 node);
 
@@ -305,4 +337,50 @@ inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) con
 	}
 }
 
+template <typename T>
+inline bool b2DynamicTree::Compact(T* callback, int32 maxMoves)
+{
+	int32 freeId = 0;
+	int32 usedId = m_nodeCapacity - 1;
+	int32 moveCount = 0;
+	bool done = true;
+
+	for (;;)
+	{
+		// Find the lowest free node and the highest live node.
+		while (freeId < usedId && m_nodes[freeId].height != -1)
+		{
+			++freeId;
+		}
+
+		while (usedId > freeId && m_nodes[usedId].height == -1)
+		{
+			--usedId;
+		}
+
+		if (freeId >= usedId)
+		{
+			break;
+		}
+
+		if (maxMoves > 0 && moveCount == maxMoves)
+		{
+			done = false;
+			break;
+		}
+
+		bool leaf = m_nodes[usedId].IsLeaf();
+		MoveNode(usedId, freeId);
+		if (leaf)
+		{
+			callback->ProxyMoved(usedId, freeId);
+		}
+
+		++moveCount;
+	}
+
+	ShrinkPool();
+	return done;
+}
+
 #endif
@@ -71,6 +71,8 @@ struct B2_API b2FixtureDef
 		restitutionThreshold = 1.0f * b2_lengthUnitsPerMeter;
 		density = 0.0f;
 		isSensor = false;
+		enableHitEvents = false;
+		hitEventThreshold = 0.0f;
 	}
 
 	/// The shape, this must be set. The shape will be cloned, so you
@@ -94,9 +96,16 @@ struct B2_API b2FixtureDef
 	float density;
 
 	/// A sensor shape collects contact information but never generates a collision
-	/// response.
+	/// response. Sensors do not create contacts, see b2ContactListener::BeginSensorOverlap.
 	bool isSensor;
 
+	/// Report hit events for contacts of this fixture, see b2ContactListener::ContactHit.
+	bool enableHitEvents;
+
+	/// The approach speed a contact must exceed to report a hit, usually in m/s. The
+	/// larger of the fixture thresholds and the world threshold is used.
+	float hitEventThreshold;
+
 	/// Contact filtering data.
 	b2Filter filter;
 };
@@ -108,6 +117,11 @@ struct B2_API b2FixtureProxy
 	b2Fixture* fixture;
 	int32 childIndex;
 	int32 proxyId;
+
+	// Index in the sensor array for sensor proxies. Sensor proxies live in the
+	// sensor tree and their proxy id refers to that tree. Likewise the solid proxies
+	// of a compound body live in the tree of its b2Compound.
+	int32 sensorIndex;
 };
 
 /// A fixture is used to attach a shape to a body for collision detection. A fixture
@@ -128,7 +142,9 @@ public:
 	b2Shape* GetShape();
 	const b2Shape* GetShape() const;
 
-	/// Set if this fixture is a sensor.
+	/// Set if this fixture is a sensor. This destroys the contacts of a fixture that
+	/// becomes a sensor and ends the overlaps of a sensor that becomes solid.
+	/// @warning This function is locked during callbacks.
 	void SetSensor(bool sensor);
 
 	/// Is this fixture a sensor (non-solid)?
@@ -146,6 +162,18 @@ public:
 	/// Call this if you want to establish collision that was previously disabled by b2ContactFilter::ShouldCollide.
 	void Refilter();
 
+	/// Enable/disable hit events for the contacts of this fixture.
+	void EnableHitEvents(bool flag);
+
+	/// Are hit events enabled for this fixture?
+	bool AreHitEventsEnabled() const;
+
+	/// Set the approach speed threshold for hit events, see b2FixtureDef::hitEventThreshold.
+	void SetHitEventThreshold(float threshold);
+
+	/// Get the approach speed threshold for hit events.
+	float GetHitEventThreshold() const;
+
 	/// Get the parent body of this fixture. This is nullptr if the fixture is not attached.
 	/// @return the parent body.
 	b2Body* GetBody();
@@ -161,6 +189,9 @@ public:
 	b2FixtureUserData& GetUserData();
 	const b2FixtureUserData& GetUserData() const;
 
+	/// Get the generation-checked handle of this fixture.
+	b2FixtureId GetId() const;
+
 	/// Test a point for containment in this fixture.
 	/// @param p a point in world coordinates.
 	bool TestPoint(const b2Vec2& p) const;
@@ -206,7 +237,8 @@ public:
 
 	/// Get the fixture's AABB. This AABB may be enlarge and/or stale.
 	/// If you need a more accurate AABB, compute it using the shape and
-	/// the body transform.
+	/// the body transform. The solid fixtures of a compound body have their
+	/// AABB in body coordinates.
 	const b2AABB& GetAABB(int32 childIndex) const;
 
 	/// Dump this fixture to the log file.
@@ -218,6 +250,8 @@ protected:
 	friend class b2World;
 	friend class b2Contact;
 	friend class b2ContactManager;
+	friend class b2SensorManager;
+	friend struct b2Compound;
 
 	b2Fixture();
 
@@ -250,6 +284,14 @@ protected:
 
 	bool m_isSensor;
 
+	bool m_enableHitEvents;
+	float m_hitEventThreshold;
+
+	// The number of sensor proxies this solid fixture overlaps.
+	int32 m_sensorOverlapCount;
+
+	b2FixtureId m_id;
+
 	b2FixtureUserData m_userData;
 } SWIFT_UNSAFE_REFERENCE;
 
@@ -273,11 +315,31 @@ inline bool b2Fixture::IsSensor() const
 	return m_isSensor;
 }
 
+inline bool b2Fixture::AreHitEventsEnabled() const
+{
+	return m_enableHitEvents;
+}
+
+inline void b2Fixture::SetHitEventThreshold(float threshold)
+{
+	m_hitEventThreshold = threshold;
+}
+
+inline float b2Fixture::GetHitEventThreshold() const
+{
+	return m_hitEventThreshold;
+}
+
 inline const b2Filter& b2Fixture::GetFilterData() const
 {
 	return m_filter;
 }
 
+inline b2FixtureId b2Fixture::GetId() const
+{
+	return m_id;
+}
+
 inline b2FixtureUserData& b2Fixture::GetUserData()
 {
 	return m_userData;
@@ -89,6 +89,10 @@ protected:
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
 
+	int32 GetStateSize() const override;
+	void SaveState(void* data) const override;
+	void RestoreState(const void* data) override;
+
 	b2Joint* m_joint1;
 	b2Joint* m_joint2;
 
@@ -0,0 +1,153 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef B2_GROWABLE_ARRAY_H
+#define B2_GROWABLE_ARRAY_H
+
+#include <string.h>
+
+#include "b2_settings.h"
+
+/// This is a growable array of plain data. The capacity doubles when the
+/// array is full. Elements are moved with memcpy.
+template <typename T>
+class b2GrowableArray
+{
+public:
+	b2GrowableArray()
+	{
+		m_array = nullptr;
+		m_count = 0;
+		m_capacity = 0;
+	}
+
+	~b2GrowableArray()
+	{
+		if (m_array)
+		{
+			b2Free(m_array);
+			m_array = nullptr;
+		}
+	}
+
+	/// Add an element at the end and return it.
+	T& Append()
+	{
+		if (m_count == m_capacity)
+		{
+			T* old = m_array;
+			m_capacity = m_capacity == 0 ? 16 : 2 * m_capacity;
+			m_array = (T*)b2Alloc(m_capacity * sizeof(T));
+			if (old)
+			{
+				memcpy(m_array, old, m_count * sizeof(T));
+				b2Free(old);
+			}
+		}
+
+		++m_count;
+		return m_array[m_count - 1];
+	}
+
+	void Push(const T& element)
+	{
+		Append() = element;
+	}
+
+	/// Set the number of elements. New elements are not initialized.
+	void Resize(int32 count)
+	{
+		if (count > m_capacity)
+		{
+			T* old = m_array;
+			m_capacity = count > 2 * m_capacity ? count : 2 * m_capacity;
+			m_array = (T*)b2Alloc(m_capacity * sizeof(T));
+			if (old)
+			{
+				memcpy(m_array, old, m_count * sizeof(T));
+				b2Free(old);
+			}
+		}
+
+		m_count = count;
+	}
+
+	/// Remove the first count elements and keep the order of the rest.
+	void RemoveFront(int32 count)
+	{
+		b2Assert(0 <= count && count <= m_count);
+		if (count == 0)
+		{
+			return;
+		}
+
+		memmove(m_array, m_array + count, (m_count - count) * sizeof(T));
+		m_count -= count;
+	}
+
+	void RemoveBack()
+	{
+		b2Assert(m_count > 0);
+		--m_count;
+	}
+
+	void Clear()
+	{
+		m_count = 0;
+	}
+
+	T& operator[](int32 index)
+	{
+		b2Assert(0 <= index && index < m_count);
+		return m_array[index];
+	}
+
+	const T& operator[](int32 index) const
+	{
+		b2Assert(0 <= index && index < m_count);
+		return m_array[index];
+	}
+
+	T* GetData()
+	{
+		return m_array;
+	}
+
+	const T* GetData() const
+	{
+		return m_array;
+	}
+
+	int32 GetCount() const
+	{
+		return m_count;
+	}
+
+private:
+	b2GrowableArray(const b2GrowableArray&);
+	b2GrowableArray& operator=(const b2GrowableArray&);
+
+	T* m_array;
+	int32 m_count;
+	int32 m_capacity;
+};
+
+#endif
@@ -0,0 +1,99 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_HANDLES_H
+#define B2_HANDLES_H
+
+#include "b2_api.h"
+#include "b2_body.h"
+#include "b2_id.h"
+#include "b2_joint.h"
+#include "b2_math.h"
+
+struct b2FixtureDef;
+class b2World;
+
+/// Functions that work on generation-checked handles instead of object pointers.
+/// They suit bindings such as Swift, where handles can live in value-type arrays
+/// without boxing. Passing a stale handle asserts, and in release builds the
+/// function does nothing and returns a zero value. Use b2Body_IsValid and friends
+/// to check handles that may be stale.
+
+// World
+
+/// Create a rigid body. Returns a null handle if the world is locked.
+B2_API b2BodyId b2World_CreateBody(b2World* _Nonnull world, const b2BodyDef* _Nonnull def);
+
+/// Destroy a rigid body, see b2World::DestroyBody.
+B2_API void b2World_DestroyBody(b2World* _Nonnull world, b2BodyId bodyId);
+
+/// Create a joint. Returns a null handle if the world is locked.
+B2_API b2JointId b2World_CreateJoint(b2World* _Nonnull world, const b2JointDef* _Nonnull def);
+
+/// Destroy a joint, see b2World::DestroyJoint.
+B2_API void b2World_DestroyJoint(b2World* _Nonnull world, b2JointId jointId);
+
+// Body
+
+B2_API bool b2Body_IsValid(const b2World* _Nonnull world, b2BodyId bodyId);
+
+/// Create a fixture. Returns a null handle if the world is locked.
+B2_API b2FixtureId b2Body_CreateFixture(b2World* _Nonnull world, b2BodyId bodyId, const b2FixtureDef* _Nonnull def);
+
+B2_API b2BodyType b2Body_GetType(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API b2Vec2 b2Body_GetPosition(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API float b2Body_GetAngle(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API b2Transform b2Body_GetTransform(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API b2Vec2 b2Body_GetWorldCenter(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API b2Vec2 b2Body_GetLinearVelocity(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API float b2Body_GetAngularVelocity(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API float b2Body_GetMass(const b2World* _Nonnull world, b2BodyId bodyId);
+B2_API bool b2Body_IsAwake(const b2World* _Nonnull world, b2BodyId bodyId);
+
+B2_API void b2Body_SetTransform(b2World* _Nonnull world, b2BodyId bodyId, b2Vec2 position, float angle);
+B2_API void b2Body_SetLinearVelocity(b2World* _Nonnull world, b2BodyId bodyId, b2Vec2 v);
+B2_API void b2Body_SetAngularVelocity(b2World* _Nonnull world, b2BodyId bodyId, float w);
+B2_API void b2Body_ApplyForceToCenter(b2World* _Nonnull world, b2BodyId bodyId, b2Vec2 force, bool wake);
+B2_API void b2Body_ApplyTorque(b2World* _Nonnull world, b2BodyId bodyId, float torque, bool wake);
+B2_API void b2Body_ApplyLinearImpulseToCenter(b2World* _Nonnull world, b2BodyId bodyId, b2Vec2 impulse, bool wake);
+B2_API void b2Body_SetAwake(b2World* _Nonnull world, b2BodyId bodyId, bool flag);
+
+// Fixture
+
+B2_API bool b2Fixture_IsValid(const b2World* _Nonnull world, b2FixtureId fixtureId);
+
+/// Destroy a fixture, see b2Body::DestroyFixture.
+B2_API void b2Fixture_Destroy(b2World* _Nonnull world, b2FixtureId fixtureId);
+
+B2_API b2BodyId b2Fixture_GetBody(const b2World* _Nonnull world, b2FixtureId fixtureId);
+B2_API bool b2Fixture_IsSensor(const b2World* _Nonnull world, b2FixtureId fixtureId);
+B2_API void b2Fixture_SetSensor(b2World* _Nonnull world, b2FixtureId fixtureId, bool sensor);
+B2_API bool b2Fixture_TestPoint(const b2World* _Nonnull world, b2FixtureId fixtureId, b2Vec2 point);
+
+// Joint
+
+B2_API bool b2Joint_IsValid(const b2World* _Nonnull world, b2JointId jointId);
+B2_API b2JointType b2Joint_GetType(const b2World* _Nonnull world, b2JointId jointId);
+B2_API b2BodyId b2Joint_GetBodyA(const b2World* _Nonnull world, b2JointId jointId);
+B2_API b2BodyId b2Joint_GetBodyB(const b2World* _Nonnull world, b2JointId jointId);
+
+#endif
@@ -0,0 +1,143 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_HEIGHT_FIELD_SHAPE_H
+#define B2_HEIGHT_FIELD_SHAPE_H
+
+#include "b2_api.h"
+#include "b2_shape.h"
+
+#include <swift/bridging>
+
+class b2EdgeShape;
+
+/// A height field is terrain over regularly spaced samples. Sample i is the vertex
+/// (i * spacing, height i) in local coordinates and the cells between samples are
+/// one-sided edges with the surface normal pointing up, smoothed like a chain shape.
+/// The height field has a single broad-phase proxy. The contact manager finds the cells
+/// below a fixture from its x range and creates one contact per cell, with the cell index
+/// as child index A.
+/// The vertical bounds are fixed when the height field is created, so the samples can be
+/// changed while the height field is in use without touching the broad-phase.
+class B2_API b2HeightFieldShape : public b2Shape
+{
+public:
+	b2HeightFieldShape();
+    
+    static b2HeightFieldShape* Create() {
+        return new b2HeightFieldShape();
+    }
+
+	/// The destructor frees the samples using b2Free.
+	~b2HeightFieldShape();
+
+	/// Clear all data.
+	void Clear();
+
+	/// Create the height field.
+	/// @param heights an array of samples, these are copied and clamped to the bounds
+	/// @param count the sample count, at least 2
+	/// @param spacing the horizontal distance between samples
+	/// @param minHeight the lowest height the samples may take
+	/// @param maxHeight the highest height the samples may take
+	void CreateHeights(const float* heights, int32 count, float spacing, float minHeight, float maxHeight);
+
+	/// Change a range of samples. The heights are clamped to the bounds. Bodies resting
+	/// on the cells are not woken up.
+	void SetHeights(int32 start, const float* heights, int32 count);
+
+	/// Get a sample.
+	float GetHeight(int32 index) const;
+
+	/// Get the number of cells, one less than the samples.
+	int32 GetCellCount() const;
+
+	/// Get the range of cells that overlap an x interval in local coordinates.
+	/// @return false if the interval is outside of the height field
+	bool GetCellRange(float lowerX, float upperX, int32* lowerCell, int32* upperCell) const;
+
+	/// Get a cell as a one-sided edge.
+	void GetCellEdge(b2EdgeShape* edge, int32 index) const;
+
+	/// Compute the bounds of one cell.
+	void ComputeCellAABB(b2AABB* aabb, const b2Transform& transform, int32 index) const;
+
+	/// Implement b2Shape. Samples are cloned using b2Alloc.
+	b2Shape* Clone(b2BlockAllocator* allocator) const override;
+
+	/// A height field is a single child.
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const override;
+
+	/// This always return false.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const override;
+
+	/// Walk the cells along the ray and report the first hit.
+	/// @see b2Shape::RayCast
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const override;
+
+	/// The bounds of the height field.
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const override;
+
+	/// Height fields have zero mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float density) const override;
+
+	/// The samples. Owned by this class.
+	float* m_heights;
+
+	/// The sample count.
+	int32 m_count;
+
+	/// The horizontal distance between samples.
+	float m_spacing;
+
+	/// The vertical bounds.
+	float m_minHeight, m_maxHeight;
+} SWIFT_UNSAFE_REFERENCE;
+
+inline b2HeightFieldShape::b2HeightFieldShape()
+{
+	m_type = e_heightField;
+	m_radius = b2_polygonRadius;
+	m_heights = nullptr;
+	m_count = 0;
+	m_spacing = 1.0f;
+	m_minHeight = 0.0f;
+	m_maxHeight = 0.0f;
+}
+
+inline float b2HeightFieldShape::GetHeight(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return m_heights[index];
+}
+
+inline int32 b2HeightFieldShape::GetCellCount() const
+{
+	return m_count - 1;
+}
+
+#endif
@@ -0,0 +1,81 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_ID_H
+#define B2_ID_H
+
+#include "b2_api.h"
+#include "b2_types.h"
+
+/// Handles to world objects. A handle is the index of the object in its world plus
+/// a generation that changes when the object is destroyed, so a stale handle is
+/// detected instead of dangling. Handles are plain values that can be stored in
+/// arrays and compared. A zeroed handle is null. See b2_handles.h.
+struct B2_API b2BodyId
+{
+	int32 index;
+	uint32 generation;
+};
+
+struct B2_API b2FixtureId
+{
+	int32 index;
+	uint32 generation;
+};
+
+struct B2_API b2JointId
+{
+	int32 index;
+	uint32 generation;
+};
+
+inline bool b2IsNull(b2BodyId id)
+{
+	return id.generation == 0;
+}
+
+inline bool b2IsNull(b2FixtureId id)
+{
+	return id.generation == 0;
+}
+
+inline bool b2IsNull(b2JointId id)
+{
+	return id.generation == 0;
+}
+
+inline bool operator == (b2BodyId a, b2BodyId b)
+{
+	return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator == (b2FixtureId a, b2FixtureId b)
+{
+	return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator == (b2JointId a, b2JointId b)
+{
+	return a.index == b.index && a.generation == b.generation;
+}
+
+#endif
@@ -0,0 +1,146 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_ID_POOL_H
+#define B2_ID_POOL_H
+
+#include "b2_growable_array.h"
+
+/// Hands out small integer ids and reuses freed ids, so ids stay dense and
+/// can index arrays.
+class b2IdPool
+{
+public:
+	b2IdPool()
+	{
+		m_nextId = 0;
+	}
+
+	int32 Alloc()
+	{
+		int32 count = m_freeIds.GetCount();
+		if (count > 0)
+		{
+			int32 id = m_freeIds[count - 1];
+			m_freeIds.RemoveBack();
+			return id;
+		}
+
+		return m_nextId++;
+	}
+
+	void Free(int32 id)
+	{
+		b2Assert(0 <= id && id < m_nextId);
+		m_freeIds.Push(id);
+	}
+
+	/// One more than the largest id handed out so far.
+	int32 GetCapacity() const
+	{
+		return m_nextId;
+	}
+
+private:
+	b2GrowableArray<int32> m_freeIds;
+	int32 m_nextId;
+};
+
+/// Objects addressed by generation-checked ids. The generation of a slot is bumped
+/// when its object is removed, so ids of removed objects are rejected even after
+/// the slot is reused. Generations start at one, so a zeroed id is never valid.
+template <typename T>
+class b2SlotArray
+{
+public:
+	/// Add an object and return its index. Its generation is GetGeneration(index).
+	int32 Add(T* object)
+	{
+		int32 index = m_ids.Alloc();
+		if (index == m_objects.GetCount())
+		{
+			m_objects.Push(object);
+			m_generations.Push(1);
+		}
+		else
+		{
+			m_objects[index] = object;
+		}
+
+		return index;
+	}
+
+	void Remove(int32 index)
+	{
+		b2Assert(m_objects[index] != nullptr);
+		m_objects[index] = nullptr;
+		++m_generations[index];
+		m_ids.Free(index);
+	}
+
+	/// Get the object at index, nullptr for free slots.
+	T* Get(int32 index) const
+	{
+		return m_objects[index];
+	}
+
+	/// Get the object at an index from outside the library, nullptr if the index is
+	/// out of range or the slot is free.
+	T* Find(int32 index) const
+	{
+		if (index < 0 || index >= m_objects.GetCount())
+		{
+			return nullptr;
+		}
+
+		return m_objects[index];
+	}
+
+	/// Get the object for an id, nullptr if the id is stale or out of range.
+	T* Get(int32 index, uint32 generation) const
+	{
+		if (index < 0 || index >= m_objects.GetCount() || m_generations[index] != generation)
+		{
+			return nullptr;
+		}
+
+		return m_objects[index];
+	}
+
+	uint32 GetGeneration(int32 index) const
+	{
+		return m_generations[index];
+	}
+
+	/// One more than the largest index in use.
+	int32 GetCapacity() const
+	{
+		return m_objects.GetCount();
+	}
+
+private:
+	b2IdPool m_ids;
+	b2GrowableArray<T*> m_objects;
+	b2GrowableArray<uint32> m_generations;
+};
+
+#endif
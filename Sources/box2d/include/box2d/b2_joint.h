@@ -24,6 +24,7 @@
 #define B2_JOINT_H
 
 #include "b2_api.h"
+#include "b2_id.h"
 #include "b2_math.h"
 
 class b2Body;
@@ -115,9 +116,11 @@ public:
 
 	/// Get the first body attached to this joint.
 	b2Body* GetBodyA();
+	const b2Body* GetBodyA() const;
 
 	/// Get the second body attached to this joint.
 	b2Body* GetBodyB();
+	const b2Body* GetBodyB() const;
 
 	/// Get the anchor point on bodyA in world coordinates.
 	virtual b2Vec2 GetAnchorA() const = 0;
@@ -139,6 +142,9 @@ public:
 	b2JointUserData& GetUserData();
 	const b2JointUserData& GetUserData() const;
 
+	/// Get the generation-checked handle of this joint.
+	b2JointId GetId() const;
+
 	/// Short-cut function to determine if either body is enabled.
 	bool IsEnabled() const;
 
@@ -165,6 +171,9 @@ protected:
 	static b2Joint* Create(const b2JointDef* def, b2BlockAllocator* allocator);
 	static void Destroy(b2Joint* joint, b2BlockAllocator* allocator);
 
+	// The allocation size of a joint type.
+	static int32 GetSize(b2JointType type);
+
 	b2Joint(const b2JointDef* def);
 	virtual ~b2Joint() {}
 
@@ -174,6 +183,13 @@ protected:
 	// This returns true if the position errors are within tolerance.
 	virtual bool SolvePositionConstraints(const b2SolverData& data) = 0;
 
+	// Snapshot support, see b2World::SaveSnapshot. The state holds the settings and
+	// impulses of the joint, not its links or the solver temporaries, which are
+	// rebuilt by the next step. The data may be unaligned.
+	virtual int32 GetStateSize() const = 0;
+	virtual void SaveState(void* data) const = 0;
+	virtual void RestoreState(const void* data) = 0;
+
 	b2JointType m_type;
 	b2Joint* m_prev;
 	b2Joint* m_next;
@@ -183,6 +199,7 @@ protected:
 	b2Body* m_bodyB;
 
 	int32 m_index;
+	b2JointId m_id;
 
 	bool m_islandFlag;
 	bool m_collideConnected;
@@ -200,11 +217,21 @@ inline b2Body* b2Joint::GetBodyA()
 	return m_bodyA;
 }
 
+inline const b2Body* b2Joint::GetBodyA() const
+{
+	return m_bodyA;
+}
+
 inline b2Body* b2Joint::GetBodyB()
 {
 	return m_bodyB;
 }
 
+inline const b2Body* b2Joint::GetBodyB() const
+{
+	return m_bodyB;
+}
+
 inline b2Joint* b2Joint::GetNext()
 {
 	return m_next;
@@ -215,6 +242,11 @@ inline const b2Joint* b2Joint::GetNext() const
 	return m_next;
 }
 
+inline b2JointId b2Joint::GetId() const
+{
+	return m_id;
+}
+
 inline b2JointUserData& b2Joint::GetUserData()
 {
 	return m_userData;
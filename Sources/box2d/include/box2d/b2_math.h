@@ -34,8 +34,100 @@ inline bool b2IsValid(float x)
 	return isfinite(x);
 }
 
+/// Define B2_DETERMINISTIC when building the library to get the same results on every
+/// platform and compiler for the same sequence of calls. This stops the compiler from
+/// fusing multiplies and adds, and replaces the C library trigonometry, which differs
+/// between platforms, with the portable functions below. sqrtf is correctly rounded
+/// by IEEE 754, so it is kept. Do not combine this with -ffast-math.
+/// See also b2World::SetDeterministic.
+/// The mode only changes the library's own sources, which the build marks with
+/// B2_LIBRARY_BUILD, so code using the library does not need the define. The pragmas
+/// hold for the rest of the translation unit. Other build systems should define
+/// B2_LIBRARY_BUILD for the library sources only, or pass -ffp-contract=off.
+#if defined(B2_DETERMINISTIC) && defined(B2_LIBRARY_BUILD)
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+#endif
+
+/// Compute the cosine and sine of an angle with basic arithmetic only. The error is
+/// within a few ulps for angles of moderate size.
+inline void b2PortableCosSin(float angle, float* cosine, float* sine)
+{
+	// Reduce to [-pi/4, pi/4] around the nearest multiple of pi/2. The constant is
+	// split in two so the reduction stays accurate away from zero.
+	float q = floorf(angle * 0.636619772f + 0.5f);
+	float x = angle - q * 1.57079637f;
+	x = x + q * 4.37113900e-08f;
+
+	float x2 = x * x;
+	float s = x + x * x2 * (-1.66666667e-01f + x2 * (8.33333333e-03f + x2 * (-1.98412698e-04f + x2 * 2.75573192e-06f)));
+	float c = 1.0f + x2 * (-0.5f + x2 * (4.16666667e-02f + x2 * (-1.38888889e-03f + x2 * 2.48015873e-05f)));
+
+	switch (int32(q) & 3)
+	{
+	case 0:
+		*cosine = c;
+		*sine = s;
+		break;
+	case 1:
+		*cosine = -s;
+		*sine = c;
+		break;
+	case 2:
+		*cosine = -c;
+		*sine = -s;
+		break;
+	default:
+		*cosine = s;
+		*sine = -c;
+		break;
+	}
+}
+
+/// Compute atan2 with basic arithmetic only. The absolute error is about 1e-5 radians.
+inline float b2PortableAtan2(float y, float x)
+{
+	float ax = fabsf(x);
+	float ay = fabsf(y);
+	float mx = ay > ax ? ay : ax;
+	float mn = ay > ax ? ax : ay;
+	if (mx == 0.0f)
+	{
+		return 0.0f;
+	}
+
+	// Minimax polynomial for atan on [0, 1].
+	float a = mn / mx;
+	float s = a * a;
+	float r = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+
+	if (ay > ax)
+	{
+		r = 1.57079637f - r;
+	}
+
+	if (x < 0.0f)
+	{
+		r = 3.14159274f - r;
+	}
+
+	return y < 0.0f ? -r : r;
+}
+
 #define	b2Sqrt(x)	sqrtf(x)
-#define	b2Atan2(y, x)	atan2f(y, x)
+
+/// Compute atan2. This is b2PortableAtan2 if the library was built with
+/// B2_DETERMINISTIC, otherwise atan2f.
+B2_API float b2Atan2(float y, float x);
+
+/// Compute the cosine and sine of an angle. This is b2PortableCosSin if the library
+/// was built with B2_DETERMINISTIC, otherwise cosf and sinf.
+B2_API void b2CosSin(float angle, float* cosine, float* sine);
 
 /// A 2D column vector.
 struct B2_API b2Vec2
@@ -291,17 +383,13 @@ struct B2_API b2Rot
 	/// Initialize from an angle in radians
 	explicit b2Rot(float angle)
 	{
-		/// TODO_ERIN optimize
-		s = sinf(angle);
-		c = cosf(angle);
+		Set(angle);
 	}
 
 	/// Set using an angle in radians.
 	void Set(float angle)
 	{
-		/// TODO_ERIN optimize
-		s = sinf(angle);
-		c = cosf(angle);
+		b2CosSin(angle, &c, &s);
 	}
 
 	/// Set to the identity rotation
@@ -384,6 +472,7 @@ struct B2_API b2Sweep
 	b2Vec2 localCenter;	///< local center of mass position
 	b2Vec2 c0, c;		///< center world positions
 	float a0, a;		///< world angles
+	b2Rot q0, q;		///< rotations by a0 and a, kept along with the angles by the solver
 
 	/// Fraction of the current time step in the range [0,1]
 	/// c0 and a0 are the positions at alpha0.
@@ -545,6 +634,43 @@ inline b2Rot b2Mul(const b2Rot& q, const b2Rot& r)
 	return qr;
 }
 
+/// Rotate a rotation by an angle without calling the trig functions, then normalize
+/// it so that rounding does not build up. This keeps a rotation in step with an angle
+/// that is integrated by small amounts.
+inline b2Rot b2IntegrateRotation(const b2Rot& q, float deltaAngle)
+{
+	b2Rot dq;
+	float x = deltaAngle;
+	float x2 = x * x;
+	if (x2 < 0.01f)
+	{
+		// Short series are enough for the usual small steps.
+		dq.s = x + x * x2 * (-1.66666667e-01f + x2 * 8.33333333e-03f);
+		dq.c = 1.0f + x2 * (-0.5f + x2 * 4.16666667e-02f);
+	}
+	else if (x2 < 2.5f)
+	{
+		// Up to the largest rotation per step, use the half angle and double it.
+		float h = 0.5f * x;
+		float h2 = h * h;
+		float s = h + h * h2 * (-1.66666667e-01f + h2 * (8.33333333e-03f + h2 * (-1.98412698e-04f + h2 * 2.75573192e-06f)));
+		float c = 1.0f + h2 * (-0.5f + h2 * (4.16666667e-02f + h2 * (-1.38888889e-03f + h2 * 2.48015873e-05f)));
+		dq.s = 2.0f * s * c;
+		dq.c = c * c - s * s;
+	}
+	else
+	{
+		b2PortableCosSin(deltaAngle, &dq.c, &dq.s);
+	}
+
+	// The length is within rounding of one, so one Newton step normalizes it.
+	b2Rot qr = b2Mul(q, dq);
+	float scale = 0.5f * (3.0f - (qr.s * qr.s + qr.c * qr.c));
+	qr.s *= scale;
+	qr.c *= scale;
+	return qr;
+}
+
 /// Transpose multiply two rotations: qT * r
 inline b2Rot b2MulT(const b2Rot& q, const b2Rot& r)
 {
@@ -689,8 +815,7 @@ inline bool b2IsPowerOfTwo(uint32 x)
 inline void b2Sweep::GetTransform(b2Transform* xf, float beta) const
 {
 	xf->p = (1.0f - beta) * c0 + beta * c;
-	float angle = (1.0f - beta) * a0 + beta * a;
-	xf->q.Set(angle);
+	xf->q = b2IntegrateRotation(q0, beta * (a - a0));
 
 	// Shift to origin
 	xf->p -= b2Mul(xf->q, localCenter);
@@ -701,7 +826,9 @@ inline void b2Sweep::Advance(float alpha)
 	b2Assert(alpha0 < 1.0f);
 	float beta = (alpha - alpha0) / (1.0f - alpha0);
 	c0 += beta * (c - c0);
-	a0 += beta * (a - a0);
+	float deltaAngle = beta * (a - a0);
+	a0 += deltaAngle;
+	q0 = b2IntegrateRotation(q0, deltaAngle);
 	alpha0 = alpha;
 }
 
@@ -0,0 +1,157 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_MESH_SHAPE_H
+#define B2_MESH_SHAPE_H
+
+#include "b2_api.h"
+#include "b2_chain_shape.h"
+
+#include <swift/bridging>
+
+/// A node of the segment tree of a mesh shape. The nodes are stored depth first, so the
+/// tree is walked without a stack: a node that is not entered jumps to its skip index.
+struct B2_API b2MeshNode
+{
+	b2AABB aabb;
+
+	/// The segment of a leaf, -1 for internal nodes.
+	int32 segment;
+
+	/// The node after this subtree.
+	int32 skip;
+};
+
+/// A mesh shape is a chain shape for large static geometry such as terrain. A chain puts
+/// one proxy per segment into the broad-phase, a mesh puts a single proxy there and keeps
+/// its own compact tree over the segments. The contact manager queries that tree for the
+/// fixtures that overlap the mesh and creates one contact per nearby segment, with the
+/// same one-sided collision and ghost vertex smoothing as a chain.
+/// Contacts with a mesh use the segment index as child index A.
+/// @warning meshes are meant for static bodies. A moving mesh refreshes its segment
+/// pairs every step, which queries the broad-phase with the whole mesh.
+class B2_API b2MeshShape : public b2ChainShape
+{
+public:
+	b2MeshShape();
+    
+    static b2MeshShape* Create() {
+        return new b2MeshShape();
+    }
+
+	/// The destructor frees the vertices and the tree using b2Free.
+	~b2MeshShape();
+
+	/// Clear all data.
+	void Clear();
+
+	/// Create a loop. This automatically adjusts connectivity.
+	/// @see b2ChainShape::CreateLoop
+	void CreateLoop(const b2Vec2* vertices, int32 count);
+
+	/// Create a chain with ghost vertices to connect multiple chains together.
+	/// @see b2ChainShape::CreateChain
+	void CreateChain(const b2Vec2* vertices, int32 count,
+		const b2Vec2& prevVertex, const b2Vec2& nextVertex);
+
+	/// Implement b2Shape. Vertices and tree are cloned using b2Alloc.
+	b2Shape* Clone(b2BlockAllocator* allocator) const override;
+
+	/// A mesh is a single child.
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const override;
+
+	/// Get the number of segments.
+	int32 GetSegmentCount() const;
+
+	/// Cast a ray against all segments and report the closest hit.
+	/// @see b2Shape::RayCast
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const override;
+
+	/// The bounds of all segments.
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const override;
+
+	/// Compute the bounds of one segment.
+	void ComputeSegmentAABB(b2AABB* aabb, const b2Transform& transform, int32 index) const;
+
+	/// Query the segments that overlap an AABB in local coordinates. The callback class
+	/// must implement bool QueryCallback(int32 segment), return false to stop the query.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	/// The segment tree. Owned by this class.
+	b2MeshNode* m_nodes;
+
+	/// The node count, twice the segment count minus one.
+	int32 m_nodeCount;
+
+private:
+
+	void BuildTree();
+} SWIFT_UNSAFE_REFERENCE;
+
+inline b2MeshShape::b2MeshShape()
+{
+	m_type = e_mesh;
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+}
+
+inline int32 b2MeshShape::GetSegmentCount() const
+{
+	return m_count - 1;
+}
+
+inline void b2MeshShape::ComputeSegmentAABB(b2AABB* aabb, const b2Transform& transform, int32 index) const
+{
+	b2ChainShape::ComputeAABB(aabb, transform, index);
+}
+
+template <typename T>
+inline void b2MeshShape::Query(T* callback, const b2AABB& aabb) const
+{
+	int32 index = 0;
+	while (index < m_nodeCount)
+	{
+		const b2MeshNode* node = m_nodes + index;
+		if (b2TestOverlap(node->aabb, aabb) == false)
+		{
+			index = node->skip;
+			continue;
+		}
+
+		if (node->segment != -1)
+		{
+			bool proceed = callback->QueryCallback(node->segment);
+			if (proceed == false)
+			{
+				return;
+			}
+		}
+
+		++index;
+	}
+}
+
+#endif
@@ -109,6 +109,10 @@ protected:
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
 
+	int32 GetStateSize() const override;
+	void SaveState(void* data) const override;
+	void RestoreState(const void* data) override;
+
 	b2Vec2 m_localAnchorB;
 	b2Vec2 m_targetA;
 	float m_stiffness;
@@ -77,6 +77,10 @@ public:
 	/// @see b2Shape::ComputeAABB
 	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const override;
 
+	/// Both boxes come from one pass over the vertices.
+	/// @see b2Shape::ComputeAABBs
+	void ComputeAABBs(b2AABB* aabb1, b2AABB* aabb2, const b2Transform& xf1, const b2Transform& xf2, int32 childIndex) const override;
+
 	/// @see b2Shape::ComputeMass
 	void ComputeMass(b2MassData* massData, float density) const override;
 
@@ -126,6 +126,10 @@ protected:
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
 
+	int32 GetStateSize() const override;
+	void SaveState(void* data) const override;
+	void RestoreState(const void* data) override;
+
 	b2Vec2 m_groundAnchorA;
 	b2Vec2 m_groundAnchorB;
 	float m_lengthA;
@@ -0,0 +1,111 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef B2_SENSOR_MANAGER_H
+#define B2_SENSOR_MANAGER_H
+
+#include "b2_api.h"
+#include "b2_dynamic_tree.h"
+
+class b2ContactManager;
+class b2Fixture;
+struct b2FixtureProxy;
+
+/// A solid fixture proxy overlapping a sensor. Overlaps are sorted by broad-phase
+/// proxy id, then by child id. The child id is the proxy id in the compound tree for
+/// the fixtures of a compound body and -1 otherwise.
+struct B2_API b2SensorOverlap
+{
+	b2FixtureProxy* proxy;
+	int32 proxyId;
+	int32 childId;
+};
+
+/// The overlap state of one sensor proxy. The overlaps are the ones reported to
+/// the listener, the candidates receive the overlaps found by the next update.
+struct B2_API b2Sensor
+{
+	b2FixtureProxy* proxy;
+
+	b2SensorOverlap* overlaps;
+	int32 overlapCount;
+	int32 overlapCapacity;
+
+	b2SensorOverlap* candidates;
+	int32 candidateCount;
+	int32 candidateCapacity;
+};
+
+// Delegate of b2ContactManager. Sensor fixtures live in their own tree, so they never
+// create contacts or show up in pair finding. Their overlaps with solid fixtures are
+// found once per time step and the changes are reported to the contact listener.
+class B2_API b2SensorManager
+{
+public:
+	b2SensorManager();
+	~b2SensorManager();
+
+	// Insert a sensor proxy. The proxy AABB must be set.
+	void CreateProxy(b2FixtureProxy* proxy);
+
+	// Remove a sensor proxy. This reports the end of its overlaps.
+	void DestroyProxy(b2FixtureProxy* proxy);
+
+	// Move a sensor proxy. The proxy AABB must be set.
+	void MoveProxy(b2FixtureProxy* proxy, const b2Vec2& displacement);
+
+	// Report the end of all overlaps of a solid fixture that is leaving the broad-phase.
+	void RemoveVisitor(b2Fixture* fixture);
+
+	// Find the overlaps of all sensors and report the changes.
+	void Update();
+
+	// Find the overlaps of a single sensor. This only reads the world.
+	void FindOverlaps(b2Sensor* sensor);
+
+	// Solid proxy ids change when the broad-phase is compacted.
+	void SortOverlaps();
+
+	// The overlap of a solid proxy, keyed for sorting.
+	static b2SensorOverlap MakeOverlap(b2FixtureProxy* proxy);
+
+	// Compact the sensor tree.
+	bool Compact(int32 maxMoves);
+
+	// Tree callback for compaction.
+	void ProxyMoved(int32 oldProxyId, int32 newProxyId);
+
+	// Broad-phase callback for finding overlaps.
+	struct OverlapCallback;
+
+	b2DynamicTree m_tree;
+
+	b2Sensor* m_sensors;
+	int32 m_sensorCount;
+	int32 m_sensorCapacity;
+
+	b2ContactManager* m_contactManager;
+
+	// Check all overlaps against the contact filter on the next update.
+	bool m_refilter;
+};
+
+#endif
@@ -55,7 +55,10 @@ public:
 		e_edge = 1,
 		e_polygon = 2,
 		e_chain = 3,
-		e_typeCount = 4
+		e_capsule = 4,
+		e_mesh = 5,
+		e_heightField = 6,
+		e_typeCount = 7
 	};
 
 	virtual ~b2Shape() {}
@@ -89,6 +92,17 @@ public:
 	/// @param childIndex the child shape
 	virtual void ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const = 0;
 
+	/// Compute the axis aligned bounding boxes of a child shape at two transforms. This is
+	/// how the broad-phase covers the motion of a step.
+	/// @param aabb1 returns the box at xf1.
+	/// @param aabb2 returns the box at xf2.
+	/// @param childIndex the child shape
+	virtual void ComputeAABBs(b2AABB* aabb1, b2AABB* aabb2, const b2Transform& xf1, const b2Transform& xf2, int32 childIndex) const
+	{
+		ComputeAABB(aabb1, xf1, childIndex);
+		ComputeAABB(aabb2, xf2, childIndex);
+	}
+
 	/// Compute the mass properties of this shape using its dimensions and density.
 	/// The inertia tensor is computed about the local origin.
 	/// @param massData returns the mass data for this shape.
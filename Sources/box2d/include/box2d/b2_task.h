@@ -0,0 +1,101 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_TASK_H
+#define B2_TASK_H
+
+#include "b2_api.h"
+#include "b2_settings.h"
+#include <swift/bridging>
+
+/// A task run by a b2TaskExecutor over the item range [startIndex, endIndex).
+typedef void b2TaskFunction(int32 startIndex, int32 endIndex, void* context);
+
+/// Implement this class to let Box2D run parallel loops on your own thread pool or
+/// job system. Box2D calls the executor from inside b2World::Step and other batch
+/// functions. Tasks only touch the items in their range, so the ranges may run in
+/// any order and on any thread.
+/// @warning callbacks such as b2ContactFilter may be called from the executor's threads.
+class B2_API b2TaskExecutor
+{
+public:
+	virtual ~b2TaskExecutor() {}
+
+	/// Run the task over [0, itemCount), split into ranges of at least minRange items.
+	/// This must not return until every range has finished.
+	virtual void ParallelFor(b2TaskFunction* task, int32 itemCount, int32 minRange, void* context) = 0;
+};
+
+/// Run a task on the executor, or on the calling thread if there is no executor
+/// or the work is too small to split.
+inline void b2ParallelFor(b2TaskExecutor* executor, b2TaskFunction* task, int32 itemCount, int32 minRange, void* context)
+{
+	if (itemCount <= 0)
+	{
+		return;
+	}
+
+	if (executor == nullptr || itemCount <= minRange)
+	{
+		task(0, itemCount, context);
+		return;
+	}
+
+	executor->ParallelFor(task, itemCount, minRange, context);
+}
+
+// MARK: - SwiftTaskExecutor
+
+typedef void (*task_executor_parallel_for_func)(const void* userData, b2TaskFunction* task, int32 itemCount, int32 minRange, void* context);
+
+/// Helper class that inherited from b2TaskExecutor.
+class SwiftTaskExecutor: public b2TaskExecutor {
+public:
+    SwiftTaskExecutor(const void *userData): m_ParallelFor(nullptr), m_UserData(userData) {}
+    virtual ~SwiftTaskExecutor() {}
+    
+    /// Return a new executor. Use this method in Swift.
+    /// Release it with Destroy after it has been removed from the world.
+    static SwiftTaskExecutor* _Nonnull Create(const void *userData) {
+        return new SwiftTaskExecutor(userData);
+    }
+    
+    static void Destroy(SwiftTaskExecutor* _Nonnull executor) {
+        delete executor;
+    }
+    
+    /// Runs the task on the calling thread if m_ParallelFor is null.
+    virtual void ParallelFor(b2TaskFunction* task, int32 itemCount, int32 minRange, void* context) override {
+        if (m_ParallelFor) {
+            m_ParallelFor(m_UserData, task, itemCount, minRange, context);
+        } else {
+            task(0, itemCount, context);
+        }
+    }
+    
+    task_executor_parallel_for_func m_ParallelFor;
+    
+private:
+    const void* m_UserData;
+} SWIFT_UNSAFE_REFERENCE;
+
+#endif
@@ -32,7 +32,7 @@ struct B2_API b2TOIInput
 {
 	b2DistanceProxy proxyA;
 	b2DistanceProxy proxyB;
-	b2Sweep sweepA;
+	b2Sweep sweepA;		// the rotations are computed from the angles
 	b2Sweep sweepB;
 	float tMax;		// defines sweep interval [0, tMax]
 };
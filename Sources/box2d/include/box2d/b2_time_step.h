@@ -36,6 +36,12 @@ struct B2_API b2Profile
 	float solvePosition;
 	float broadphase;
 	float solveTOI;
+	float sensors;
+
+	// Polygon contacts that skipped the full narrow phase in the last step because
+	// their cached separating axis still separated them, or their manifold was kept.
+	int32 separatingAxisHits;
+	int32 manifoldReuses;
 };
 
 /// This is an internal structure.
@@ -50,10 +56,23 @@ struct B2_API b2TimeStep
 };
 
 /// This is an internal structure.
+/// The rotation by a is kept with the angle so that the solver does not need the trig
+/// functions. Use SetAngle to change the angle.
 struct B2_API b2Position
 {
+	/// Set the angle and rotate q along with it.
+	void SetAngle(float angle)
+	{
+		if (angle != a)
+		{
+			q = b2IntegrateRotation(q, angle - a);
+			a = angle;
+		}
+	}
+
 	b2Vec2 c;
 	float a;
+	b2Rot q;
 };
 
 /// This is an internal structure.
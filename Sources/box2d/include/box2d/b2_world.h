@@ -26,10 +26,13 @@
 #include "b2_api.h"
 #include "b2_block_allocator.h"
 #include "b2_contact_manager.h"
+#include "b2_id.h"
+#include "b2_id_pool.h"
 #include "b2_math.h"
 #include "b2_stack_allocator.h"
 #include "b2_time_step.h"
 #include "b2_world_callbacks.h"
+#include <stddef.h>
 #include <swift/bridging>
 
 struct b2AABB;
@@ -40,6 +43,52 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2TaskExecutor;
+class b2TOIQueue;
+struct b2TOICandidate;
+
+/// Flags for b2World::ExportTransforms.
+enum b2ExportFlags
+{
+	/// Also write the velocities.
+	b2_exportVelocities = 0x0001,
+
+	/// Only write bodies that moved in the last time step.
+	b2_exportMovedOnly = 0x0002
+};
+
+/// A body record written by b2World::ExportTransforms. Without b2_exportVelocities only
+/// the members up to rotation are written and the stride can be b2_exportTransformSize.
+struct B2_API b2BodyExport
+{
+	int32 index;
+	b2Vec2 position;
+	b2Rot rotation;
+	b2Vec2 linearVelocity;
+	float angularVelocity;
+};
+
+/// The bodies that changed since the last time step, see b2World::GetBodyEvents.
+/// The arrays hold body indices.
+struct B2_API b2BodyEvents
+{
+	/// Bodies moved by the solver or by b2Body::SetTransform, each listed once.
+	/// Destroyed bodies are removed.
+	const int32* movedBodies;
+
+	/// Bodies that fell asleep. A body destroyed after the step may have left its
+	/// index behind, so check b2World::GetBody for nullptr.
+	const int32* sleepBodies;
+
+	/// Bodies that woke up, like sleepBodies.
+	const int32* wakeBodies;
+
+	int32 movedCount;
+	int32 sleepCount;
+	int32 wakeCount;
+};
+
+#define b2_exportTransformSize int32(offsetof(b2BodyExport, linearVelocity))
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -72,6 +121,11 @@ public:
 	/// by you and must remain in scope.
 	void SetDebugDraw(b2Draw* debugDraw);
 
+	/// Register a task executor to run parts of the time step in parallel. Without
+	/// one everything runs on the calling thread. The executor is owned by you and
+	/// must remain in scope.
+	void SetTaskExecutor(b2TaskExecutor* executor);
+
 	/// Create a rigid body given a definition. No reference to the definition
 	/// is retained.
 	/// @warning This function is locked during callbacks.
@@ -127,6 +181,29 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Query the world with a function instead of a callback object. The world is only
+	/// read, so queries may run on several threads at once while the world is not
+	/// stepping or being modified. This applies to all const query functions.
+	/// @param fcn called for each fixture found in the query box.
+	/// @param context passed to fcn.
+	/// @param aabb the query box.
+	void QueryAABB(b2QueryFixtureFunction* fcn, void* context, const b2AABB& aabb) const;
+
+	/// Collect the fixtures that potentially overlap the provided AABB.
+	/// @param aabb the query box.
+	/// @param fixtures receives up to capacity fixtures.
+	/// @return the number of fixtures written. The query stops when the array is full.
+	int32 QueryAABB(const b2AABB& aabb, b2Fixture** fixtures, int32 capacity) const;
+
+	/// Ray-cast the world with a function instead of a callback object.
+	/// @see QueryAABB for thread safety.
+	void RayCast(b2RayCastFixtureFunction* fcn, void* context, const b2Vec2& point1, const b2Vec2& point2) const;
+
+	/// Find the closest fixture along the ray.
+	/// @param hit receives the closest hit, untouched if nothing is hit.
+	/// @return true if a fixture was hit.
+	bool RayCastClosest(const b2Vec2& point1, const b2Vec2& point2, b2RayCastHit* hit) const;
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A nullptr body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -147,6 +224,23 @@ public:
 	b2Contact* GetContactList();
 	const b2Contact* GetContactList() const;
 
+	/// Set the approach speed a contact must exceed to report a hit event, usually in m/s.
+	/// Fixtures can raise this with b2FixtureDef::hitEventThreshold. Hit events are only
+	/// computed for fixtures that enable them, see b2ContactListener::ContactHit.
+	void SetHitEventThreshold(float threshold) { m_contactManager.m_hitEventThreshold = threshold; }
+	float GetHitEventThreshold() const { return m_contactManager.m_hitEventThreshold; }
+
+	/// Buffer begin/end touch, sensor and hit events in arrays that can be read in bulk
+	/// after the time step with GetContactEvents. The contact listener is still called,
+	/// set it to nullptr if you only want the buffered events. Disabling clears the buffers.
+	void SetBufferContactEvents(bool flag);
+	bool GetBufferContactEvents() const { return m_contactManager.m_contactEvents; }
+
+	/// Get the events buffered by the last time step. Events caused by destroying
+	/// fixtures and bodies between steps are included as well.
+	/// @warning the arrays are invalidated by the next call to Step.
+	b2ContactEvents GetContactEvents() const;
+
 	/// Enable/disable sleep.
 	void SetAllowSleeping(bool flag);
 	bool GetAllowSleeping() const { return m_allowSleep; }
@@ -159,16 +253,137 @@ public:
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 	bool GetContinuousPhysics() const { return m_continuousPhysics; }
 
+	/// Use speculative contacts for continuous collision of all bodies. Shapes that are
+	/// close enough to collide within the time step get a speculative contact point that
+	/// stops them at the surface, instead of sub-stepping at the time of impact. This is
+	/// cheaper than TOI events and has no serial pass, but fast impacts lose some of their
+	/// restitution and fast rotating shapes can still pass through thin shapes.
+	/// See also b2Body::SetSpeculative.
+	void SetSpeculativeContacts(bool flag);
+	bool GetSpeculativeContacts() const { return m_contactManager.m_speculativeContacts; }
+
+	/// Let touching polygon contacts keep their manifold while their bodies barely move
+	/// relative to each other, which skips the narrow phase in resting stacks. The
+	/// manifold is recomputed once the relative motion since it was computed reaches
+	/// a tolerance. Zero, the default, recomputes every step.
+	/// @param linearTolerance the relative translation, usually in meters.
+	/// @param angularTolerance the relative rotation in radians.
+	void SetManifoldReuseTolerance(float linearTolerance, float angularTolerance);
+
+	/// Compute the contact manifolds in groups of the same shape pair, one tight loop
+	/// per group without virtual calls, split over the task executor. Listener callbacks
+	/// still run in contact list order. Unlike the default mode, a sleeping pair whose
+	/// body is woken by another contact in the same step is updated in the next step.
+	void SetBatchedNarrowPhase(bool flag) { m_contactManager.m_batchedNarrowPhase = flag; }
+	bool GetBatchedNarrowPhase() const { return m_contactManager.m_batchedNarrowPhase; }
+
 	/// Enable/disable single stepped continuous physics. For testing.
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Solve in an order that only depends on the body, fixture and joint indices, not
+	/// on the history of the world lists. Islands are seeded in body index order and
+	/// the contacts and joints of each island are sorted. Together with a library built
+	/// with B2_DETERMINISTIC this gives identical results across platforms for the
+	/// same sequence of calls. Costs a sort per island.
+	void SetDeterministic(bool flag) { m_deterministic = flag; }
+	bool GetDeterministic() const { return m_deterministic; }
+
+	/// Hash the state of all bodies: transforms, velocities and awake flags, in body
+	/// index order. Compare the hashes of two simulations after each step to detect a
+	/// desync early.
+	uint32 GetStateHash() const;
+
+	/// Save the simulation state for rollback: body motion and sleep state, joint
+	/// impulses, contacts with their manifolds and the broad-phase. Call with a null
+	/// buffer to get the size, then reuse the buffer every step.
+	/// A snapshot can only be restored into the world that saved it, while the same
+	/// bodies, fixtures and joints exist. Properties like friction, filters and mass
+	/// are not part of the state.
+	/// @param buffer receives the snapshot if it is large enough, may be nullptr.
+	/// @param capacity the size of the buffer in bytes.
+	/// @return the size of the snapshot in bytes. Nothing useful is written if this
+	/// is larger than capacity.
+	int32 SaveSnapshot(void* buffer, int32 capacity) const;
+
+	/// Return the world to the state of a snapshot. Contacts are recreated, so contact
+	/// pointers and buffered contact events are invalidated. No listener is called.
+	/// @param buffer a snapshot written by SaveSnapshot.
+	/// @param size the size of the snapshot in bytes.
+	/// @return false if the snapshot does not belong to this world, is truncated, or
+	/// its bodies, fixtures and joints changed since it was saved. Enabling or disabling
+	/// a body is such a change. The world is unchanged then. The snapshot is checked
+	/// for sizes and indices, not for damage to the values it holds.
+	bool RestoreSnapshot(const void* buffer, int32 size);
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
 	/// Get the number of bodies.
 	int32 GetBodyCount() const;
 
+	/// Get the bodies that moved, fell asleep or woke up in the last time step. Changes
+	/// made between steps, such as teleports, are included as well.
+	/// @warning the arrays are invalidated by the next call to Step.
+	b2BodyEvents GetBodyEvents() const;
+
+	/// Get a body by its index, see b2Body::GetIndex. Returns nullptr for free or out of
+	/// range indices.
+	b2Body* GetBody(int32 index);
+	const b2Body* GetBody(int32 index) const;
+
+	/// Get one more than the largest body index in use. Body indices are reused.
+	int32 GetBodyCapacity() const;
+
+	/// Get the objects for generation-checked handles. Returns nullptr if the object
+	/// was destroyed. See b2_handles.h for functions that work on handles directly.
+	b2Body* GetBody(b2BodyId id) { return m_bodySlots.Get(id.index, id.generation); }
+	const b2Body* GetBody(b2BodyId id) const { return m_bodySlots.Get(id.index, id.generation); }
+	b2Fixture* GetFixture(b2FixtureId id) { return m_fixtureSlots.Get(id.index, id.generation); }
+	const b2Fixture* GetFixture(b2FixtureId id) const { return m_fixtureSlots.Get(id.index, id.generation); }
+	b2Joint* GetJoint(b2JointId id) { return m_jointSlots.Get(id.index, id.generation); }
+	const b2Joint* GetJoint(b2JointId id) const { return m_jointSlots.Get(id.index, id.generation); }
+
+	/// Write the transforms of the bodies into a caller-owned buffer, ordered by body
+	/// index, or in the order of GetBodyEvents with b2_exportMovedOnly. Each record is a b2BodyExport at the start of a stride-sized slot, so the
+	/// records can be embedded in a larger caller struct.
+	/// @param buffer receives up to capacity records.
+	/// @param stride the distance between records in bytes.
+	/// @param capacity the number of records the buffer holds, GetBodyCount() is enough.
+	/// @param flags a combination of b2ExportFlags.
+	/// @return the number of records written.
+	int32 ExportTransforms(void* buffer, int32 stride, int32 capacity, uint32 flags) const;
+
+	/// Blend the body transforms of the last two time steps, for rendering at a higher
+	/// rate than the physics. Rotations use normalized linear interpolation.
+	/// Teleported bodies are not blended. The result is indexed by body index and
+	/// slots of destroyed bodies hold stale values.
+	/// @param alpha the blend factor, 0 for the previous step and 1 for the last step.
+	/// @param transforms receives up to capacity transforms.
+	/// @param capacity the size of the array, GetBodyCapacity() is enough.
+	/// @return the number of transforms written.
+	int32 GetInterpolatedTransforms(float alpha, b2Transform* transforms, int32 capacity) const;
+
+	/// Teleport many bodies at once, like b2Body::SetTransform. The fixtures are synchronized
+	/// with the broad-phase in a single pass after all transforms are written. Like
+	/// SetTransform this does not wake the bodies, SetVelocities and ApplyForces do.
+	/// @param bodyIndices the body indices, see b2Body::GetIndex. Indices of destroyed
+	/// bodies and out of range indices are skipped, here and in the functions below.
+	/// @param positions the world positions of the body origins.
+	/// @param angles the world rotations in radians.
+	/// @param count the number of bodies.
+	void SetTransforms(const int32* bodyIndices, const b2Vec2* positions, const float* angles, int32 count);
+
+	/// Set the velocities of many bodies at once, like b2Body::SetLinearVelocity and
+	/// b2Body::SetAngularVelocity. Static bodies are ignored.
+	/// @param angularVelocities may be nullptr to keep the angular velocities.
+	void SetVelocities(const int32* bodyIndices, const b2Vec2* linearVelocities, const float* angularVelocities, int32 count);
+
+	/// Apply forces at the centers of mass of many bodies, like b2Body::ApplyForceToCenter.
+	/// @param torques may be nullptr to apply no torque.
+	/// @param wake also wake up the bodies.
+	void ApplyForces(const int32* bodyIndices, const b2Vec2* forces, const float* torques, int32 count, bool wake);
+
 	/// Get the number of joints.
 	int32 GetJointCount() const;
 
@@ -205,6 +420,16 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Release memory held by the world after destroying a large number of bodies.
+	/// This packs the broad-phase tree and shrinks its node pool, trims the broad-phase
+	/// buffers and returns empty block allocator chunks to the system.
+	/// The work can be spread over several frames by limiting the number of tree
+	/// nodes moved per call and calling again until it returns true.
+	/// @param maxNodeMoves the maximum number of tree nodes to move in this call, zero for no limit.
+	/// @return true if compaction is complete.
+	/// @warning this should be called outside of a time step.
+	bool Compact(int32 maxNodeMoves);
+
 	/// Get the contact manager for testing.
 	const b2ContactManager& GetContactManager() const;
 
@@ -229,6 +454,16 @@ private:
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
+	bool PrepareTOI(b2Contact* contact, b2TOICandidate* candidate);
+	void QueueTOI(b2TOIQueue* queue, b2Contact* contact);
+
+	void SynchronizeBodies();
+	void MarkMoved(b2Body* body);
+	void ResetInterpolation(b2Body* body);
+	void MarkAwake(b2Body* body, bool flag);
+
+	uint32 GetTopologyHash() const;
+	bool CheckSnapshot(const void* buffer, int32 size) const;
 
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
@@ -240,6 +475,23 @@ private:
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
 
+	// Objects by index, nullptr for free indices.
+	b2SlotArray<b2Body> m_bodySlots;
+	b2SlotArray<b2Fixture> m_fixtureSlots;
+	b2SlotArray<b2Joint> m_jointSlots;
+
+	// Body transforms before and after the last step, by body index.
+	b2GrowableArray<b2Transform> m_previousTransforms;
+	b2GrowableArray<b2Transform> m_currentTransforms;
+
+	// Body events, see GetBodyEvents.
+	b2GrowableArray<int32> m_movedBodies;
+	b2GrowableArray<int32> m_sleepBodies;
+	b2GrowableArray<int32> m_wakeBodies;
+	int32 m_reportedMovedCount;
+	int32 m_reportedSleepCount;
+	int32 m_reportedWakeCount;
+
 	int32 m_bodyCount;
 	int32 m_jointCount;
 
@@ -262,6 +514,8 @@ private:
 	bool m_continuousPhysics;
 	bool m_subStepping;
 
+	bool m_deterministic;
+
 	bool m_stepComplete;
 
 	b2Profile m_profile;
@@ -302,6 +556,21 @@ inline int32 b2World::GetBodyCount() const
 	return m_bodyCount;
 }
 
+inline b2Body* b2World::GetBody(int32 index)
+{
+	return m_bodySlots.Find(index);
+}
+
+inline const b2Body* b2World::GetBody(int32 index) const
+{
+	return m_bodySlots.Find(index);
+}
+
+inline int32 b2World::GetBodyCapacity() const
+{
+	return m_bodySlots.GetCapacity();
+}
+
 inline int32 b2World::GetJointCount() const
 {
 	return m_jointCount;
@@ -24,10 +24,9 @@
 #define B2_WORLD_CALLBACKS_H
 
 #include "b2_api.h"
+#include "b2_math.h"
 #include "b2_settings.h"
 
-struct b2Vec2;
-struct b2Transform;
 class b2Fixture;
 class b2Body;
 class b2Joint;
@@ -74,6 +73,90 @@ struct B2_API b2ContactImpulse
 	int32 count;
 };
 
+/// Two solid fixtures began to touch. See b2World::GetContactEvents.
+/// The fixture pointers are only valid while the fixtures exist, the user data is a copy.
+struct B2_API b2ContactBeginTouchEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2FixtureUserData userDataA;
+	b2FixtureUserData userDataB;
+	int32 childIndexA;
+	int32 childIndexB;
+
+	/// The center of the manifold points in world coordinates.
+	b2Vec2 point;
+
+	/// The world normal pointing from A to B.
+	b2Vec2 normal;
+
+	/// The relative normal velocity at the point, positive when the fixtures approach.
+	float approachSpeed;
+};
+
+/// Two solid fixtures stopped touching or one of them was destroyed.
+/// See b2World::GetContactEvents.
+struct B2_API b2ContactEndTouchEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2FixtureUserData userDataA;
+	b2FixtureUserData userDataB;
+	int32 childIndexA;
+	int32 childIndexB;
+};
+
+/// A solid fixture began or stopped to overlap a sensor fixture.
+/// See b2World::GetContactEvents.
+struct B2_API b2SensorTouchEvent
+{
+	b2Fixture* sensor;
+	b2Fixture* visitor;
+	b2FixtureUserData sensorUserData;
+	b2FixtureUserData visitorUserData;
+};
+
+/// Two solid fixtures hit each other faster than the hit event threshold. Only
+/// fixtures with hit events enabled report these. See b2World::SetHitEventThreshold.
+struct B2_API b2ContactHitEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2FixtureUserData userDataA;
+	b2FixtureUserData userDataB;
+	int32 childIndexA;
+	int32 childIndexB;
+
+	/// The contact point that approached the fastest, in world coordinates. This is the
+	/// manifold point the solver started from, before the bodies moved in this step.
+	b2Vec2 point;
+
+	/// The world normal pointing from A to B.
+	b2Vec2 normal;
+
+	/// The relative normal velocity before the solver, always positive.
+	float approachSpeed;
+
+	/// The largest normal impulse applied by the velocity solver.
+	float maxNormalImpulse;
+};
+
+/// The contact events buffered by the world, see b2World::GetContactEvents.
+/// The arrays are owned by the world and are valid until the next time step.
+struct B2_API b2ContactEvents
+{
+	const b2ContactBeginTouchEvent* beginEvents;
+	const b2ContactEndTouchEvent* endEvents;
+	const b2SensorTouchEvent* sensorBeginEvents;
+	const b2SensorTouchEvent* sensorEndEvents;
+	const b2ContactHitEvent* hitEvents;
+	int32 beginCount;
+	int32 endCount;
+	int32 sensorBeginCount;
+	int32 sensorEndCount;
+	int32 hitCount;
+};
+
 /// Implement this class to get contact information. You can use these results for
 /// things like sounds and game logic. You can also get contact results by
 /// traversing the contact lists after the time step. However, you might miss
@@ -88,12 +171,30 @@ class B2_API b2ContactListener
 public:
 	virtual ~b2ContactListener() {}
 
-	/// Called when two fixtures begin to touch.
+	/// Called when two fixtures begin to touch. Sensors do not create contacts,
+	/// see BeginSensorOverlap.
 	virtual void BeginContact(b2Contact* contact) { B2_NOT_USED(contact); }
 
 	/// Called when two fixtures cease to touch.
 	virtual void EndContact(b2Contact* contact) { B2_NOT_USED(contact); }
 
+	/// Called when a solid fixture begins to overlap a sensor fixture. Overlaps are
+	/// found at the end of the time step. Sensors do not detect other sensors.
+	/// Note: this is called once per child for chain shapes.
+	virtual void BeginSensorOverlap(b2Fixture* sensor, b2Fixture* visitor)
+	{
+		B2_NOT_USED(sensor);
+		B2_NOT_USED(visitor);
+	}
+
+	/// Called when a solid fixture ceases to overlap a sensor fixture. This is also
+	/// called when either fixture is destroyed or disabled.
+	virtual void EndSensorOverlap(b2Fixture* sensor, b2Fixture* visitor)
+	{
+		B2_NOT_USED(sensor);
+		B2_NOT_USED(visitor);
+	}
+
 	/// This is called after a contact is updated. This allows you to inspect a
 	/// contact before it goes to the solver. If you are careful, you can modify the
 	/// contact manifold (e.g. disable contact).
@@ -121,6 +222,16 @@ public:
 		B2_NOT_USED(contact);
 		B2_NOT_USED(impulse);
 	}
+
+	/// Called after the solver for contacts that hit faster than the hit event threshold.
+	/// This is much cheaper than PostSolve for impact sounds and damage because only
+	/// fixtures with hit events enabled are considered.
+	/// Note: this is called once per island solve, so TOI sub-steps may report again.
+	virtual void ContactHit(b2Contact* contact, const b2ContactHitEvent* event)
+	{
+		B2_NOT_USED(contact);
+		B2_NOT_USED(event);
+	}
 };
 
 /// Callback class for AABB queries.
@@ -158,19 +269,55 @@ public:
 									const b2Vec2& normal, float fraction) = 0;
 };
 
+/// Function form of b2QueryCallback. The context is passed through unchanged, so
+/// each query can keep its state on the caller's stack.
+/// @return false to terminate the query.
+typedef bool b2QueryFixtureFunction(b2Fixture* fixture, void* context);
+
+/// Function form of b2RayCastCallback, see b2RayCastCallback::ReportFixture for the
+/// return value.
+typedef float b2RayCastFixtureFunction(b2Fixture* fixture, b2Vec2 point, b2Vec2 normal, float fraction, void* context);
+
+/// The closest fixture hit by a ray, see b2World::RayCastClosest.
+struct B2_API b2RayCastHit
+{
+	b2Fixture* fixture;
+	b2Vec2 point;
+	b2Vec2 normal;
+	float fraction;
+};
+
 // MARK: - SwiftContactListener2D
 
 typedef void (*contact_listener_begin_contact_func)(const void* userData, b2Contact* contact);
 typedef void (*contact_listener_end_contact_func)(const void* userData, b2Contact* contact);
 typedef void (*contact_listener_presolve_func)(const void* userData, b2Contact* contact, const b2Manifold* oldManifold);
 typedef void (*contact_listener_postsolve_func)(const void* userData, b2Contact* contact, const b2ContactImpulse* impulse);
+typedef void (*contact_listener_begin_sensor_overlap_func)(const void* userData, b2Fixture* sensor, b2Fixture* visitor);
+typedef void (*contact_listener_end_sensor_overlap_func)(const void* userData, b2Fixture* sensor, b2Fixture* visitor);
+typedef void (*contact_listener_contact_hit_func)(const void* userData, b2Contact* contact, const b2ContactHitEvent* event);
 
 /// Helper class that inherited from b2ContactListener.
 class SwiftContactListener2D: public b2ContactListener {
 public:
-    SwiftContactListener2D(const void *userData): m_UserData(userData) {}
+    SwiftContactListener2D(const void *userData):
+        m_BeginContact(nullptr), m_EndContact(nullptr), m_PreSolve(nullptr), m_PostSolve(nullptr),
+        m_BeginSensorOverlap(nullptr), m_EndSensorOverlap(nullptr), m_ContactHit(nullptr),
+        m_UserData(userData) {}
     virtual ~SwiftContactListener2D() {}
     
+    /// Return a new listener. Use this method in Swift.
+    /// Release it with Destroy after it has been removed from the world.
+    static SwiftContactListener2D* _Nonnull Create(const void *userData) {
+        return new SwiftContactListener2D(userData);
+    }
+    
+    static void Destroy(SwiftContactListener2D* _Nonnull listener) {
+        delete listener;
+    }
+    
+    /// @warning every call returns the same instance and overwrites its user data,
+    /// so it can only serve one world. Prefer Create.
     static SwiftContactListener2D& CreateListener(const void *userData) {
         static SwiftContactListener2D listener = { userData } ;
         return listener;
@@ -216,10 +363,31 @@ public:
         }
     };
     
+    virtual void BeginSensorOverlap(b2Fixture* sensor, b2Fixture* visitor) override {
+        if (m_BeginSensorOverlap) {
+            m_BeginSensorOverlap(m_UserData, sensor, visitor);
+        }
+    }
+    
+    virtual void EndSensorOverlap(b2Fixture* sensor, b2Fixture* visitor) override {
+        if (m_EndSensorOverlap) {
+            m_EndSensorOverlap(m_UserData, sensor, visitor);
+        }
+    }
+    
+    virtual void ContactHit(b2Contact* contact, const b2ContactHitEvent* event) override {
+        if (m_ContactHit) {
+            m_ContactHit(m_UserData, contact, event);
+        }
+    }
+    
     contact_listener_begin_contact_func m_BeginContact;
     contact_listener_end_contact_func m_EndContact;
     contact_listener_presolve_func m_PreSolve;
     contact_listener_postsolve_func m_PostSolve;
+    contact_listener_begin_sensor_overlap_func m_BeginSensorOverlap;
+    contact_listener_end_sensor_overlap_func m_EndSensorOverlap;
+    contact_listener_contact_hit_func m_ContactHit;
     
 private:
     const void* m_UserData;
@@ -232,8 +400,22 @@ typedef float (*raycast_listener_reportfixture_func)(const void* userData, b2Fix
 /// Helper class that inherited from b2RayCastCallback.
 class SwiftRayCastCallback: public b2RayCastCallback {
 public:
-    SwiftRayCastCallback(const void *userData): m_UserData(userData) {}
+    SwiftRayCastCallback(const void *userData): m_ReportFixture(nullptr), m_UserData(userData) {}
+    virtual ~SwiftRayCastCallback() {}
+    
+    /// Return a new callback that is owned by the caller. Use this method in Swift
+    /// when ray casts may run on several threads, and release it with Destroy.
+    /// b2World::RayCast with a b2RayCastFixtureFunction needs no object at all.
+    static SwiftRayCastCallback* _Nonnull Create(const void *userData) {
+        return new SwiftRayCastCallback(userData);
+    }
+    
+    static void Destroy(SwiftRayCastCallback* _Nonnull callback) {
+        delete callback;
+    }
     
+    /// @warning every call returns the same instance and overwrites its user data and
+    /// function pointer, so ray casts using it must not overlap. Prefer Create.
     static SwiftRayCastCallback& CreateListener(const void *userData) {
         static SwiftRayCastCallback listener = { userData } ;
         return listener;
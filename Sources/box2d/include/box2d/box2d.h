@@ -27,11 +27,15 @@
 
 #include "b2_settings.h"
 #include "b2_draw.h"
+#include "b2_task.h"
 #include "b2_timer.h"
 
+#include "b2_capsule_shape.h"
 #include "b2_chain_shape.h"
 #include "b2_circle_shape.h"
 #include "b2_edge_shape.h"
+#include "b2_height_field_shape.h"
+#include "b2_mesh_shape.h"
 #include "b2_polygon_shape.h"
 
 #include "b2_broad_phase.h"
@@ -40,6 +44,7 @@
 #include "b2_body.h"
 #include "b2_contact.h"
 #include "b2_fixture.h"
+#include "b2_handles.h"
 #include "b2_time_step.h"
 #include "b2_world.h"
 #include "b2_world_callbacks.h"
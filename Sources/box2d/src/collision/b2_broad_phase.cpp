@@ -97,6 +97,122 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 	}
 }
 
+void b2BroadPhase::RemapMove(int32 oldProxyId, int32 newProxyId)
+{
+	for (int32 i = 0; i < m_moveCount; ++i)
+	{
+		if (m_moveBuffer[i] == oldProxyId)
+		{
+			m_moveBuffer[i] = newProxyId;
+		}
+	}
+}
+
+void b2BroadPhase::ShrinkBuffers()
+{
+	// The pair buffer is scratch space for UpdatePairs.
+	if (m_pairCapacity > 16)
+	{
+		b2Free(m_pairBuffer);
+		m_pairCapacity = 16;
+		m_pairCount = 0;
+		m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+	}
+
+	int32 moveCapacity = 16;
+	while (moveCapacity < m_moveCount)
+	{
+		moveCapacity *= 2;
+	}
+
+	if (moveCapacity < m_moveCapacity)
+	{
+		int32* oldBuffer = m_moveBuffer;
+		m_moveCapacity = moveCapacity;
+		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
+		b2Free(oldBuffer);
+	}
+}
+
+int32 b2BroadPhase::GetStateSize() const
+{
+	return m_tree.GetStateSize() + int32((2 + m_moveCount) * sizeof(int32));
+}
+
+void b2BroadPhase::SaveState(void* buffer) const
+{
+	char* p = (char*)buffer;
+	m_tree.SaveState(p);
+	p += m_tree.GetStateSize();
+
+	int32 counts[2] = { m_proxyCount, m_moveCount };
+	memcpy(p, counts, sizeof(counts));
+	p += sizeof(counts);
+	memcpy(p, m_moveBuffer, m_moveCount * sizeof(int32));
+}
+
+int32 b2BroadPhase::RestoreState(const void* buffer)
+{
+	const char* p = (const char*)buffer;
+	p += m_tree.RestoreState(p);
+
+	int32 counts[2];
+	memcpy(counts, p, sizeof(counts));
+	p += sizeof(counts);
+
+	m_proxyCount = counts[0];
+	m_moveCount = counts[1];
+	if (m_moveCount > m_moveCapacity)
+	{
+		b2Free(m_moveBuffer);
+		while (m_moveCapacity < m_moveCount)
+		{
+			m_moveCapacity *= 2;
+		}
+		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	}
+
+	memcpy(m_moveBuffer, p, m_moveCount * sizeof(int32));
+	p += m_moveCount * sizeof(int32);
+
+	return int32(p - (const char*)buffer);
+}
+
+int32 b2BroadPhase::ReadStateSize(const void* buffer, int32 size)
+{
+	int32 nodeCapacity = 0;
+	int32 treeSize = b2DynamicTree::ReadStateSize(buffer, size, &nodeCapacity);
+	if (treeSize == 0 || size - treeSize < int32(2 * sizeof(int32)))
+	{
+		return 0;
+	}
+
+	const char* p = (const char*)buffer + treeSize;
+	int32 counts[2];
+	memcpy(counts, p, sizeof(counts));
+	p += sizeof(counts);
+
+	int32 maxMoveCount = (size - treeSize - int32(sizeof(counts))) / int32(sizeof(int32));
+	if (counts[0] < 0 || counts[1] < 0 || counts[1] > maxMoveCount)
+	{
+		return 0;
+	}
+
+	// Removed proxies leave null entries in the move buffer.
+	for (int32 i = 0; i < counts[1]; ++i)
+	{
+		int32 proxyId;
+		memcpy(&proxyId, p + i * sizeof(int32), sizeof(int32));
+		if (proxyId < e_nullProxy || proxyId >= nodeCapacity)
+		{
+			return 0;
+		}
+	}
+
+	return treeSize + int32((2 + counts[1]) * sizeof(int32));
+}
+
 // This is called from b2DynamicTree::Query when we are gathering pairs.
 bool b2BroadPhase::QueryCallback(int32 proxyId)
 {
@@ -0,0 +1,216 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_capsule_shape.h"
+#include "box2d/b2_block_allocator.h"
+
+#include <new>
+
+void b2CapsuleShape::Set(const b2Vec2& v1, const b2Vec2& v2, float radius)
+{
+	b2Assert(b2DistanceSquared(v1, v2) > b2_linearSlop * b2_linearSlop);
+	b2Assert(radius > 0.0f);
+	m_vertex1 = v1;
+	m_vertex2 = v2;
+	m_radius = radius;
+}
+
+b2Shape* b2CapsuleShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2CapsuleShape));
+	b2CapsuleShape* clone = new (mem) b2CapsuleShape;
+	*clone = *this;
+	return clone;
+}
+
+int32 b2CapsuleShape::GetChildCount() const
+{
+	return 1;
+}
+
+bool b2CapsuleShape::TestPoint(const b2Transform& transform, const b2Vec2& p) const
+{
+	b2Vec2 localP = b2MulT(transform, p);
+
+	b2Vec2 e = m_vertex2 - m_vertex1;
+	float s = b2Dot(localP - m_vertex1, e) / b2Dot(e, e);
+	s = b2Clamp(s, 0.0f, 1.0f);
+	b2Vec2 d = localP - (m_vertex1 + s * e);
+	return b2Dot(d, d) <= m_radius * m_radius;
+}
+
+// Ray cast against one of the end circles. Same as b2CircleShape::RayCast.
+static bool b2RayCastCapsuleEnd(b2RayCastOutput* output, const b2Vec2& p1, const b2Vec2& d, float maxFraction,
+								const b2Vec2& center, float radius)
+{
+	b2Vec2 s = p1 - center;
+	float b = b2Dot(s, s) - radius * radius;
+
+	float c = b2Dot(s, d);
+	float rr = b2Dot(d, d);
+	float sigma = c * c - rr * b;
+
+	if (sigma < 0.0f || rr < b2_epsilon)
+	{
+		return false;
+	}
+
+	float a = -(c + b2Sqrt(sigma));
+
+	if (0.0f <= a && a <= maxFraction * rr)
+	{
+		a /= rr;
+		output->fraction = a;
+		output->normal = s + a * d;
+		output->normal.Normalize();
+		return true;
+	}
+
+	return false;
+}
+
+// The capsule is bounded by two lines offset from the segment by the radius. A ray that
+// starts outside of that slab enters it through one of the lines. If the entry point is
+// beside the segment it is on the capsule, otherwise the ray can only hit the end circle
+// on that side.
+bool b2CapsuleShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Put the ray into the capsule's frame of reference.
+	b2Vec2 p1 = b2MulT(xf.q, input.p1 - xf.p);
+	b2Vec2 p2 = b2MulT(xf.q, input.p2 - xf.p);
+	b2Vec2 d = p2 - p1;
+
+	b2Vec2 v1 = m_vertex1;
+	b2Vec2 v2 = m_vertex2;
+	b2Vec2 axis = v2 - v1;
+	float length = axis.Normalize();
+
+	// Normal points to the right, looking from v1 at v2
+	b2Vec2 normal(axis.y, -axis.x);
+
+	b2Vec2 q = p1 - v1;
+	float qa = b2Dot(q, axis);
+	float qn = b2Dot(q, normal);
+
+	b2RayCastOutput localOutput;
+	bool hit;
+
+	if (b2Abs(qn) < m_radius)
+	{
+		// The ray starts inside the slab
+		if (qa < 0.0f)
+		{
+			hit = b2RayCastCapsuleEnd(&localOutput, p1, d, input.maxFraction, v1, m_radius);
+		}
+		else if (qa > length)
+		{
+			hit = b2RayCastCapsuleEnd(&localOutput, p1, d, input.maxFraction, v2, m_radius);
+		}
+		else
+		{
+			// The ray starts inside the capsule
+			return false;
+		}
+	}
+	else
+	{
+		float dn = b2Dot(d, normal);
+		float side = qn > 0.0f ? m_radius : -m_radius;
+
+		// Is the ray moving towards the slab?
+		if (dn * side >= 0.0f)
+		{
+			return false;
+		}
+
+		float t = (side - qn) / dn;
+		if (t > input.maxFraction)
+		{
+			return false;
+		}
+
+		float s = qa + t * b2Dot(d, axis);
+		if (s < 0.0f)
+		{
+			hit = b2RayCastCapsuleEnd(&localOutput, p1, d, input.maxFraction, v1, m_radius);
+		}
+		else if (s > length)
+		{
+			hit = b2RayCastCapsuleEnd(&localOutput, p1, d, input.maxFraction, v2, m_radius);
+		}
+		else
+		{
+			localOutput.fraction = t;
+			localOutput.normal = qn > 0.0f ? normal : -normal;
+			hit = true;
+		}
+	}
+
+	if (hit == false)
+	{
+		return false;
+	}
+
+	output->fraction = localOutput.fraction;
+	output->normal = b2Mul(xf.q, localOutput.normal);
+	return true;
+}
+
+void b2CapsuleShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	b2Vec2 v1 = b2Mul(xf, m_vertex1);
+	b2Vec2 v2 = b2Mul(xf, m_vertex2);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = b2Min(v1, v2) - r;
+	aabb->upperBound = b2Max(v1, v2) + r;
+}
+
+// The capsule is a rectangle with a half circle on each end. The two half circles
+// make one full circle with its halves pushed apart along the segment.
+void b2CapsuleShape::ComputeMass(b2MassData* massData, float density) const
+{
+	float radius = m_radius;
+	float rr = radius * radius;
+	float length = b2Distance(m_vertex1, m_vertex2);
+	float ll = length * length;
+
+	float circleMass = density * b2_pi * rr;
+	float boxMass = density * (2.0f * radius * length);
+
+	massData->mass = circleMass + boxMass;
+	massData->center = 0.5f * (m_vertex1 + m_vertex2);
+
+	// Centroid of a half circle from its flat side
+	float lc = 4.0f * radius / (3.0f * b2_pi);
+	float h = 0.5f * length;
+
+	// Inertia about the center, then shifted to the local origin
+	float circleInertia = circleMass * (0.5f * rr + h * h + 2.0f * h * lc);
+	float boxInertia = boxMass * (4.0f * rr + ll) / 12.0f;
+	massData->I = circleInertia + boxInertia + massData->mass * b2Dot(massData->center, massData->center);
+}
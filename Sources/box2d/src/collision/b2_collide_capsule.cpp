@@ -0,0 +1,557 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_collision.h"
+#include "box2d/b2_capsule_shape.h"
+#include "box2d/b2_circle_shape.h"
+#include "box2d/b2_edge_shape.h"
+#include "box2d/b2_polygon_shape.h"
+
+// Compute contact points for capsule versus circle. This is the two-sided edge case
+// with the capsule radius added.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	// Compute circle in frame of capsule
+	b2Vec2 Q = b2MulT(xfA, b2Mul(xfB, circleB->m_p));
+
+	b2Vec2 A = capsuleA->m_vertex1, B = capsuleA->m_vertex2;
+	b2Vec2 e = B - A;
+
+	// Barycentric coordinates
+	float u = b2Dot(e, B - Q);
+	float v = b2Dot(e, Q - A);
+
+	float radius = capsuleA->m_radius + circleB->m_radius;
+
+	b2ContactFeature cf;
+	cf.indexB = 0;
+	cf.typeB = b2ContactFeature::e_vertex;
+
+	// Region A or B
+	if (v <= 0.0f || u <= 0.0f)
+	{
+		int32 index = v <= 0.0f ? 0 : 1;
+		b2Vec2 P = index == 0 ? A : B;
+		b2Vec2 d = Q - P;
+		if (b2Dot(d, d) > radius * radius)
+		{
+			return;
+		}
+
+		cf.indexA = static_cast<uint8>(index);
+		cf.typeA = b2ContactFeature::e_vertex;
+		manifold->pointCount = 1;
+		manifold->type = b2Manifold::e_circles;
+		manifold->localNormal.SetZero();
+		manifold->localPoint = P;
+		manifold->points[0].id.key = 0;
+		manifold->points[0].id.cf = cf;
+		manifold->points[0].localPoint = circleB->m_p;
+		return;
+	}
+
+	// Region AB
+	b2Vec2 n(e.y, -e.x);
+	n.Normalize();
+	float offset = b2Dot(n, Q - A);
+	if (b2Abs(offset) > radius)
+	{
+		return;
+	}
+
+	if (offset < 0.0f)
+	{
+		n = -n;
+	}
+
+	cf.indexA = 0;
+	cf.typeA = b2ContactFeature::e_face;
+	manifold->pointCount = 1;
+	manifold->type = b2Manifold::e_faceA;
+	manifold->localNormal = n;
+	manifold->localPoint = A;
+	manifold->points[0].id.key = 0;
+	manifold->points[0].id.cf = cf;
+	manifold->points[0].localPoint = circleB->m_p;
+}
+
+// A convex polygon inflated by a radius, in the local frame of its shape. Capsules and
+// two-sided edges are the two vertex case with opposite normals.
+struct b2RoundedHull
+{
+	const b2Vec2* vertices;
+	const b2Vec2* normals;
+	int32 count;
+	float radius;
+
+	// Vertices and normals for the two vertex case
+	b2Vec2 vertexBuffer[2];
+	b2Vec2 normalBuffer[2];
+};
+
+static void b2MakeSegmentHull(b2RoundedHull* hull, const b2Vec2& v1, const b2Vec2& v2, float radius)
+{
+	hull->vertexBuffer[0] = v1;
+	hull->vertexBuffer[1] = v2;
+
+	b2Vec2 e = v2 - v1;
+	hull->normalBuffer[0].Set(e.y, -e.x);
+	hull->normalBuffer[0].Normalize();
+	hull->normalBuffer[1] = -hull->normalBuffer[0];
+
+	hull->vertices = hull->vertexBuffer;
+	hull->normals = hull->normalBuffer;
+	hull->count = 2;
+	hull->radius = radius;
+}
+
+static void b2MakePolygonHull(b2RoundedHull* hull, const b2PolygonShape* polygon)
+{
+	hull->vertices = polygon->m_vertices;
+	hull->normals = polygon->m_normals;
+	hull->count = polygon->m_count;
+	hull->radius = polygon->m_radius;
+}
+
+// Find the max separation between hull 1 and hull 2 using the edge normals of hull 1.
+// Both hulls are in the same frame.
+static float b2FindMaxSeparation(int32* edgeIndex,
+								const b2Vec2* v1s, const b2Vec2* n1s, int32 count1,
+								const b2Vec2* v2s, int32 count2)
+{
+	int32 bestIndex = 0;
+	float maxSeparation = -b2_maxFloat;
+	for (int32 i = 0; i < count1; ++i)
+	{
+		// Find the deepest point for normal i.
+		b2Vec2 n = n1s[i];
+		b2Vec2 v1 = v1s[i];
+		float si = b2_maxFloat;
+		for (int32 j = 0; j < count2; ++j)
+		{
+			float sij = b2Dot(n, v2s[j] - v1);
+			if (sij < si)
+			{
+				si = sij;
+			}
+		}
+
+		if (si > maxSeparation)
+		{
+			maxSeparation = si;
+			bestIndex = i;
+		}
+	}
+
+	*edgeIndex = bestIndex;
+	return maxSeparation;
+}
+
+// Closest points between segments p1-q1 and p2-q2. The fractions are exactly 0 or 1
+// when the closest point is an end point.
+// Real-Time Collision Detection by Christer Ericson, Section 5.1.9
+static float b2SegmentDistanceSquared(float* fraction1, float* fraction2,
+									const b2Vec2& p1, const b2Vec2& q1, const b2Vec2& p2, const b2Vec2& q2)
+{
+	b2Vec2 d1 = q1 - p1;
+	b2Vec2 d2 = q2 - p2;
+	b2Vec2 r = p1 - p2;
+	float dd1 = b2Dot(d1, d1);
+	float dd2 = b2Dot(d2, d2);
+	float rd1 = b2Dot(r, d1);
+	float rd2 = b2Dot(r, d2);
+
+	const float epsSqr = b2_epsilon * b2_epsilon;
+
+	float s = 0.0f;
+	float t = 0.0f;
+
+	if (dd1 < epsSqr || dd2 < epsSqr)
+	{
+		// Handle degenerate segments
+		if (dd1 >= epsSqr)
+		{
+			s = b2Clamp(-rd1 / dd1, 0.0f, 1.0f);
+		}
+		else if (dd2 >= epsSqr)
+		{
+			t = b2Clamp(rd2 / dd2, 0.0f, 1.0f);
+		}
+	}
+	else
+	{
+		float d12 = b2Dot(d1, d2);
+		float denominator = dd1 * dd2 - d12 * d12;
+
+		// Parallel segments use the first end point of segment 1
+		if (denominator != 0.0f)
+		{
+			s = b2Clamp((d12 * rd2 - rd1 * dd2) / denominator, 0.0f, 1.0f);
+		}
+
+		t = (d12 * s + rd2) / dd2;
+
+		// Clamp t and recompute s
+		if (t < 0.0f)
+		{
+			t = 0.0f;
+			s = b2Clamp(-rd1 / dd1, 0.0f, 1.0f);
+		}
+		else if (t > 1.0f)
+		{
+			t = 1.0f;
+			s = b2Clamp((d12 - rd1) / dd1, 0.0f, 1.0f);
+		}
+	}
+
+	b2Vec2 c1 = p1 + s * d1;
+	b2Vec2 c2 = p2 + t * d2;
+
+	*fraction1 = s;
+	*fraction2 = t;
+	return b2DistanceSquared(c1, c2);
+}
+
+// Contact between the closest points of edge 1 and edge 2, with the normal joining them.
+// This covers the cases clipping cannot, such as collinear cores meeting end to end.
+// The edges are in frame A and edge 1 belongs to hull B if flip is set.
+static void b2CollideClosestPoints(b2Manifold* manifold, const b2Transform& xf,
+								const b2Vec2& v11, const b2Vec2& v12, int32 i11, int32 i12,
+								const b2Vec2& v21, const b2Vec2& v22, int32 i21, int32 i22,
+								float totalRadius, bool flip)
+{
+	manifold->pointCount = 0;
+
+	float fraction1, fraction2;
+	float distanceSquared = b2SegmentDistanceSquared(&fraction1, &fraction2, v11, v12, v21, v22);
+	if (distanceSquared > totalRadius * totalRadius)
+	{
+		return;
+	}
+
+	b2Vec2 p1 = v11 + fraction1 * (v12 - v11);
+	b2Vec2 p2 = v21 + fraction2 * (v22 - v21);
+
+	b2ContactFeature cf1, cf2;
+	cf1.indexA = static_cast<uint8>(fraction1 == 1.0f ? i12 : i11);
+	cf1.typeA = fraction1 == 0.0f || fraction1 == 1.0f ? b2ContactFeature::e_vertex : b2ContactFeature::e_face;
+	cf2.indexA = static_cast<uint8>(fraction2 == 1.0f ? i22 : i21);
+	cf2.typeA = fraction2 == 0.0f || fraction2 == 1.0f ? b2ContactFeature::e_vertex : b2ContactFeature::e_face;
+
+	const b2Vec2& pointA = flip ? p2 : p1;
+	const b2Vec2& pointB = flip ? p1 : p2;
+	const b2ContactFeature& cfA = flip ? cf2 : cf1;
+	const b2ContactFeature& cfB = flip ? cf1 : cf2;
+
+	manifold->pointCount = 1;
+	manifold->type = b2Manifold::e_circles;
+	manifold->localNormal.SetZero();
+	manifold->localPoint = pointA;
+	manifold->points[0].localPoint = b2MulT(xf, pointB);
+	manifold->points[0].id.key = 0;
+	manifold->points[0].id.cf.indexA = cfA.indexA;
+	manifold->points[0].id.cf.indexB = cfB.indexA;
+	manifold->points[0].id.cf.typeA = cfA.typeA;
+	manifold->points[0].id.cf.typeB = cfB.typeA;
+}
+
+// Compute the collision manifold between two rounded hulls. The separating axis test
+// runs on the cores. When the cores are apart and the closest features are two
+// vertices, the contact is between the rounded corners and the normal joins those
+// vertices. Otherwise the incident edge is clipped against the reference face.
+static void b2CollideRoundedHulls(b2Manifold* manifold,
+								const b2RoundedHull& hullA, const b2Transform& xfA,
+								const b2RoundedHull& hullB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	b2Transform xf = b2MulT(xfA, xfB);
+
+	// Get hull B in frame A
+	b2Vec2 verticesB[b2_maxPolygonVertices];
+	b2Vec2 normalsB[b2_maxPolygonVertices];
+	for (int32 i = 0; i < hullB.count; ++i)
+	{
+		verticesB[i] = b2Mul(xf, hullB.vertices[i]);
+		normalsB[i] = b2Mul(xf.q, hullB.normals[i]);
+	}
+
+	float totalRadius = hullA.radius + hullB.radius;
+
+	int32 edgeA = 0;
+	float separationA = b2FindMaxSeparation(&edgeA, hullA.vertices, hullA.normals, hullA.count, verticesB, hullB.count);
+	if (separationA > totalRadius)
+	{
+		return;
+	}
+
+	int32 edgeB = 0;
+	float separationB = b2FindMaxSeparation(&edgeB, verticesB, normalsB, hullB.count, hullA.vertices, hullA.count);
+	if (separationB > totalRadius)
+	{
+		return;
+	}
+
+	// Everything below is in frame A.
+	const b2Vec2* vertices1;
+	const b2Vec2* normals1;
+	int32 count1;
+	const b2Vec2* vertices2;
+	const b2Vec2* normals2;
+	int32 count2;
+	int32 edge1;
+	bool flip;
+
+	const float k_tol = 0.1f * b2_linearSlop;
+
+	if (separationB > separationA + k_tol)
+	{
+		vertices1 = verticesB;
+		normals1 = normalsB;
+		count1 = hullB.count;
+		vertices2 = hullA.vertices;
+		normals2 = hullA.normals;
+		count2 = hullA.count;
+		edge1 = edgeB;
+		flip = true;
+	}
+	else
+	{
+		vertices1 = hullA.vertices;
+		normals1 = hullA.normals;
+		count1 = hullA.count;
+		vertices2 = verticesB;
+		normals2 = normalsB;
+		count2 = hullB.count;
+		edge1 = edgeA;
+		flip = false;
+	}
+
+	b2Vec2 normal = normals1[edge1];
+
+	// Find the incident edge on hull 2, the one most anti-parallel to the reference normal.
+	int32 edge2 = 0;
+	float minDot = b2_maxFloat;
+	for (int32 i = 0; i < count2; ++i)
+	{
+		float dot = b2Dot(normal, normals2[i]);
+		if (dot < minDot)
+		{
+			minDot = dot;
+			edge2 = i;
+		}
+	}
+
+	int32 i11 = edge1;
+	int32 i12 = edge1 + 1 < count1 ? edge1 + 1 : 0;
+	int32 i21 = edge2;
+	int32 i22 = edge2 + 1 < count2 ? edge2 + 1 : 0;
+
+	b2Vec2 v11 = vertices1[i11];
+	b2Vec2 v12 = vertices1[i12];
+	b2Vec2 v21 = vertices2[i21];
+	b2Vec2 v22 = vertices2[i22];
+
+	// The slop keeps the vertex-vertex normal well defined.
+	if (b2Max(separationA, separationB) > k_tol)
+	{
+		float fraction1, fraction2;
+		float distanceSquared = b2SegmentDistanceSquared(&fraction1, &fraction2, v11, v12, v21, v22);
+
+		bool vertex1 = fraction1 == 0.0f || fraction1 == 1.0f;
+		bool vertex2 = fraction2 == 0.0f || fraction2 == 1.0f;
+		if (vertex1 && vertex2)
+		{
+			if (distanceSquared > totalRadius * totalRadius)
+			{
+				return;
+			}
+
+			int32 iv1 = fraction1 == 0.0f ? i11 : i12;
+			int32 iv2 = fraction2 == 0.0f ? i21 : i22;
+			int32 indexA = flip ? iv2 : iv1;
+			int32 indexB = flip ? iv1 : iv2;
+
+			manifold->pointCount = 1;
+			manifold->type = b2Manifold::e_circles;
+			manifold->localNormal.SetZero();
+			manifold->localPoint = hullA.vertices[indexA];
+			manifold->points[0].localPoint = hullB.vertices[indexB];
+			manifold->points[0].id.key = 0;
+			manifold->points[0].id.cf.indexA = static_cast<uint8>(indexA);
+			manifold->points[0].id.cf.indexB = static_cast<uint8>(indexB);
+			manifold->points[0].id.cf.typeA = b2ContactFeature::e_vertex;
+			manifold->points[0].id.cf.typeB = b2ContactFeature::e_vertex;
+			return;
+		}
+	}
+
+	b2ClipVertex incidentEdge[2];
+	incidentEdge[0].v = v21;
+	incidentEdge[0].id.cf.indexA = static_cast<uint8>(edge1);
+	incidentEdge[0].id.cf.indexB = static_cast<uint8>(i21);
+	incidentEdge[0].id.cf.typeA = b2ContactFeature::e_face;
+	incidentEdge[0].id.cf.typeB = b2ContactFeature::e_vertex;
+
+	incidentEdge[1].v = v22;
+	incidentEdge[1].id.cf.indexA = static_cast<uint8>(edge1);
+	incidentEdge[1].id.cf.indexB = static_cast<uint8>(i22);
+	incidentEdge[1].id.cf.typeA = b2ContactFeature::e_face;
+	incidentEdge[1].id.cf.typeB = b2ContactFeature::e_vertex;
+
+	b2Vec2 tangent = v12 - v11;
+	tangent.Normalize();
+
+	// The side planes are not pushed out by the radius, the rounded corners are
+	// handled above.
+	float frontOffset = b2Dot(normal, v11);
+	float sideOffset1 = -b2Dot(tangent, v11);
+	float sideOffset2 = b2Dot(tangent, v12);
+
+	// Clip incident edge against extruded edge1 side edges.
+	b2ClipVertex clipPoints1[2];
+	b2ClipVertex clipPoints2[2];
+	int32 np;
+
+	// Clip to side 1
+	np = b2ClipSegmentToLine(clipPoints1, incidentEdge, -tangent, sideOffset1, i11);
+
+	if (np < 2)
+	{
+		b2CollideClosestPoints(manifold, xf, v11, v12, i11, i12, v21, v22, i21, i22, totalRadius, flip);
+		return;
+	}
+
+	// Clip to side 2
+	np = b2ClipSegmentToLine(clipPoints2, clipPoints1, tangent, sideOffset2, i12);
+
+	if (np < 2)
+	{
+		b2CollideClosestPoints(manifold, xf, v11, v12, i11, i12, v21, v22, i21, i22, totalRadius, flip);
+		return;
+	}
+
+	if (flip)
+	{
+		manifold->type = b2Manifold::e_faceB;
+		manifold->localNormal = hullB.normals[edge1];
+		manifold->localPoint = 0.5f * (hullB.vertices[i11] + hullB.vertices[i12]);
+	}
+	else
+	{
+		manifold->type = b2Manifold::e_faceA;
+		manifold->localNormal = hullA.normals[edge1];
+		manifold->localPoint = 0.5f * (hullA.vertices[i11] + hullA.vertices[i12]);
+	}
+
+	int32 pointCount = 0;
+	for (int32 i = 0; i < b2_maxManifoldPoints; ++i)
+	{
+		float separation = b2Dot(normal, clipPoints2[i].v) - frontOffset;
+
+		if (separation <= totalRadius)
+		{
+			b2ManifoldPoint* cp = manifold->points + pointCount;
+			cp->id = clipPoints2[i].id;
+
+			if (flip)
+			{
+				// Hull A is incident and already in its own frame.
+				cp->localPoint = clipPoints2[i].v;
+
+				// Swap features
+				b2ContactFeature cf = cp->id.cf;
+				cp->id.cf.indexA = cf.indexB;
+				cp->id.cf.indexB = cf.indexA;
+				cp->id.cf.typeA = cf.typeB;
+				cp->id.cf.typeB = cf.typeA;
+			}
+			else
+			{
+				cp->localPoint = b2MulT(xf, clipPoints2[i].v);
+			}
+
+			++pointCount;
+		}
+	}
+
+	manifold->pointCount = pointCount;
+
+	if (pointCount == 0)
+	{
+		b2CollideClosestPoints(manifold, xf, v11, v12, i11, i12, v21, v22, i21, i22, totalRadius, flip);
+	}
+}
+
+void b2CollideCapsules(b2Manifold* manifold,
+					const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2RoundedHull hullA, hullB;
+	b2MakeSegmentHull(&hullA, capsuleA->m_vertex1, capsuleA->m_vertex2, capsuleA->m_radius);
+	b2MakeSegmentHull(&hullB, capsuleB->m_vertex1, capsuleB->m_vertex2, capsuleB->m_radius);
+	b2CollideRoundedHulls(manifold, hullA, xfA, hullB, xfB);
+}
+
+void b2CollidePolygonAndCapsule(b2Manifold* manifold,
+							const b2PolygonShape* polygonA, const b2Transform& xfA,
+							const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2RoundedHull hullA, hullB;
+	b2MakePolygonHull(&hullA, polygonA);
+	b2MakeSegmentHull(&hullB, capsuleB->m_vertex1, capsuleB->m_vertex2, capsuleB->m_radius);
+	b2CollideRoundedHulls(manifold, hullA, xfA, hullB, xfB);
+}
+
+// One-sided edges need the smooth collision of b2CollideEdgeAndPolygon, so the capsule
+// goes through there as a two vertex polygon with the capsule radius.
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							const b2EdgeShape* edgeA, const b2Transform& xfA,
+							const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	if (edgeA->m_oneSided)
+	{
+		b2PolygonShape polygonB;
+		polygonB.m_count = 2;
+		polygonB.m_radius = capsuleB->m_radius;
+		polygonB.m_vertices[0] = capsuleB->m_vertex1;
+		polygonB.m_vertices[1] = capsuleB->m_vertex2;
+		polygonB.m_centroid = 0.5f * (capsuleB->m_vertex1 + capsuleB->m_vertex2);
+
+		b2Vec2 e = capsuleB->m_vertex2 - capsuleB->m_vertex1;
+		polygonB.m_normals[0].Set(e.y, -e.x);
+		polygonB.m_normals[0].Normalize();
+		polygonB.m_normals[1] = -polygonB.m_normals[0];
+
+		b2CollideEdgeAndPolygon(manifold, edgeA, xfA, &polygonB, xfB);
+		return;
+	}
+
+	b2RoundedHull hullA, hullB;
+	b2MakeSegmentHull(&hullA, edgeA->m_vertex1, edgeA->m_vertex2, edgeA->m_radius);
+	b2MakeSegmentHull(&hullB, capsuleB->m_vertex1, capsuleB->m_vertex2, capsuleB->m_radius);
+	b2CollideRoundedHulls(manifold, hullA, xfA, hullB, xfB);
+}
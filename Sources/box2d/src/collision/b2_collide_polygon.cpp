@@ -23,16 +23,161 @@
 #include "box2d/b2_collision.h"
 #include "box2d/b2_polygon_shape.h"
 
+#include "b2_simd.h"
+
+// The scalar loops only refer to the polygon. These always exist so that
+// b2CollidePolygonsScalar can check the vector code.
+struct b2PolygonScalar
+{
+	void Set(const b2PolygonShape* polygon)
+	{
+		this->polygon = polygon;
+	}
+
+	const b2PolygonShape* polygon;
+};
+
+// Find the separation of poly2 along an edge normal of poly1. The edge is given
+// in the frame of poly2.
+static float b2EdgeSeparation(const b2Vec2& n, const b2Vec2& v1, const b2PolygonScalar& lanes2)
+{
+	int32 count2 = lanes2.polygon->m_count;
+	const b2Vec2* v2s = lanes2.polygon->m_vertices;
+
+	// Find the deepest point.
+	float s = b2_maxFloat;
+	for (int32 j = 0; j < count2; ++j)
+	{
+		float sj = b2Dot(n, v2s[j] - v1);
+		if (sj < s)
+		{
+			s = sj;
+		}
+	}
+
+	return s;
+}
+
+// Find the edge of poly2 whose normal is most anti-parallel to the reference normal.
+static int32 b2FindIncidentIndex(const b2Vec2& normal1, const b2PolygonScalar& lanes2)
+{
+	const b2PolygonShape* poly2 = lanes2.polygon;
+	int32 count2 = poly2->m_count;
+	const b2Vec2* normals2 = poly2->m_normals;
+
+	int32 index = 0;
+	float minDot = b2_maxFloat;
+	for (int32 i = 0; i < count2; ++i)
+	{
+		float dot = b2Dot(normal1, normals2[i]);
+		if (dot < minDot)
+		{
+			minDot = dot;
+			index = i;
+		}
+	}
+
+	return index;
+}
+
+// Where vector support exists the separating axis test runs four vertices at a time,
+// see b2_simd.h.
+#if defined(B2_SIMD_SSE2) || defined(B2_SIMD_NEON)
+
+#define b2_polygonLanes ((b2_maxPolygonVertices + 3) & ~3)
+
+// Polygon vertices and normals as separate coordinate arrays. The tail is padded
+// with copies of the first entry, which cannot change a minimum.
+struct b2PolygonLanes
+{
+	void Set(const b2PolygonShape* polygon)
+	{
+		count = polygon->m_count;
+		blockCount = (count + 3) >> 2;
+		for (int32 i = 0; i < 4 * blockCount; ++i)
+		{
+			int32 index = i < count ? i : 0;
+			x[i] = polygon->m_vertices[index].x;
+			y[i] = polygon->m_vertices[index].y;
+			nx[i] = polygon->m_normals[index].x;
+			ny[i] = polygon->m_normals[index].y;
+		}
+	}
+
+	float x[b2_polygonLanes];
+	float y[b2_polygonLanes];
+	float nx[b2_polygonLanes];
+	float ny[b2_polygonLanes];
+	int32 count;
+	int32 blockCount;
+};
+
+// Find the separation of poly2 along an edge normal of poly1. The edge is given
+// in the frame of poly2.
+static float b2EdgeSeparation(const b2Vec2& n, const b2Vec2& v1, const b2PolygonLanes& lanes2)
+{
+	b2FloatW nx = b2SplatW(n.x);
+	b2FloatW ny = b2SplatW(n.y);
+	b2FloatW v1x = b2SplatW(v1.x);
+	b2FloatW v1y = b2SplatW(v1.y);
+
+	// Find the deepest point, four vertices at a time.
+	b2FloatW s = b2SplatW(b2_maxFloat);
+	for (int32 j = 0; j < 4 * lanes2.blockCount; j += 4)
+	{
+		b2FloatW dx = b2SubW(b2LoadW(lanes2.x + j), v1x);
+		b2FloatW dy = b2SubW(b2LoadW(lanes2.y + j), v1y);
+		s = b2MinW(s, b2AddW(b2MulW(nx, dx), b2MulW(ny, dy)));
+	}
+
+	float sw[4];
+	b2StoreW(sw, s);
+	return b2Min(b2Min(sw[0], sw[1]), b2Min(sw[2], sw[3]));
+}
+
+// Find the edge of poly2 whose normal is most anti-parallel to the reference normal.
+static int32 b2FindIncidentIndex(const b2Vec2& normal1, const b2PolygonLanes& lanes2)
+{
+	b2FloatW n1x = b2SplatW(normal1.x);
+	b2FloatW n1y = b2SplatW(normal1.y);
+
+	float dots[b2_polygonLanes];
+	for (int32 i = 0; i < 4 * lanes2.blockCount; i += 4)
+	{
+		b2FloatW dot = b2AddW(b2MulW(n1x, b2LoadW(lanes2.nx + i)), b2MulW(n1y, b2LoadW(lanes2.ny + i)));
+		b2StoreW(dots + i, dot);
+	}
+
+	// Keep the first minimum, like the scalar loop.
+	int32 index = 0;
+	float minDot = b2_maxFloat;
+	for (int32 i = 0; i < lanes2.count; ++i)
+	{
+		if (dots[i] < minDot)
+		{
+			minDot = dots[i];
+			index = i;
+		}
+	}
+
+	return index;
+}
+
+#else
+
+typedef b2PolygonScalar b2PolygonLanes;
+
+#endif
+
 // Find the max separation between poly1 and poly2 using edge normals from poly1.
+template <typename Lanes>
 static float b2FindMaxSeparation(int32* edgeIndex,
 								 const b2PolygonShape* poly1, const b2Transform& xf1,
-								 const b2PolygonShape* poly2, const b2Transform& xf2)
+								 const Lanes& lanes2, const b2Transform& xf2)
 {
 	int32 count1 = poly1->m_count;
-	int32 count2 = poly2->m_count;
 	const b2Vec2* n1s = poly1->m_normals;
 	const b2Vec2* v1s = poly1->m_vertices;
-	const b2Vec2* v2s = poly2->m_vertices;
 	b2Transform xf = b2MulT(xf2, xf1);
 
 	int32 bestIndex = 0;
@@ -43,17 +188,7 @@ static float b2FindMaxSeparation(int32* edgeIndex,
 		b2Vec2 n = b2Mul(xf.q, n1s[i]);
 		b2Vec2 v1 = b2Mul(xf, v1s[i]);
 
-		// Find deepest point for normal i.
-		float si = b2_maxFloat;
-		for (int32 j = 0; j < count2; ++j)
-		{
-			float sij = b2Dot(n, v2s[j] - v1);
-			if (sij < si)
-			{
-				si = sij;
-			}
-		}
-
+		float si = b2EdgeSeparation(n, v1, lanes2);
 		if (si > maxSeparation)
 		{
 			maxSeparation = si;
@@ -65,15 +200,28 @@ static float b2FindMaxSeparation(int32* edgeIndex,
 	return maxSeparation;
 }
 
+// Test a single edge normal of poly1, like one iteration of b2FindMaxSeparation.
+template <typename Lanes>
+static float b2FindEdgeSeparation(int32 edge,
+								  const b2PolygonShape* poly1, const b2Transform& xf1,
+								  const Lanes& lanes2, const b2Transform& xf2)
+{
+	b2Assert(0 <= edge && edge < poly1->m_count);
+	b2Transform xf = b2MulT(xf2, xf1);
+	b2Vec2 n = b2Mul(xf.q, poly1->m_normals[edge]);
+	b2Vec2 v1 = b2Mul(xf, poly1->m_vertices[edge]);
+	return b2EdgeSeparation(n, v1, lanes2);
+}
+
+template <typename Lanes>
 static void b2FindIncidentEdge(b2ClipVertex c[2],
 							 const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
-							 const b2PolygonShape* poly2, const b2Transform& xf2)
+							 const b2PolygonShape* poly2, const Lanes& lanes2, const b2Transform& xf2)
 {
 	const b2Vec2* normals1 = poly1->m_normals;
 
 	int32 count2 = poly2->m_count;
 	const b2Vec2* vertices2 = poly2->m_vertices;
-	const b2Vec2* normals2 = poly2->m_normals;
 
 	b2Assert(0 <= edge1 && edge1 < poly1->m_count);
 
@@ -81,17 +229,7 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 	b2Vec2 normal1 = b2MulT(xf2.q, b2Mul(xf1.q, normals1[edge1]));
 
 	// Find the incident edge on poly2.
-	int32 index = 0;
-	float minDot = b2_maxFloat;
-	for (int32 i = 0; i < count2; ++i)
-	{
-		float dot = b2Dot(normal1, normals2[i]);
-		if (dot < minDot)
-		{
-			minDot = dot;
-			index = i;
-		}
-	}
+	int32 index = b2FindIncidentIndex(normal1, lanes2);
 
 	// Build the clip vertices for the incident edge.
 	int32 i1 = index;
@@ -117,25 +255,47 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 // Clip
 
 // The normal points from 1 to 2
-void b2CollidePolygons(b2Manifold* manifold,
-					  const b2PolygonShape* polyA, const b2Transform& xfA,
-					  const b2PolygonShape* polyB, const b2Transform& xfB)
+template <typename Lanes>
+static void b2CollidePolygonLanes(b2Manifold* manifold,
+							  const b2PolygonShape* polyA, const Lanes& lanesA, const b2Transform& xfA,
+							  const b2PolygonShape* polyB, const Lanes& lanesB, const b2Transform& xfB,
+							  b2SeparatingAxisCache* cache)
 {
 	manifold->pointCount = 0;
 	float totalRadius = polyA->m_radius + polyB->m_radius;
 
 	int32 edgeA = 0;
-	float separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
+	float separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, lanesB, xfB);
 	if (separationA > totalRadius)
+	{
+		if (cache)
+		{
+			cache->type = b2SeparatingAxisCache::e_edgeA;
+			cache->edge = (uint8)edgeA;
+		}
 		return;
+	}
 
 	int32 edgeB = 0;
-	float separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
+	float separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, lanesA, xfA);
 	if (separationB > totalRadius)
+	{
+		if (cache)
+		{
+			cache->type = b2SeparatingAxisCache::e_edgeB;
+			cache->edge = (uint8)edgeB;
+		}
 		return;
+	}
+
+	if (cache)
+	{
+		cache->type = b2SeparatingAxisCache::e_empty;
+	}
 
 	const b2PolygonShape* poly1;	// reference polygon
 	const b2PolygonShape* poly2;	// incident polygon
+	const Lanes* lanes2;
 	b2Transform xf1, xf2;
 	int32 edge1;					// reference edge
 	uint8 flip;
@@ -145,6 +305,7 @@ void b2CollidePolygons(b2Manifold* manifold,
 	{
 		poly1 = polyB;
 		poly2 = polyA;
+		lanes2 = &lanesA;
 		xf1 = xfB;
 		xf2 = xfA;
 		edge1 = edgeB;
@@ -155,6 +316,7 @@ void b2CollidePolygons(b2Manifold* manifold,
 	{
 		poly1 = polyA;
 		poly2 = polyB;
+		lanes2 = &lanesB;
 		xf1 = xfA;
 		xf2 = xfB;
 		edge1 = edgeA;
@@ -163,7 +325,7 @@ void b2CollidePolygons(b2Manifold* manifold,
 	}
 
 	b2ClipVertex incidentEdge[2];
-	b2FindIncidentEdge(incidentEdge, poly1, xf1, edge1, poly2, xf2);
+	b2FindIncidentEdge(incidentEdge, poly1, xf1, edge1, poly2, *lanes2, xf2);
 
 	int32 count1 = poly1->m_count;
 	const b2Vec2* vertices1 = poly1->m_vertices;
@@ -241,3 +403,56 @@ void b2CollidePolygons(b2Manifold* manifold,
 
 	manifold->pointCount = pointCount;
 }
+
+void b2CollidePolygons(b2Manifold* manifold,
+					  const b2PolygonShape* polyA, const b2Transform& xfA,
+					  const b2PolygonShape* polyB, const b2Transform& xfB)
+{
+	b2PolygonLanes lanesA, lanesB;
+	lanesA.Set(polyA);
+	lanesB.Set(polyB);
+	b2CollidePolygonLanes(manifold, polyA, lanesA, xfA, polyB, lanesB, xfB, nullptr);
+}
+
+void b2CollidePolygonsScalar(b2Manifold* manifold,
+							 const b2PolygonShape* polyA, const b2Transform& xfA,
+							 const b2PolygonShape* polyB, const b2Transform& xfB)
+{
+	b2PolygonScalar scalarA, scalarB;
+	scalarA.Set(polyA);
+	scalarB.Set(polyB);
+	b2CollidePolygonLanes(manifold, polyA, scalarA, xfA, polyB, scalarB, xfB, nullptr);
+}
+
+bool b2CollidePolygons(b2Manifold* manifold,
+					  const b2PolygonShape* polyA, const b2Transform& xfA,
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  b2SeparatingAxisCache* cache)
+{
+	b2PolygonLanes lanesA, lanesB;
+	lanesA.Set(polyA);
+	lanesB.Set(polyB);
+
+	// A separating axis usually stays separating for a while. This computes the
+	// same value as the full search does for the axis, so the result is the same.
+	float totalRadius = polyA->m_radius + polyB->m_radius;
+	if (cache->type == b2SeparatingAxisCache::e_edgeA)
+	{
+		if (b2FindEdgeSeparation(cache->edge, polyA, xfA, lanesB, xfB) > totalRadius)
+		{
+			manifold->pointCount = 0;
+			return true;
+		}
+	}
+	else if (cache->type == b2SeparatingAxisCache::e_edgeB)
+	{
+		if (b2FindEdgeSeparation(cache->edge, polyB, xfB, lanesA, xfA) > totalRadius)
+		{
+			manifold->pointCount = 0;
+			return true;
+		}
+	}
+
+	b2CollidePolygonLanes(manifold, polyA, lanesA, xfA, polyB, lanesB, xfB, cache);
+	return false;
+}
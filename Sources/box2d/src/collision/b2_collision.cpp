@@ -22,6 +22,8 @@
 
 #include "box2d/b2_collision.h"
 #include "box2d/b2_distance.h"
+#include "box2d/b2_height_field_shape.h"
+#include "box2d/b2_mesh_shape.h"
 
 void b2WorldManifold::Initialize(const b2Manifold* manifold,
 						  const b2Transform& xfA, float radiusA,
@@ -236,10 +238,122 @@ int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 	return count;
 }
 
+struct b2MeshOverlapCallback
+{
+	bool QueryCallback(int32 segment)
+	{
+		b2DistanceInput input;
+		input.proxyA.Set(mesh, segment);
+		input.proxyB.Set(shape, index);
+		input.transformA = *xfA;
+		input.transformB = *xfB;
+		input.useRadii = true;
+
+		b2SimplexCache cache;
+		cache.count = 0;
+
+		b2DistanceOutput output;
+
+		b2Distance(&output, &cache, &input);
+
+		overlap = output.distance < 10.0f * b2_epsilon;
+		return overlap == false;
+	}
+
+	const b2MeshShape* mesh;
+	const b2Shape* shape;
+	int32 index;
+	const b2Transform* xfA;
+	const b2Transform* xfB;
+	bool overlap;
+};
+
+// Test the segments near the shape.
+static bool b2TestMeshOverlap(	const b2MeshShape* mesh, const b2Shape* shape, int32 index,
+								const b2Transform& xfA, const b2Transform& xfB)
+{
+	b2MeshOverlapCallback callback;
+	callback.mesh = mesh;
+	callback.shape = shape;
+	callback.index = index;
+	callback.xfA = &xfA;
+	callback.xfB = &xfB;
+	callback.overlap = false;
+
+	// The shape bounds in the mesh frame.
+	b2AABB aabb;
+	shape->ComputeAABB(&aabb, b2MulT(xfA, xfB), index);
+
+	mesh->Query(&callback, aabb);
+	return callback.overlap;
+}
+
+// Test the cells under the shape.
+static bool b2TestHeightFieldOverlap(	const b2HeightFieldShape* heightField, const b2Shape* shape, int32 index,
+										const b2Transform& xfA, const b2Transform& xfB)
+{
+	// The shape bounds in the height field frame.
+	b2AABB aabb;
+	shape->ComputeAABB(&aabb, b2MulT(xfA, xfB), index);
+
+	int32 lowerCell, upperCell;
+	if (heightField->GetCellRange(aabb.lowerBound.x, aabb.upperBound.x, &lowerCell, &upperCell) == false)
+	{
+		return false;
+	}
+
+	b2DistanceInput input;
+	input.proxyB.Set(shape, index);
+	input.transformA = xfA;
+	input.transformB = xfB;
+	input.useRadii = true;
+
+	for (int32 cell = lowerCell; cell <= upperCell; ++cell)
+	{
+		input.proxyA.Set(heightField, cell);
+
+		b2SimplexCache cache;
+		cache.count = 0;
+
+		b2DistanceOutput output;
+
+		b2Distance(&output, &cache, &input);
+
+		if (output.distance < 10.0f * b2_epsilon)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB)
 {
+	// A mesh is a single child, test its segments.
+	if (shapeA->GetType() == b2Shape::e_mesh)
+	{
+		return b2TestMeshOverlap((const b2MeshShape*)shapeA, shapeB, indexB, xfA, xfB);
+	}
+
+	if (shapeB->GetType() == b2Shape::e_mesh)
+	{
+		return b2TestMeshOverlap((const b2MeshShape*)shapeB, shapeA, indexA, xfB, xfA);
+	}
+
+	// So is a height field, test its cells.
+	if (shapeA->GetType() == b2Shape::e_heightField)
+	{
+		return b2TestHeightFieldOverlap((const b2HeightFieldShape*)shapeA, shapeB, indexB, xfA, xfB);
+	}
+
+	if (shapeB->GetType() == b2Shape::e_heightField)
+	{
+		return b2TestHeightFieldOverlap((const b2HeightFieldShape*)shapeB, shapeA, indexA, xfB, xfA);
+	}
+
 	b2DistanceInput input;
 	input.proxyA.Set(shapeA, indexA);
 	input.proxyB.Set(shapeB, indexB);
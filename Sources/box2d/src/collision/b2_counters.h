@@ -0,0 +1,49 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_COUNTERS_H
+#define B2_COUNTERS_H
+
+#include "box2d/b2_types.h"
+
+#include <atomic>
+
+// The GJK and TOI profiling counters are bumped from the worker threads of
+// b2World::Step and b2DistanceMany. They are only read between calls, so relaxed
+// ordering is enough. Hot loops should count locally and add once per call.
+
+template <typename T>
+inline void b2CounterAdd(std::atomic<T>& counter, T value)
+{
+	counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline void b2CounterMax(std::atomic<T>& counter, T value)
+{
+	T current = counter.load(std::memory_order_relaxed);
+	while (current < value && counter.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+	{
+	}
+}
+
+#endif
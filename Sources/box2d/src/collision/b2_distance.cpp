@@ -20,14 +20,19 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "box2d/b2_capsule_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_distance.h"
 #include "box2d/b2_edge_shape.h"
 #include "box2d/b2_chain_shape.h"
+#include "box2d/b2_height_field_shape.h"
 #include "box2d/b2_polygon_shape.h"
+#include "box2d/b2_task.h"
+
+#include "b2_counters.h"
 
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
-B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+B2_API std::atomic<int32> b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
 
 void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 {
@@ -52,6 +57,7 @@ void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 		break;
 
 	case b2Shape::e_chain:
+	case b2Shape::e_mesh:
 		{
 			const b2ChainShape* chain = static_cast<const b2ChainShape*>(shape);
 			b2Assert(0 <= index && index < chain->m_count);
@@ -72,6 +78,21 @@ void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 		}
 		break;
 
+	case b2Shape::e_heightField:
+		{
+			const b2HeightFieldShape* heightField = static_cast<const b2HeightFieldShape*>(shape);
+			b2Assert(0 <= index && index < heightField->m_count - 1);
+
+			float x = index * heightField->m_spacing;
+			m_buffer[0].Set(x, heightField->m_heights[index]);
+			m_buffer[1].Set(x + heightField->m_spacing, heightField->m_heights[index + 1]);
+
+			m_vertices = m_buffer;
+			m_count = 2;
+			m_radius = heightField->m_radius;
+		}
+		break;
+
 	case b2Shape::e_edge:
 		{
 			const b2EdgeShape* edge = static_cast<const b2EdgeShape*>(shape);
@@ -81,6 +102,17 @@ void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 		}
 		break;
 
+	case b2Shape::e_capsule:
+		{
+			const b2CapsuleShape* capsule = static_cast<const b2CapsuleShape*>(shape);
+			m_buffer[0] = capsule->m_vertex1;
+			m_buffer[1] = capsule->m_vertex2;
+			m_vertices = m_buffer;
+			m_count = 2;
+			m_radius = capsule->m_radius;
+		}
+		break;
+
 	default:
 		b2Assert(false);
 	}
@@ -451,17 +483,12 @@ void b2Simplex::Solve3()
 	m_count = 3;
 }
 
-void b2Distance(b2DistanceOutput* output,
-				b2SimplexCache* cache,
-				const b2DistanceInput* input)
+// GJK without the radii, shared by b2Distance and b2DistanceMany.
+static void b2DistanceGJK(b2DistanceOutput* output, b2SimplexCache* cache,
+				const b2DistanceProxy* proxyA, const b2Transform& transformA,
+				const b2DistanceProxy* proxyB, const b2Transform& transformB)
 {
-	++b2_gjkCalls;
-
-	const b2DistanceProxy* proxyA = &input->proxyA;
-	const b2DistanceProxy* proxyB = &input->proxyB;
-
-	b2Transform transformA = input->transformA;
-	b2Transform transformB = input->transformB;
+	b2CounterAdd(b2_gjkCalls, 1);
 
 	// Initialize the simplex.
 	b2Simplex simplex;
@@ -536,7 +563,6 @@ void b2Distance(b2DistanceOutput* output,
 
 		// Iteration count is equated to the number of support point calls.
 		++iter;
-		++b2_gjkIters;
 
 		// Check for duplicate support points. This is the main termination criteria.
 		bool duplicate = false;
@@ -559,7 +585,8 @@ void b2Distance(b2DistanceOutput* output,
 		++simplex.m_count;
 	}
 
-	b2_gjkMaxIters = b2Max(b2_gjkMaxIters, iter);
+	b2CounterAdd(b2_gjkIters, iter);
+	b2CounterMax(b2_gjkMaxIters, iter);
 
 	// Prepare output.
 	simplex.GetWitnessPoints(&output->pointA, &output->pointB);
@@ -568,30 +595,41 @@ void b2Distance(b2DistanceOutput* output,
 
 	// Cache the simplex.
 	simplex.WriteCache(cache);
+}
+
+// Move the closest points from the cores of the shapes to their surfaces.
+static void b2ApplyRadii(b2DistanceOutput* output, float rA, float rB)
+{
+	if (output->distance < b2_epsilon)
+	{
+		// Shapes are too close to safely compute normal
+		b2Vec2 p = 0.5f * (output->pointA + output->pointB);
+		output->pointA = p;
+		output->pointB = p;
+		output->distance = 0.0f;
+	}
+	else
+	{
+		// Keep closest points on perimeter even if overlapped, this way
+		// the points move smoothly.
+		b2Vec2 normal = output->pointB - output->pointA;
+		normal.Normalize();
+		output->distance = b2Max(0.0f, output->distance - rA - rB);
+		output->pointA += rA * normal;
+		output->pointB -= rB * normal;
+	}
+}
+
+void b2Distance(b2DistanceOutput* output,
+				b2SimplexCache* cache,
+				const b2DistanceInput* input)
+{
+	b2DistanceGJK(output, cache, &input->proxyA, input->transformA, &input->proxyB, input->transformB);
 
 	// Apply radii if requested
 	if (input->useRadii)
 	{
-		if (output->distance < b2_epsilon)
-		{
-			// Shapes are too close to safely compute normal
-			b2Vec2 p = 0.5f * (output->pointA + output->pointB);
-			output->pointA = p;
-			output->pointB = p;
-			output->distance = 0.0f;
-		}
-		else
-		{
-			// Keep closest points on perimeter even if overlapped, this way
-			// the points move smoothly.
-			float rA = proxyA->m_radius;
-			float rB = proxyB->m_radius;
-			b2Vec2 normal = output->pointB - output->pointA;
-			normal.Normalize();
-			output->distance = b2Max(0.0f, output->distance - rA - rB);
-			output->pointA += rA * normal;
-			output->pointB -= rB * normal;
-		}
+		b2ApplyRadii(output, input->proxyA.m_radius, input->proxyB.m_radius);
 	}
 }
 
@@ -742,3 +780,179 @@ bool b2ShapeCast(b2ShapeCastOutput * output, const b2ShapeCastInput * input)
 	output->iterations = iter;
 	return true;
 }
+
+// Closest points of two circles. This is where GJK ends up after one iteration.
+static void b2DistanceCircles(b2DistanceOutput* output, b2SimplexCache* cache,
+				const b2CircleShape* circleA, const b2Transform& xfA,
+				const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	output->pointA = b2Mul(xfA, circleA->m_p);
+	output->pointB = b2Mul(xfB, circleB->m_p);
+	output->distance = b2Distance(output->pointA, output->pointB);
+	output->iterations = 0;
+
+	cache->metric = 0.0f;
+	cache->count = 1;
+	cache->indexA[0] = 0;
+	cache->indexB[0] = 0;
+}
+
+// Closest points of a circle and a polygon. The center is outside the polygon, so the
+// nearest feature is the edge of maximum separation or one of its vertices, as in
+// b2CollidePolygonAndCircle. Returns false if the center is inside, which is left to GJK.
+static bool b2DistanceCirclePolygon(b2DistanceOutput* output, b2SimplexCache* cache,
+				const b2CircleShape* circle, const b2Transform& xfC,
+				const b2PolygonShape* polygon, const b2Transform& xfP, bool flip)
+{
+	b2Vec2 c = b2Mul(xfC, circle->m_p);
+	b2Vec2 p = b2MulT(xfP, c);
+
+	int32 count = polygon->m_count;
+	const b2Vec2* vertices = polygon->m_vertices;
+	const b2Vec2* normals = polygon->m_normals;
+
+	// Find the edge of maximum separation.
+	int32 normalIndex = 0;
+	float separation = -b2_maxFloat;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float s = b2Dot(normals[i], p - vertices[i]);
+		if (s > separation)
+		{
+			separation = s;
+			normalIndex = i;
+		}
+	}
+
+	if (separation <= 0.0f)
+	{
+		return false;
+	}
+
+	// Find the Voronoi region of the center. The nearest vertex has index2 = -1.
+	int32 index1 = normalIndex;
+	int32 index2 = index1 + 1 < count ? index1 + 1 : 0;
+	b2Vec2 v1 = vertices[index1];
+	b2Vec2 v2 = vertices[index2];
+
+	b2Vec2 closest;
+	float u1 = b2Dot(p - v1, v2 - v1);
+	float u2 = b2Dot(p - v2, v1 - v2);
+	if (u1 <= 0.0f)
+	{
+		closest = v1;
+		index2 = -1;
+	}
+	else if (u2 <= 0.0f)
+	{
+		closest = v2;
+		index1 = index2;
+		index2 = -1;
+	}
+	else
+	{
+		closest = p - separation * normals[normalIndex];
+	}
+
+	b2Vec2 pointP = b2Mul(xfP, closest);
+	output->pointA = flip ? pointP : c;
+	output->pointB = flip ? c : pointP;
+	output->distance = b2Distance(c, pointP);
+	output->iterations = 0;
+
+	// Leave a simplex that warm starts b2Distance on the same pair.
+	uint8* indexC = flip ? cache->indexB : cache->indexA;
+	uint8* indexP = flip ? cache->indexA : cache->indexB;
+	if (index2 == -1)
+	{
+		cache->metric = 0.0f;
+		cache->count = 1;
+		indexC[0] = 0;
+		indexP[0] = uint8(index1);
+	}
+	else
+	{
+		cache->metric = b2Distance(b2Mul(xfP, vertices[index1]), b2Mul(xfP, vertices[index2]));
+		cache->count = 2;
+		indexC[0] = 0;
+		indexC[1] = 0;
+		indexP[0] = uint8(index1);
+		indexP[1] = uint8(index2);
+	}
+
+	return true;
+}
+
+static void b2ShapeDistance(b2DistanceOutput* output, b2SimplexCache* cache, const b2ShapeDistanceInput* input)
+{
+	const b2Shape* shapeA = input->shapeA;
+	const b2Shape* shapeB = input->shapeB;
+	b2Shape::Type typeA = shapeA->GetType();
+	b2Shape::Type typeB = shapeB->GetType();
+
+	bool solved = false;
+	if (typeA == b2Shape::e_circle && typeB == b2Shape::e_circle)
+	{
+		b2DistanceCircles(output, cache,
+			static_cast<const b2CircleShape*>(shapeA), input->transformA,
+			static_cast<const b2CircleShape*>(shapeB), input->transformB);
+		solved = true;
+	}
+	else if (typeA == b2Shape::e_circle && typeB == b2Shape::e_polygon)
+	{
+		solved = b2DistanceCirclePolygon(output, cache,
+			static_cast<const b2CircleShape*>(shapeA), input->transformA,
+			static_cast<const b2PolygonShape*>(shapeB), input->transformB, false);
+	}
+	else if (typeA == b2Shape::e_polygon && typeB == b2Shape::e_circle)
+	{
+		solved = b2DistanceCirclePolygon(output, cache,
+			static_cast<const b2CircleShape*>(shapeB), input->transformB,
+			static_cast<const b2PolygonShape*>(shapeA), input->transformA, true);
+	}
+
+	if (solved == false)
+	{
+		b2DistanceProxy proxyA, proxyB;
+		proxyA.Set(shapeA, input->childIndexA);
+		proxyB.Set(shapeB, input->childIndexB);
+
+		b2DistanceGJK(output, cache, &proxyA, input->transformA, &proxyB, input->transformB);
+	}
+
+	// Every shape type gives its proxy the shape radius.
+	if (input->useRadii)
+	{
+		b2ApplyRadii(output, shapeA->m_radius, shapeB->m_radius);
+	}
+}
+
+struct b2DistanceBatch
+{
+	b2DistanceOutput* outputs;
+	b2SimplexCache* caches;
+	const b2ShapeDistanceInput* inputs;
+};
+
+static void b2DistanceManyTask(int32 startIndex, int32 endIndex, void* context)
+{
+	b2DistanceBatch* batch = (b2DistanceBatch*)context;
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		b2ShapeDistance(batch->outputs + i, batch->caches + i, batch->inputs + i);
+	}
+}
+
+void b2DistanceMany(b2DistanceOutput* outputs,
+				b2SimplexCache* caches,
+				const b2ShapeDistanceInput* inputs,
+				int32 count,
+				b2TaskExecutor* executor)
+{
+	b2DistanceBatch batch;
+	batch.outputs = outputs;
+	batch.caches = caches;
+	batch.inputs = inputs;
+
+	b2ParallelFor(executor, b2DistanceManyTask, count, 64, &batch);
+}
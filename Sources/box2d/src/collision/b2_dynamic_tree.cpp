@@ -20,6 +20,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 #include "box2d/b2_dynamic_tree.h"
+
+#include "b2_simd.h"
+
 #include <string.h>
 
 b2DynamicTree::b2DynamicTree()
@@ -63,6 +66,7 @@ int32 b2DynamicTree::AllocateNode()
 		m_nodeCapacity *= 2;
 		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
 		memcpy(m_nodes, oldNodes, m_nodeCount * sizeof(b2TreeNode));
+		memset(m_nodes + m_nodeCount, 0, (m_nodeCapacity - m_nodeCount) * sizeof(b2TreeNode));
 		b2Free(oldNodes);
 
 		// Build a linked list for the free list. The parent
@@ -101,6 +105,77 @@ void b2DynamicTree::FreeNode(int32 nodeId)
 	--m_nodeCount;
 }
 
+// Move a live node into a free slot and patch the links that point at it.
+void b2DynamicTree::MoveNode(int32 fromId, int32 toId)
+{
+	b2Assert(0 <= fromId && fromId < m_nodeCapacity);
+	b2Assert(0 <= toId && toId < m_nodeCapacity);
+	b2Assert(m_nodes[fromId].height >= 0);
+	b2Assert(m_nodes[toId].height == -1);
+
+	m_nodes[toId] = m_nodes[fromId];
+	b2TreeNode* node = m_nodes + toId;
+
+	if (node->parent == b2_nullNode)
+	{
+		b2Assert(m_root == fromId);
+		m_root = toId;
+	}
+	else
+	{
+		b2TreeNode* parent = m_nodes + node->parent;
+		if (parent->child1 == fromId)
+		{
+			parent->child1 = toId;
+		}
+		else
+		{
+			b2Assert(parent->child2 == fromId);
+			parent->child2 = toId;
+		}
+	}
+
+	if (node->IsLeaf() == false)
+	{
+		m_nodes[node->child1].parent = toId;
+		m_nodes[node->child2].parent = toId;
+	}
+
+	// The free list is rebuilt by ShrinkPool.
+	m_nodes[fromId].height = -1;
+}
+
+// Release the unused tail of the node pool and rebuild the free list in
+// ascending order so new nodes are taken from the front of the pool.
+void b2DynamicTree::ShrinkPool()
+{
+	int32 lastUsed = m_nodeCapacity - 1;
+	while (lastUsed >= 0 && m_nodes[lastUsed].height == -1)
+	{
+		--lastUsed;
+	}
+
+	int32 capacity = b2Max(lastUsed + 1, 16);
+	if (capacity <= m_nodeCapacity / 2)
+	{
+		b2TreeNode* oldNodes = m_nodes;
+		m_nodes = (b2TreeNode*)b2Alloc(capacity * sizeof(b2TreeNode));
+		memcpy(m_nodes, oldNodes, capacity * sizeof(b2TreeNode));
+		b2Free(oldNodes);
+		m_nodeCapacity = capacity;
+	}
+
+	m_freeList = b2_nullNode;
+	for (int32 i = m_nodeCapacity - 1; i >= 0; --i)
+	{
+		if (m_nodes[i].height == -1)
+		{
+			m_nodes[i].next = m_freeList;
+			m_freeList = i;
+		}
+	}
+}
+
 // Create a proxy in the tree as a leaf node. We return the index
 // of the node instead of a pointer so that we can grow
 // the node pool.
@@ -194,6 +269,62 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 	return true;
 }
 
+void b2DynamicTree::TestMoves(const int32* proxyIds, const b2AABB* aabbs, const b2Vec2* displacements, int32 count, bool* needsMove) const
+{
+#if defined(B2_SIMD_SSE2) || defined(B2_SIMD_NEON)
+	// A box is held as (lower.x, lower.y, -upper.x, -upper.y) so that both halves of
+	// b2AABB::Contains become one lane-wise compare.
+	b2FloatW sign = b2SetW(1.0f, 1.0f, -1.0f, -1.0f);
+	b2FloatW m = b2MulW(sign, b2SplatW(b2_aabbMultiplier));
+	b2FloatW r = b2SplatW(b2_aabbExtension);
+	b2FloatW r4 = b2SplatW(4.0f * b2_aabbExtension);
+	b2FloatW zero = b2SplatW(0.0f);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = proxyIds[i];
+		b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+		b2Assert(m_nodes[proxyId].IsLeaf());
+
+		b2FloatW aabb = b2MulW(sign, b2LoadW(&aabbs[i].lowerBound.x));
+		b2FloatW treeAABB = b2MulW(sign, b2LoadW(&m_nodes[proxyId].aabb.lowerBound.x));
+		b2FloatW d = b2MulW(m, b2SetW(displacements[i].x, displacements[i].y, displacements[i].x, displacements[i].y));
+
+		// Same as MoveProxy: the fat AABB grows by the predicted motion and the huge
+		// AABB by four more margins.
+		b2FloatW fatAABB = b2AddW(b2SubW(aabb, r), b2MinW(d, zero));
+		b2FloatW hugeAABB = b2SubW(fatAABB, r4);
+
+		needsMove[i] = (b2AllLessEqualW(treeAABB, aabb) && b2AllLessEqualW(hugeAABB, treeAABB)) == false;
+	}
+#else
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = proxyIds[i];
+		b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+		b2Assert(m_nodes[proxyId].IsLeaf());
+
+		const b2AABB& aabb = aabbs[i];
+		b2AABB fatAABB;
+		fatAABB.lowerBound = aabb.lowerBound - r;
+		fatAABB.upperBound = aabb.upperBound + r;
+
+		b2Vec2 d = b2_aabbMultiplier * displacements[i];
+		fatAABB.lowerBound += b2Min(d, b2Vec2_zero);
+		fatAABB.upperBound += b2Max(d, b2Vec2_zero);
+
+		b2AABB hugeAABB;
+		hugeAABB.lowerBound = fatAABB.lowerBound - 4.0f * r;
+		hugeAABB.upperBound = fatAABB.upperBound + 4.0f * r;
+
+		const b2AABB& treeAABB = m_nodes[proxyId].aabb;
+		needsMove[i] = (treeAABB.Contains(aabb) && hugeAABB.Contains(treeAABB)) == false;
+	}
+#endif
+}
+
 void b2DynamicTree::InsertLeaf(int32 leaf)
 {
 	++m_insertionCount;
@@ -799,3 +930,95 @@ void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 		m_nodes[i].aabb.upperBound -= newOrigin;
 	}
 }
+
+// The scalar members are stored in front of the node pool.
+struct b2TreeState
+{
+	int32 root;
+	int32 nodeCount;
+	int32 nodeCapacity;
+	int32 freeList;
+	int32 insertionCount;
+};
+
+int32 b2DynamicTree::GetStateSize() const
+{
+	return int32(sizeof(b2TreeState) + m_nodeCapacity * sizeof(b2TreeNode));
+}
+
+void b2DynamicTree::SaveState(void* buffer) const
+{
+	b2TreeState state;
+	state.root = m_root;
+	state.nodeCount = m_nodeCount;
+	state.nodeCapacity = m_nodeCapacity;
+	state.freeList = m_freeList;
+	state.insertionCount = m_insertionCount;
+
+	char* p = (char*)buffer;
+	memcpy(p, &state, sizeof(b2TreeState));
+	memcpy(p + sizeof(b2TreeState), m_nodes, m_nodeCapacity * sizeof(b2TreeNode));
+}
+
+int32 b2DynamicTree::RestoreState(const void* buffer)
+{
+	const char* p = (const char*)buffer;
+	b2TreeState state;
+	memcpy(&state, p, sizeof(b2TreeState));
+
+	if (state.nodeCapacity != m_nodeCapacity)
+	{
+		b2Free(m_nodes);
+		m_nodeCapacity = state.nodeCapacity;
+		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+	}
+
+	memcpy(m_nodes, p + sizeof(b2TreeState), m_nodeCapacity * sizeof(b2TreeNode));
+	m_root = state.root;
+	m_nodeCount = state.nodeCount;
+	m_freeList = state.freeList;
+	m_insertionCount = state.insertionCount;
+
+	return GetStateSize();
+}
+
+int32 b2DynamicTree::ReadStateSize(const void* buffer, int32 size, int32* nodeCapacity)
+{
+	if (size < int32(sizeof(b2TreeState)))
+	{
+		return 0;
+	}
+
+	b2TreeState state;
+	memcpy(&state, buffer, sizeof(b2TreeState));
+
+	int32 maxCapacity = (size - int32(sizeof(b2TreeState))) / int32(sizeof(b2TreeNode));
+	if (state.nodeCapacity < 0 || state.nodeCapacity > maxCapacity ||
+		state.nodeCount < 0 || state.nodeCount > state.nodeCapacity ||
+		state.root < b2_nullNode || state.root >= state.nodeCapacity ||
+		state.freeList < b2_nullNode || state.freeList >= state.nodeCapacity)
+	{
+		return 0;
+	}
+
+	// Node links must stay inside the pool.
+	const char* nodes = (const char*)buffer + sizeof(b2TreeState);
+	for (int32 i = 0; i < state.nodeCapacity; ++i)
+	{
+		b2TreeNode node;
+		memcpy(&node, nodes + i * sizeof(b2TreeNode), sizeof(b2TreeNode));
+		if (node.parent < b2_nullNode || node.parent >= state.nodeCapacity ||
+			node.child1 < b2_nullNode || node.child1 >= state.nodeCapacity ||
+			node.child2 < b2_nullNode || node.child2 >= state.nodeCapacity)
+		{
+			return 0;
+		}
+	}
+
+	if (nodeCapacity)
+	{
+		*nodeCapacity = state.nodeCapacity;
+	}
+
+	return int32(sizeof(b2TreeState) + state.nodeCapacity * sizeof(b2TreeNode));
+}
@@ -0,0 +1,260 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_height_field_shape.h"
+#include "box2d/b2_edge_shape.h"
+
+#include "box2d/b2_block_allocator.h"
+
+#include <new>
+
+b2HeightFieldShape::~b2HeightFieldShape()
+{
+	Clear();
+}
+
+void b2HeightFieldShape::Clear()
+{
+	b2Free(m_heights);
+	m_heights = nullptr;
+	m_count = 0;
+}
+
+void b2HeightFieldShape::CreateHeights(const float* heights, int32 count, float spacing, float minHeight, float maxHeight)
+{
+	b2Assert(m_heights == nullptr && m_count == 0);
+	b2Assert(count >= 2);
+	b2Assert(spacing > b2_linearSlop);
+	b2Assert(minHeight <= maxHeight);
+
+	m_count = count;
+	m_spacing = spacing;
+	m_minHeight = minHeight;
+	m_maxHeight = maxHeight;
+	m_heights = (float*)b2Alloc(count * sizeof(float));
+	SetHeights(0, heights, count);
+}
+
+void b2HeightFieldShape::SetHeights(int32 start, const float* heights, int32 count)
+{
+	b2Assert(0 <= start && start + count <= m_count);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_heights[start + i] = b2Clamp(heights[i], m_minHeight, m_maxHeight);
+	}
+}
+
+bool b2HeightFieldShape::GetCellRange(float lowerX, float upperX, int32* lowerCell, int32* upperCell) const
+{
+	int32 cellCount = m_count - 1;
+	float width = cellCount * m_spacing;
+	if (upperX < 0.0f || lowerX > width)
+	{
+		return false;
+	}
+
+	float inverseSpacing = 1.0f / m_spacing;
+	*lowerCell = b2Max(int32(lowerX * inverseSpacing), 0);
+	*upperCell = b2Min(int32(upperX * inverseSpacing), cellCount - 1);
+	return true;
+}
+
+void b2HeightFieldShape::GetCellEdge(b2EdgeShape* edge, int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+	edge->m_type = b2Shape::e_edge;
+	edge->m_radius = m_radius;
+
+	// The edge runs from right to left so that its normal points up.
+	float x = index * m_spacing;
+	edge->m_vertex1.Set(x + m_spacing, m_heights[index + 1]);
+	edge->m_vertex2.Set(x, m_heights[index]);
+	edge->m_oneSided = true;
+
+	// The terrain continues flat past its ends.
+	if (index + 2 < m_count)
+	{
+		edge->m_vertex0.Set(x + 2.0f * m_spacing, m_heights[index + 2]);
+	}
+	else
+	{
+		edge->m_vertex0.Set(x + 2.0f * m_spacing, m_heights[index + 1]);
+	}
+
+	if (index > 0)
+	{
+		edge->m_vertex3.Set(x - m_spacing, m_heights[index - 1]);
+	}
+	else
+	{
+		edge->m_vertex3.Set(x - m_spacing, m_heights[index]);
+	}
+}
+
+void b2HeightFieldShape::ComputeCellAABB(b2AABB* aabb, const b2Transform& xf, int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+
+	float x = index * m_spacing;
+	b2Vec2 v1 = b2Mul(xf, b2Vec2(x, m_heights[index]));
+	b2Vec2 v2 = b2Mul(xf, b2Vec2(x + m_spacing, m_heights[index + 1]));
+
+	b2Vec2 lower = b2Min(v1, v2);
+	b2Vec2 upper = b2Max(v1, v2);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = lower - r;
+	aabb->upperBound = upper + r;
+}
+
+b2Shape* b2HeightFieldShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2HeightFieldShape));
+	b2HeightFieldShape* clone = new (mem) b2HeightFieldShape;
+	clone->CreateHeights(m_heights, m_count, m_spacing, m_minHeight, m_maxHeight);
+	return clone;
+}
+
+int32 b2HeightFieldShape::GetChildCount() const
+{
+	return 1;
+}
+
+bool b2HeightFieldShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	B2_NOT_USED(xf);
+	B2_NOT_USED(p);
+	return false;
+}
+
+// The cells are visited in order along the ray, so the first hit is the closest.
+bool b2HeightFieldShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+								const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Put the ray into the height field's frame of reference.
+	b2Vec2 p1 = b2MulT(xf, input.p1);
+	b2Vec2 p2 = b2MulT(xf, input.p2);
+	b2Vec2 d = p2 - p1;
+
+	// Clip the ray to the cells.
+	int32 cellCount = m_count - 1;
+	float width = cellCount * m_spacing;
+	float lower = 0.0f;
+	float upper = input.maxFraction;
+	if (d.x == 0.0f)
+	{
+		if (p1.x < 0.0f || width < p1.x)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		float inverseDx = 1.0f / d.x;
+		float t1 = -p1.x * inverseDx;
+		float t2 = (width - p1.x) * inverseDx;
+		lower = b2Max(lower, b2Min(t1, t2));
+		upper = b2Min(upper, b2Max(t1, t2));
+		if (lower > upper)
+		{
+			return false;
+		}
+	}
+
+	float inverseSpacing = 1.0f / m_spacing;
+	int32 cell = b2Clamp(int32((p1.x + lower * d.x) * inverseSpacing), 0, cellCount - 1);
+	int32 lastCell = b2Clamp(int32((p1.x + upper * d.x) * inverseSpacing), 0, cellCount - 1);
+	int32 step = lastCell >= cell ? 1 : -1;
+
+	b2EdgeShape edge;
+	edge.m_radius = m_radius;
+
+	for (;;)
+	{
+		float x1 = cell * m_spacing;
+		float x2 = x1 + m_spacing;
+		float h1 = m_heights[cell];
+		float h2 = m_heights[cell + 1];
+
+		// The ray height over the cell
+		float ta = lower;
+		float tb = upper;
+		if (d.x != 0.0f)
+		{
+			float t1 = (x1 - p1.x) / d.x;
+			float t2 = (x2 - p1.x) / d.x;
+			ta = b2Max(ta, b2Min(t1, t2));
+			tb = b2Min(tb, b2Max(t1, t2));
+		}
+
+		float ya = p1.y + ta * d.y;
+		float yb = p1.y + tb * d.y;
+
+		// Skip cells the ray passes above or below.
+		if (b2Min(ya, yb) <= b2Max(h1, h2) && b2Max(ya, yb) >= b2Min(h1, h2))
+		{
+			edge.m_vertex1.Set(x1, h1);
+			edge.m_vertex2.Set(x2, h2);
+			if (edge.RayCast(output, input, xf, 0))
+			{
+				return true;
+			}
+		}
+
+		if (cell == lastCell)
+		{
+			break;
+		}
+
+		cell += step;
+	}
+
+	return false;
+}
+
+void b2HeightFieldShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Rotate the local bounds.
+	float width = (m_count - 1) * m_spacing;
+	b2Vec2 center = b2Mul(xf, b2Vec2(0.5f * width, 0.5f * (m_minHeight + m_maxHeight)));
+	b2Vec2 h(0.5f * width + m_radius, 0.5f * (m_maxHeight - m_minHeight) + m_radius);
+	float c = b2Abs(xf.q.c);
+	float s = b2Abs(xf.q.s);
+	b2Vec2 extents(c * h.x + s * h.y, s * h.x + c * h.y);
+
+	aabb->lowerBound = center - extents;
+	aabb->upperBound = center + extents;
+}
+
+void b2HeightFieldShape::ComputeMass(b2MassData* massData, float density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
@@ -0,0 +1,284 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_mesh_shape.h"
+
+#include "box2d/b2_block_allocator.h"
+
+#include <new>
+#include <string.h>
+
+// A segment while the tree is built.
+struct b2MeshLeaf
+{
+	b2AABB aabb;
+	b2Vec2 center;
+	int32 segment;
+};
+
+// Partition the leaves so the first k have the smallest centers along the axis.
+static void b2SelectMeshLeaves(b2MeshLeaf* leaves, int32 count, int32 k, int32 axis)
+{
+	int32 left = 0;
+	int32 right = count - 1;
+	while (left < right)
+	{
+		float pivot = leaves[(left + right) / 2].center(axis);
+		int32 i = left;
+		int32 j = right;
+		while (i <= j)
+		{
+			while (leaves[i].center(axis) < pivot)
+			{
+				++i;
+			}
+
+			while (leaves[j].center(axis) > pivot)
+			{
+				--j;
+			}
+
+			if (i <= j)
+			{
+				b2MeshLeaf tmp = leaves[i];
+				leaves[i] = leaves[j];
+				leaves[j] = tmp;
+				++i;
+				--j;
+			}
+		}
+
+		if (k <= j)
+		{
+			right = j;
+		}
+		else if (k >= i)
+		{
+			left = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+// Build the subtree of the leaves at the given node index by splitting at the median
+// center along the longest axis. Returns the index after the subtree.
+static int32 b2BuildMeshNodes(b2MeshNode* nodes, int32 index, b2MeshLeaf* leaves, int32 count)
+{
+	b2MeshNode* node = nodes + index;
+
+	if (count == 1)
+	{
+		node->aabb = leaves[0].aabb;
+		node->segment = leaves[0].segment;
+		node->skip = index + 1;
+		return index + 1;
+	}
+
+	b2AABB aabb = leaves[0].aabb;
+	b2Vec2 lower = leaves[0].center;
+	b2Vec2 upper = leaves[0].center;
+	for (int32 i = 1; i < count; ++i)
+	{
+		aabb.Combine(leaves[i].aabb);
+		lower = b2Min(lower, leaves[i].center);
+		upper = b2Max(upper, leaves[i].center);
+	}
+
+	node->aabb = aabb;
+	node->segment = -1;
+
+	int32 axis = upper.x - lower.x >= upper.y - lower.y ? 0 : 1;
+	int32 half = count / 2;
+	b2SelectMeshLeaves(leaves, count, half, axis);
+
+	int32 next = b2BuildMeshNodes(nodes, index + 1, leaves, half);
+	next = b2BuildMeshNodes(nodes, next, leaves + half, count - half);
+
+	node->skip = next;
+	return next;
+}
+
+b2MeshShape::~b2MeshShape()
+{
+	b2Free(m_nodes);
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+}
+
+void b2MeshShape::Clear()
+{
+	b2Free(m_nodes);
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+	b2ChainShape::Clear();
+}
+
+void b2MeshShape::CreateLoop(const b2Vec2* vertices, int32 count)
+{
+	b2ChainShape::CreateLoop(vertices, count);
+	BuildTree();
+}
+
+void b2MeshShape::CreateChain(const b2Vec2* vertices, int32 count, const b2Vec2& prevVertex, const b2Vec2& nextVertex)
+{
+	b2ChainShape::CreateChain(vertices, count, prevVertex, nextVertex);
+	BuildTree();
+}
+
+void b2MeshShape::BuildTree()
+{
+	b2Assert(m_nodes == nullptr);
+
+	int32 segmentCount = m_count - 1;
+	if (segmentCount < 1)
+	{
+		return;
+	}
+
+	b2MeshLeaf* leaves = (b2MeshLeaf*)b2Alloc(segmentCount * sizeof(b2MeshLeaf));
+
+	b2Transform identity;
+	identity.SetIdentity();
+	for (int32 i = 0; i < segmentCount; ++i)
+	{
+		b2MeshLeaf* leaf = leaves + i;
+		ComputeSegmentAABB(&leaf->aabb, identity, i);
+		leaf->center = leaf->aabb.GetCenter();
+		leaf->segment = i;
+	}
+
+	m_nodeCount = 2 * segmentCount - 1;
+	m_nodes = (b2MeshNode*)b2Alloc(m_nodeCount * sizeof(b2MeshNode));
+	b2BuildMeshNodes(m_nodes, 0, leaves, segmentCount);
+
+	b2Free(leaves);
+}
+
+b2Shape* b2MeshShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2MeshShape));
+	b2MeshShape* clone = new (mem) b2MeshShape;
+	clone->b2ChainShape::CreateChain(m_vertices, m_count, m_prevVertex, m_nextVertex);
+
+	// The tree only depends on the vertices.
+	clone->m_nodeCount = m_nodeCount;
+	clone->m_nodes = (b2MeshNode*)b2Alloc(m_nodeCount * sizeof(b2MeshNode));
+	memcpy(clone->m_nodes, m_nodes, m_nodeCount * sizeof(b2MeshNode));
+	return clone;
+}
+
+int32 b2MeshShape::GetChildCount() const
+{
+	return 1;
+}
+
+bool b2MeshShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Walk the tree in local coordinates.
+	b2Vec2 p1 = b2MulT(xf, input.p1);
+	b2Vec2 p2 = b2MulT(xf, input.p2);
+	b2Vec2 r = p2 - p1;
+	if (r.LengthSquared() == 0.0f)
+	{
+		return false;
+	}
+	r.Normalize();
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2Cross(1.0f, r);
+	b2Vec2 abs_v = b2Abs(v);
+
+	float maxFraction = input.maxFraction;
+
+	// Build a bounding box for the segment.
+	b2AABB segmentAABB;
+	{
+		b2Vec2 t = p1 + maxFraction * (p2 - p1);
+		segmentAABB.lowerBound = b2Min(p1, t);
+		segmentAABB.upperBound = b2Max(p1, t);
+	}
+
+	bool hit = false;
+	int32 index = 0;
+	while (index < m_nodeCount)
+	{
+		const b2MeshNode* node = m_nodes + index;
+
+		// Separating axis for segment (Gino, p80).
+		// |dot(v, p1 - c)| > dot(|v|, h)
+		b2Vec2 c = node->aabb.GetCenter();
+		b2Vec2 h = node->aabb.GetExtents();
+		float separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+		if (separation > 0.0f || b2TestOverlap(node->aabb, segmentAABB) == false)
+		{
+			index = node->skip;
+			continue;
+		}
+
+		if (node->segment != -1)
+		{
+			b2RayCastInput subInput;
+			subInput.p1 = input.p1;
+			subInput.p2 = input.p2;
+			subInput.maxFraction = maxFraction;
+
+			b2RayCastOutput subOutput;
+			if (b2ChainShape::RayCast(&subOutput, subInput, xf, node->segment))
+			{
+				// Keep the closest hit.
+				hit = true;
+				*output = subOutput;
+				maxFraction = subOutput.fraction;
+				b2Vec2 t = p1 + maxFraction * (p2 - p1);
+				segmentAABB.lowerBound = b2Min(p1, t);
+				segmentAABB.upperBound = b2Max(p1, t);
+			}
+		}
+
+		++index;
+	}
+
+	return hit;
+}
+
+void b2MeshShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+	b2Assert(m_nodeCount > 0);
+
+	// Rotate the local bounds.
+	const b2AABB& bounds = m_nodes[0].aabb;
+	b2Vec2 center = b2Mul(xf, bounds.GetCenter());
+	b2Vec2 h = bounds.GetExtents();
+	float c = b2Abs(xf.q.c);
+	float s = b2Abs(xf.q.s);
+	b2Vec2 extents(c * h.x + s * h.y, s * h.x + c * h.y);
+
+	aabb->lowerBound = center - extents;
+	aabb->upperBound = center + extents;
+}
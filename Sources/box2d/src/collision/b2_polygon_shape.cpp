@@ -23,6 +23,8 @@
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_block_allocator.h"
 
+#include "b2_simd.h"
+
 #include <new>
 
 b2Shape* b2PolygonShape::Clone(b2BlockAllocator* allocator) const
@@ -354,6 +356,42 @@ void b2PolygonShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 chil
 	aabb->upperBound = upper + r;
 }
 
+void b2PolygonShape::ComputeAABBs(b2AABB* aabb1, b2AABB* aabb2, const b2Transform& xf1, const b2Transform& xf2, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+#if defined(B2_SIMD_SSE2) || defined(B2_SIMD_NEON)
+	// Transform each vertex by both transforms at once. The lanes hold (x1, y1, x2, y2),
+	// so the bounds need no reduction across lanes.
+	b2FloatW qx = b2SetW(xf1.q.c, xf1.q.s, xf2.q.c, xf2.q.s);
+	b2FloatW qy = b2SetW(-xf1.q.s, xf1.q.c, -xf2.q.s, xf2.q.c);
+	b2FloatW p = b2SetW(xf1.p.x, xf1.p.y, xf2.p.x, xf2.p.y);
+
+	b2FloatW lower = b2AddW(b2AddW(b2MulW(qx, b2SplatW(m_vertices[0].x)), b2MulW(qy, b2SplatW(m_vertices[0].y))), p);
+	b2FloatW upper = lower;
+
+	for (int32 i = 1; i < m_count; ++i)
+	{
+		b2FloatW v = b2AddW(b2AddW(b2MulW(qx, b2SplatW(m_vertices[i].x)), b2MulW(qy, b2SplatW(m_vertices[i].y))), p);
+		lower = b2MinW(lower, v);
+		upper = b2MaxW(upper, v);
+	}
+
+	float l[4], u[4];
+	b2StoreW(l, lower);
+	b2StoreW(u, upper);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb1->lowerBound = b2Vec2(l[0], l[1]) - r;
+	aabb1->upperBound = b2Vec2(u[0], u[1]) + r;
+	aabb2->lowerBound = b2Vec2(l[2], l[3]) - r;
+	aabb2->upperBound = b2Vec2(u[2], u[3]) + r;
+#else
+	ComputeAABB(aabb1, xf1, 0);
+	ComputeAABB(aabb2, xf2, 0);
+#endif
+}
+
 void b2PolygonShape::ComputeMass(b2MassData* massData, float density) const
 {
 	// Polygon mass, centroid, and inertia.
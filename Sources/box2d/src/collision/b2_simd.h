@@ -0,0 +1,72 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_SIMD_H
+#define B2_SIMD_H
+
+#include "box2d/b2_types.h"
+
+// Four floats at a time where the platform has 4-wide float vectors. Define
+// B2_NO_SIMD to use the scalar loops. The vector code performs the same operations
+// in the same order as the scalar code, so with B2_DETERMINISTIC, which stops the
+// compiler from fusing multiplies and adds, both give bit-identical results.
+#if defined(B2_NO_SIMD)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define B2_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(B2_SIMD_SSE2)
+typedef __m128 b2FloatW;
+static inline b2FloatW b2SplatW(float a) { return _mm_set1_ps(a); }
+static inline b2FloatW b2SetW(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static inline b2FloatW b2LoadW(const float* a) { return _mm_loadu_ps(a); }
+static inline void b2StoreW(float* a, b2FloatW b) { _mm_storeu_ps(a, b); }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return _mm_add_ps(a, b); }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return _mm_sub_ps(a, b); }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return _mm_mul_ps(a, b); }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return _mm_min_ps(a, b); }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return _mm_max_ps(a, b); }
+static inline bool b2AllLessEqualW(b2FloatW a, b2FloatW b) { return _mm_movemask_ps(_mm_cmple_ps(a, b)) == 0xF; }
+#elif defined(B2_SIMD_NEON)
+typedef float32x4_t b2FloatW;
+static inline b2FloatW b2SplatW(float a) { return vdupq_n_f32(a); }
+static inline b2FloatW b2SetW(float a, float b, float c, float d) { float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+static inline b2FloatW b2LoadW(const float* a) { return vld1q_f32(a); }
+static inline void b2StoreW(float* a, b2FloatW b) { vst1q_f32(a, b); }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return vaddq_f32(a, b); }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return vsubq_f32(a, b); }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return vmulq_f32(a, b); }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return vminq_f32(a, b); }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return vmaxq_f32(a, b); }
+static inline bool b2AllLessEqualW(b2FloatW a, b2FloatW b)
+{
+	uint32x4_t m = vcleq_f32(a, b);
+	uint32x2_t h = vand_u32(vget_low_u32(m), vget_high_u32(m));
+	return (vget_lane_u32(h, 0) & vget_lane_u32(h, 1)) != 0;
+}
+#endif
+
+#endif
@@ -27,11 +27,13 @@
 #include "box2d/b2_time_of_impact.h"
 #include "box2d/b2_timer.h"
 
+#include "b2_counters.h"
+
 #include <stdio.h>
 
-B2_API float b2_toiTime, b2_toiMaxTime;
-B2_API int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
+B2_API std::atomic<float> b2_toiTime, b2_toiMaxTime;
+B2_API std::atomic<int32> b2_toiCalls, b2_toiIters, b2_toiMaxIters;
+B2_API std::atomic<int32> b2_toiRootIters, b2_toiMaxRootIters;
 
 //
 struct b2SeparationFunction
@@ -259,7 +261,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 {
 	b2Timer timer;
 
-	++b2_toiCalls;
+	b2CounterAdd(b2_toiCalls, 1);
 
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
@@ -275,6 +277,10 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 	sweepA.Normalize();
 	sweepB.Normalize();
 
+	// Callers only have to fill in the angles.
+	sweepA.q0.Set(sweepA.a0);
+	sweepB.q0.Set(sweepB.a0);
+
 	float tMax = input->tMax;
 
 	float totalRadius = proxyA->m_radius + proxyB->m_radius;
@@ -426,7 +432,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
-				++b2_toiRootIters;
 
 				float s = fcn.Evaluate(indexA, indexB, t);
 
@@ -455,7 +460,8 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 			}
 
-			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
+			b2CounterAdd(b2_toiRootIters, rootIterCount);
+			b2CounterMax(b2_toiMaxRootIters, rootIterCount);
 
 			++pushBackIter;
 
@@ -466,7 +472,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
-		++b2_toiIters;
 
 		if (done)
 		{
@@ -482,9 +487,10 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
-	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
+	b2CounterAdd(b2_toiIters, iter);
+	b2CounterMax(b2_toiMaxIters, iter);
 
 	float time = timer.GetMilliseconds();
-	b2_toiMaxTime = b2Max(b2_toiMaxTime, time);
-	b2_toiTime += time;
+	b2CounterMax(b2_toiMaxTime, time);
+	b2CounterAdd(b2_toiTime, time);
 }
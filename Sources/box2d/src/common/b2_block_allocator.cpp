@@ -24,6 +24,7 @@
 #include <limits.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdlib.h>
 
 static const int32 b2_chunkSize = 16 * 1024;
 static const int32 b2_maxBlockSize = 640;
@@ -228,3 +229,154 @@ void b2BlockAllocator::Clear()
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 }
+
+static int b2CompareChunks(const void* a, const void* b)
+{
+	const int8* blocksA = (const int8*)((const b2Chunk*)a)->blocks;
+	const int8* blocksB = (const int8*)((const b2Chunk*)b)->blocks;
+	return blocksA < blocksB ? -1 : (blocksA > blocksB ? 1 : 0);
+}
+
+static int b2CompareBlocks(const void* a, const void* b)
+{
+	const int8* blockA = *(const int8* const*)a;
+	const int8* blockB = *(const int8* const*)b;
+	return blockA < blockB ? -1 : (blockA > blockB ? 1 : 0);
+}
+
+int32 b2BlockAllocator::Compact()
+{
+	if (m_chunkCount == 0)
+	{
+		return 0;
+	}
+
+	// Gather the free blocks of each size.
+	int32 freeCount = 0;
+	int32 listStarts[b2_blockSizeCount + 1];
+	for (int32 i = 0; i < b2_blockSizeCount; ++i)
+	{
+		listStarts[i] = freeCount;
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			++freeCount;
+		}
+	}
+	listStarts[b2_blockSizeCount] = freeCount;
+
+	if (freeCount == 0)
+	{
+		return 0;
+	}
+
+	b2Block** blocks = (b2Block**)b2Alloc(freeCount * sizeof(b2Block*));
+	for (int32 i = 0; i < b2_blockSizeCount; ++i)
+	{
+		int32 count = listStarts[i];
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			blocks[count++] = block;
+		}
+
+		qsort(blocks + listStarts[i], count - listStarts[i], sizeof(b2Block*), b2CompareBlocks);
+	}
+
+	// Chunks sorted by address let us find the chunk of each free block with a linear sweep.
+	qsort(m_chunks, m_chunkCount, sizeof(b2Chunk), b2CompareChunks);
+
+	int32* chunkFreeCounts = (int32*)b2Alloc(m_chunkCount * sizeof(int32));
+	memset(chunkFreeCounts, 0, m_chunkCount * sizeof(int32));
+
+	for (int32 i = 0; i < b2_blockSizeCount; ++i)
+	{
+		int32 chunkIndex = 0;
+		for (int32 j = listStarts[i]; j < listStarts[i + 1]; ++j)
+		{
+			int8* p = (int8*)blocks[j];
+			while ((int8*)m_chunks[chunkIndex].blocks + b2_chunkSize <= p)
+			{
+				++chunkIndex;
+				b2Assert(chunkIndex < m_chunkCount);
+			}
+
+			b2Assert((int8*)m_chunks[chunkIndex].blocks <= p);
+			b2Assert(m_chunks[chunkIndex].blockSize == b2_blockSizes[i]);
+			++chunkFreeCounts[chunkIndex];
+		}
+	}
+
+	// A chunk is empty when all of its blocks are on the free list. Use the
+	// free count array to flag empty chunks.
+	int32 releaseCount = 0;
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		int32 blockCount = b2_chunkSize / m_chunks[i].blockSize;
+		bool empty = chunkFreeCounts[i] == blockCount;
+		chunkFreeCounts[i] = empty ? 1 : 0;
+		releaseCount += empty ? 1 : 0;
+	}
+
+	// Rebuild the free lists in address order, dropping blocks of empty chunks.
+	for (int32 i = 0; i < b2_blockSizeCount; ++i)
+	{
+		b2Block** tail = m_freeLists + i;
+		int32 chunkIndex = 0;
+		for (int32 j = listStarts[i]; j < listStarts[i + 1]; ++j)
+		{
+			int8* p = (int8*)blocks[j];
+			while ((int8*)m_chunks[chunkIndex].blocks + b2_chunkSize <= p)
+			{
+				++chunkIndex;
+			}
+
+			if (chunkFreeCounts[chunkIndex] == 0)
+			{
+				*tail = blocks[j];
+				tail = &blocks[j]->next;
+			}
+		}
+		*tail = nullptr;
+	}
+
+	b2Free(blocks);
+
+	// Release the empty chunks and pack the chunk array.
+	int32 chunkCount = 0;
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		if (chunkFreeCounts[i] == 1)
+		{
+			b2Free(m_chunks[i].blocks);
+		}
+		else
+		{
+			m_chunks[chunkCount++] = m_chunks[i];
+		}
+	}
+
+	b2Free(chunkFreeCounts);
+
+	m_chunkCount = chunkCount;
+
+	int32 chunkSpace = b2_chunkArrayIncrement;
+	while (chunkSpace < m_chunkCount)
+	{
+		chunkSpace += b2_chunkArrayIncrement;
+	}
+
+	if (chunkSpace < m_chunkSpace)
+	{
+		b2Chunk* oldChunks = m_chunks;
+		m_chunkSpace = chunkSpace;
+		m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+		memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
+		memset(m_chunks + m_chunkCount, 0, (m_chunkSpace - m_chunkCount) * sizeof(b2Chunk));
+		b2Free(oldChunks);
+	}
+	else
+	{
+		memset(m_chunks + m_chunkCount, 0, (m_chunkSpace - m_chunkCount) * sizeof(b2Chunk));
+	}
+
+	return releaseCount;
+}
@@ -24,6 +24,26 @@
 
 const b2Vec2 b2Vec2_zero(0.0f, 0.0f);
 
+// These are not inline so that the mode is chosen by how the library is compiled.
+float b2Atan2(float y, float x)
+{
+#ifdef B2_DETERMINISTIC
+	return b2PortableAtan2(y, x);
+#else
+	return atan2f(y, x);
+#endif
+}
+
+void b2CosSin(float angle, float* cosine, float* sine)
+{
+#ifdef B2_DETERMINISTIC
+	b2PortableCosSin(angle, cosine, sine);
+#else
+	*sine = sinf(angle);
+	*cosine = cosf(angle);
+#endif
+}
+
 /// Solve A * x = b, where b is a column vector. This is more efficient
 /// than computing the inverse in one-shot cases.
 b2Vec3 b2Mat33::Solve33(const b2Vec3& b) const
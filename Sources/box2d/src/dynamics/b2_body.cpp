@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include "box2d/b2_body.h"
+#include "box2d/b2_compound.h"
 #include "box2d/b2_contact.h"
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_joint.h"
@@ -43,6 +44,10 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	{
 		m_flags |= e_bulletFlag;
 	}
+	if (bd->speculative)
+	{
+		m_flags |= e_speculativeFlag;
+	}
 	if (bd->fixedRotation)
 	{
 		m_flags |= e_fixedRotationFlag;
@@ -70,6 +75,8 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_sweep.c = m_xf.p;
 	m_sweep.a0 = bd->angle;
 	m_sweep.a = bd->angle;
+	m_sweep.q0 = m_xf.q;
+	m_sweep.q = m_xf.q;
 	m_sweep.alpha0 = 0.0f;
 
 	m_jointList = nullptr;
@@ -101,6 +108,13 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_fixtureList = nullptr;
 	m_fixtureCount = 0;
+
+	m_compound = nullptr;
+	if (bd->compound)
+	{
+		void* mem = b2Alloc(sizeof(b2Compound));
+		m_compound = new (mem) b2Compound(this);
+	}
 }
 
 b2Body::~b2Body()
@@ -130,7 +144,12 @@ void b2Body::SetType(b2BodyType type)
 		m_linearVelocity.SetZero();
 		m_angularVelocity = 0.0f;
 		m_sweep.a0 = m_sweep.a;
+		m_sweep.q0 = m_sweep.q;
 		m_sweep.c0 = m_sweep.c;
+		if (IsAwake())
+		{
+			ReportAwake(false);
+		}
 		m_flags &= ~e_awakeFlag;
 		SynchronizeFixtures();
 	}
@@ -152,8 +171,20 @@ void b2Body::SetType(b2BodyType type)
 
 	// Touch the proxies so that new contacts will be created (when appropriate)
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	if (m_compound && m_compound->m_proxy.proxyId != b2BroadPhase::e_nullProxy)
+	{
+		broadPhase->TouchProxy(m_compound->m_proxy.proxyId);
+	}
+
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
+		// Sensors are not in the broad-phase, they find their overlaps every step.
+		// The solid fixtures of a compound body share its proxy.
+		if (f->m_isSensor || m_compound)
+		{
+			continue;
+		}
+
 		int32 proxyCount = f->m_proxyCount;
 		for (int32 i = 0; i < proxyCount; ++i)
 		{
@@ -184,6 +215,9 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 
 	fixture->m_next = m_fixtureList;
 	m_fixtureList = fixture;
+
+	fixture->m_id.index = m_world->m_fixtureSlots.Add(fixture);
+	fixture->m_id.generation = m_world->m_fixtureSlots.GetGeneration(fixture->m_id.index);
 	++m_fixtureCount;
 
 	fixture->m_body = this;
@@ -274,6 +308,8 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 
 	fixture->m_body = nullptr;
 	fixture->m_next = nullptr;
+	m_world->m_fixtureSlots.Remove(fixture->m_id.index);
+
 	fixture->Destroy(allocator);
 	fixture->~b2Fixture();
 	allocator->Free(fixture, sizeof(b2Fixture));
@@ -302,6 +338,7 @@ void b2Body::ResetMassData()
 		m_sweep.c0 = m_xf.p;
 		m_sweep.c = m_xf.p;
 		m_sweep.a0 = m_sweep.a;
+		m_sweep.q0 = m_sweep.q;
 		return;
 	}
 
@@ -430,41 +467,77 @@ void b2Body::SetTransform(const b2Vec2& position, float angle)
 
 	m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
 	m_sweep.a = angle;
+	m_sweep.q = m_xf.q;
 
 	m_sweep.c0 = m_sweep.c;
 	m_sweep.a0 = angle;
+	m_sweep.q0 = m_xf.q;
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	if (m_compound)
+	{
+		m_compound->Synchronize(broadPhase, m_xf, m_xf);
+	}
+
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
 		f->Synchronize(broadPhase, m_xf, m_xf);
 	}
 
+	m_world->MarkMoved(this);
+	m_world->ResetInterpolation(this);
+
 	// Check for new contacts the next step
 	m_world->m_newContacts = true;
 }
 
+void b2Body::ReportAwake(bool flag)
+{
+	m_world->MarkAwake(this, flag);
+}
+
+void b2Body::GetSweptTransforms(b2Transform* xf1, b2Transform* xf2) const
+{
+	const b2ContactManager* contactManager = &m_world->m_contactManager;
+
+	bool speculative = contactManager->m_speculativeContacts || (m_flags & e_speculativeFlag);
+	if ((m_flags & b2Body::e_awakeFlag) && speculative)
+	{
+		// Speculative contacts must exist before the shapes collide, so cover the
+		// motion of the next step instead of the motion of the last step.
+		float dt = contactManager->m_dt;
+		*xf1 = m_xf;
+		xf2->q = b2IntegrateRotation(m_sweep.q, dt * m_angularVelocity);
+		xf2->p = m_sweep.c + dt * m_linearVelocity - b2Mul(xf2->q, m_sweep.localCenter);
+	}
+	else if (m_flags & b2Body::e_awakeFlag)
+	{
+		xf1->q = m_sweep.q0;
+		xf1->p = m_sweep.c0 - b2Mul(xf1->q, m_sweep.localCenter);
+		*xf2 = m_xf;
+	}
+	else
+	{
+		*xf1 = m_xf;
+		*xf2 = m_xf;
+	}
+}
+
 void b2Body::SynchronizeFixtures()
 {
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 
-	if (m_flags & b2Body::e_awakeFlag)
-	{
-		b2Transform xf1;
-		xf1.q.Set(m_sweep.a0);
-		xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+	b2Transform xf1, xf2;
+	GetSweptTransforms(&xf1, &xf2);
 
-		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
-		{
-			f->Synchronize(broadPhase, xf1, m_xf);
-		}
+	if (m_compound)
+	{
+		m_compound->Synchronize(broadPhase, xf1, xf2);
 	}
-	else
+
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
-		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
-		{
-			f->Synchronize(broadPhase, m_xf, m_xf);
-		}
+		f->Synchronize(broadPhase, xf1, xf2);
 	}
 }
 
@@ -536,6 +609,30 @@ void b2Body::SetFixedRotation(bool flag)
 	ResetMassData();
 }
 
+void b2Body::SetSpeculative(bool flag)
+{
+	if (flag == IsSpeculative())
+	{
+		return;
+	}
+
+	if (flag)
+	{
+		m_flags |= e_speculativeFlag;
+	}
+	else
+	{
+		m_flags &= ~e_speculativeFlag;
+	}
+
+	// Refresh the contact mode of existing contacts.
+	bool speculativeContacts = m_world->m_contactManager.m_speculativeContacts;
+	for (b2ContactEdge* ce = m_contactList; ce; ce = ce->next)
+	{
+		ce->contact->UpdateSpeculativeFlag(speculativeContacts);
+	}
+}
+
 void b2Body::Dump()
 {
 	int32 bodyIndex = m_islandIndex;
@@ -556,6 +653,8 @@ void b2Body::Dump()
 	b2Dump("  bd.awake = bool(%d);\n", m_flags & e_awakeFlag);
 	b2Dump("  bd.fixedRotation = bool(%d);\n", m_flags & e_fixedRotationFlag);
 	b2Dump("  bd.bullet = bool(%d);\n", m_flags & e_bulletFlag);
+	b2Dump("  bd.speculative = bool(%d);\n", m_flags & e_speculativeFlag);
+	b2Dump("  bd.compound = bool(%d);\n", m_compound != nullptr);
 	b2Dump("  bd.enabled = bool(%d);\n", m_flags & e_enabledFlag);
 	b2Dump("  bd.gravityScale = %.9g;\n", m_gravityScale);
 	b2Dump("  bodies[%d] = m_world->CreateBody(&bd);\n", m_islandIndex);
@@ -43,7 +43,7 @@ void b2ChainAndPolygonContact::Destroy(b2Contact* contact, b2BlockAllocator* all
 b2ChainAndPolygonContact::b2ChainAndPolygonContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
 : b2Contact(fixtureA, indexA, fixtureB, indexB)
 {
-	b2Assert(m_fixtureA->GetType() == b2Shape::e_chain);
+	b2Assert(m_fixtureA->GetType() == b2Shape::e_chain || m_fixtureA->GetType() == b2Shape::e_mesh);
 	b2Assert(m_fixtureB->GetType() == b2Shape::e_polygon);
 }
 
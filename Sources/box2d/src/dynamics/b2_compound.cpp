@@ -0,0 +1,185 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_broad_phase.h"
+#include "box2d/b2_compound.h"
+#include "box2d/b2_fixture.h"
+
+// Bound an AABB after a transform.
+static b2AABB b2TransformAABB(const b2Transform& xf, const b2AABB& aabb)
+{
+	b2Vec2 center = b2Mul(xf, aabb.GetCenter());
+	b2Vec2 h = aabb.GetExtents();
+	float c = b2Abs(xf.q.c);
+	float s = b2Abs(xf.q.s);
+	b2Vec2 extents(c * h.x + s * h.y, s * h.x + c * h.y);
+
+	b2AABB result;
+	result.lowerBound = center - extents;
+	result.upperBound = center + extents;
+	return result;
+}
+
+// Bound an AABB before a transform.
+static b2AABB b2InvTransformAABB(const b2Transform& xf, const b2AABB& aabb)
+{
+	b2Vec2 center = b2MulT(xf, aabb.GetCenter());
+	b2Vec2 h = aabb.GetExtents();
+	float c = b2Abs(xf.q.c);
+	float s = b2Abs(xf.q.s);
+	b2Vec2 extents(c * h.x + s * h.y, s * h.x + c * h.y);
+
+	b2AABB result;
+	result.lowerBound = center - extents;
+	result.upperBound = center + extents;
+	return result;
+}
+
+// Combines the proxy bounds of every leaf of a compound tree.
+struct b2CompoundBoundsCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		const b2FixtureProxy* proxy = (const b2FixtureProxy*)tree->GetUserData(proxyId);
+		if (first)
+		{
+			aabb = proxy->aabb;
+			first = false;
+		}
+		else
+		{
+			aabb.Combine(proxy->aabb);
+		}
+		return true;
+	}
+
+	const b2DynamicTree* tree;
+	b2AABB aabb;
+	bool first;
+};
+
+b2Compound::b2Compound(b2Body* body)
+{
+	m_proxy.fixture = nullptr;
+	m_proxy.childIndex = -1;
+	m_proxy.proxyId = b2BroadPhase::e_nullProxy;
+	m_proxy.sensorIndex = -1;
+	m_body = body;
+	m_proxyCount = 0;
+	m_radius = 0.0f;
+	m_dirty = false;
+	m_transform1.SetIdentity();
+	m_transform2.SetIdentity();
+}
+
+void b2Compound::CreateProxy(b2FixtureProxy* proxy)
+{
+	proxy->proxyId = m_tree.CreateProxy(proxy->aabb, proxy);
+	++m_proxyCount;
+	m_dirty = true;
+}
+
+void b2Compound::DestroyProxy(b2FixtureProxy* proxy)
+{
+	m_tree.DestroyProxy(proxy->proxyId);
+	--m_proxyCount;
+	m_dirty = true;
+}
+
+void b2Compound::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transform1, const b2Transform& transform2)
+{
+	if (m_proxyCount == 0)
+	{
+		if (m_proxy.proxyId != b2BroadPhase::e_nullProxy)
+		{
+			broadPhase->DestroyProxy(m_proxy.proxyId);
+			m_proxy.proxyId = b2BroadPhase::e_nullProxy;
+		}
+
+		m_dirty = false;
+		return;
+	}
+
+	bool touch = m_dirty;
+	if (m_dirty)
+	{
+		// Bound the proxies in the tree. The body fixture list is no help here because a
+		// new fixture joins it only after its proxies are created.
+		b2CompoundBoundsCallback callback;
+		callback.tree = &m_tree;
+		callback.first = true;
+
+		b2AABB all;
+		all.lowerBound.Set(-b2_maxFloat, -b2_maxFloat);
+		all.upperBound.Set(b2_maxFloat, b2_maxFloat);
+		m_tree.Query(&callback, all);
+		m_localAABB = callback.aabb;
+
+		b2Vec2 lower = b2Abs(m_localAABB.lowerBound);
+		b2Vec2 upper = b2Abs(m_localAABB.upperBound);
+		m_radius = b2Max(lower, upper).Length();
+		m_dirty = false;
+	}
+
+	b2AABB aabb1 = b2TransformAABB(transform1, m_localAABB);
+	b2AABB aabb2 = b2TransformAABB(transform2, m_localAABB);
+	m_proxy.aabb.Combine(aabb1, aabb2);
+
+	if (m_proxy.proxyId == b2BroadPhase::e_nullProxy)
+	{
+		m_proxy.proxyId = broadPhase->CreateProxy(m_proxy.aabb, &m_proxy);
+		m_transform1 = transform1;
+		m_transform2 = transform2;
+		return;
+	}
+
+	b2Vec2 displacement = aabb2.GetCenter() - aabb1.GetCenter();
+	broadPhase->MoveProxy(m_proxy.proxyId, m_proxy.aabb, displacement);
+
+	// The fixtures keep the bounds they were paired with while every point of the body
+	// stays within the tree margin of where it was. Past that they must pair up again.
+	b2Vec2 dp = transform2.p - m_transform2.p;
+	b2Vec2 dq(transform2.q.c - m_transform2.q.c, transform2.q.s - m_transform2.q.s);
+	float motion = dp.Length() + dq.Length() * m_radius;
+	if (touch || motion > b2_aabbExtension)
+	{
+		m_transform1 = transform1;
+		m_transform2 = transform2;
+		broadPhase->TouchProxy(m_proxy.proxyId);
+	}
+}
+
+b2AABB b2Compound::GetFatAABB(int32 proxyId) const
+{
+	const b2AABB& aabb = m_tree.GetFatAABB(proxyId);
+	b2AABB result;
+	result.Combine(b2TransformAABB(m_transform1, aabb), b2TransformAABB(m_transform2, aabb));
+	return result;
+}
+
+b2AABB b2Compound::GetLocalAABB(const b2AABB& aabb) const
+{
+	b2AABB result;
+	result.Combine(b2InvTransformAABB(m_transform1, aabb), b2InvTransformAABB(m_transform2, aabb));
+	return result;
+}
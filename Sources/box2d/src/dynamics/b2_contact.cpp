@@ -20,12 +20,20 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "b2_capsule_circle_contact.h"
+#include "b2_capsule_contact.h"
+#include "b2_chain_capsule_contact.h"
 #include "b2_chain_circle_contact.h"
 #include "b2_chain_polygon_contact.h"
 #include "b2_circle_contact.h"
 #include "b2_contact_solver.h"
+#include "b2_edge_capsule_contact.h"
 #include "b2_edge_circle_contact.h"
 #include "b2_edge_polygon_contact.h"
+#include "b2_height_field_capsule_contact.h"
+#include "b2_height_field_circle_contact.h"
+#include "b2_height_field_polygon_contact.h"
+#include "b2_polygon_capsule_contact.h"
 #include "b2_polygon_circle_contact.h"
 #include "b2_polygon_contact.h"
 
@@ -33,6 +41,8 @@
 #include "box2d/b2_block_allocator.h"
 #include "box2d/b2_body.h"
 #include "box2d/b2_collision.h"
+#include "box2d/b2_contact_manager.h"
+#include "box2d/b2_distance.h"
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_shape.h"
 #include "box2d/b2_time_of_impact.h"
@@ -41,31 +51,71 @@
 b2ContactRegister b2Contact::s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 bool b2Contact::s_initialized = false;
 
+template <typename T>
+void b2Contact::UpdateManifolds(b2Contact** contacts, int32 count, b2ContactManager* manager)
+{
+	B2_NOT_USED(manager);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		T* c = static_cast<T*>(contacts[i]);
+		c->T::Evaluate(&c->m_manifold, c->m_fixtureA->GetBody()->GetTransform(), c->m_fixtureB->GetBody()->GetTransform());
+	}
+}
+
+// Polygon contacts keep narrow phase state.
+template <>
+void b2Contact::UpdateManifolds<b2PolygonContact>(b2Contact** contacts, int32 count, b2ContactManager* manager)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2PolygonContact* c = static_cast<b2PolygonContact*>(contacts[i]);
+		c->b2PolygonContact::UpdateManifold(manager, c->m_fixtureA->GetBody()->GetTransform(), c->m_fixtureB->GetBody()->GetTransform());
+	}
+}
+
 void b2Contact::InitializeRegisters()
 {
-	AddType(b2CircleContact::Create, b2CircleContact::Destroy, b2Shape::e_circle, b2Shape::e_circle);
-	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, b2Shape::e_polygon, b2Shape::e_circle);
-	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, b2Shape::e_polygon, b2Shape::e_polygon);
-	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, b2Shape::e_edge, b2Shape::e_circle);
-	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
-	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
-	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CircleContact::Create, b2CircleContact::Destroy, UpdateManifolds<b2CircleContact>, b2Shape::e_circle, b2Shape::e_circle);
+	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, UpdateManifolds<b2PolygonAndCircleContact>, b2Shape::e_polygon, b2Shape::e_circle);
+	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, UpdateManifolds<b2PolygonContact>, b2Shape::e_polygon, b2Shape::e_polygon);
+	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, UpdateManifolds<b2EdgeAndCircleContact>, b2Shape::e_edge, b2Shape::e_circle);
+	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, UpdateManifolds<b2EdgeAndPolygonContact>, b2Shape::e_edge, b2Shape::e_polygon);
+	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, UpdateManifolds<b2ChainAndCircleContact>, b2Shape::e_chain, b2Shape::e_circle);
+	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, UpdateManifolds<b2ChainAndPolygonContact>, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CapsuleAndCircleContact::Create, b2CapsuleAndCircleContact::Destroy, UpdateManifolds<b2CapsuleAndCircleContact>, b2Shape::e_capsule, b2Shape::e_circle);
+	AddType(b2CapsuleContact::Create, b2CapsuleContact::Destroy, UpdateManifolds<b2CapsuleContact>, b2Shape::e_capsule, b2Shape::e_capsule);
+	AddType(b2PolygonAndCapsuleContact::Create, b2PolygonAndCapsuleContact::Destroy, UpdateManifolds<b2PolygonAndCapsuleContact>, b2Shape::e_polygon, b2Shape::e_capsule);
+	AddType(b2EdgeAndCapsuleContact::Create, b2EdgeAndCapsuleContact::Destroy, UpdateManifolds<b2EdgeAndCapsuleContact>, b2Shape::e_edge, b2Shape::e_capsule);
+	AddType(b2ChainAndCapsuleContact::Create, b2ChainAndCapsuleContact::Destroy, UpdateManifolds<b2ChainAndCapsuleContact>, b2Shape::e_chain, b2Shape::e_capsule);
+
+	// Mesh contacts are chain contacts on one segment, see b2ContactManager::AddPair.
+	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, UpdateManifolds<b2ChainAndCircleContact>, b2Shape::e_mesh, b2Shape::e_circle);
+	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, UpdateManifolds<b2ChainAndPolygonContact>, b2Shape::e_mesh, b2Shape::e_polygon);
+	AddType(b2ChainAndCapsuleContact::Create, b2ChainAndCapsuleContact::Destroy, UpdateManifolds<b2ChainAndCapsuleContact>, b2Shape::e_mesh, b2Shape::e_capsule);
+
+	// Height field contacts are on one cell.
+	AddType(b2HeightFieldAndCircleContact::Create, b2HeightFieldAndCircleContact::Destroy, UpdateManifolds<b2HeightFieldAndCircleContact>, b2Shape::e_heightField, b2Shape::e_circle);
+	AddType(b2HeightFieldAndPolygonContact::Create, b2HeightFieldAndPolygonContact::Destroy, UpdateManifolds<b2HeightFieldAndPolygonContact>, b2Shape::e_heightField, b2Shape::e_polygon);
+	AddType(b2HeightFieldAndCapsuleContact::Create, b2HeightFieldAndCapsuleContact::Destroy, UpdateManifolds<b2HeightFieldAndCapsuleContact>, b2Shape::e_heightField, b2Shape::e_capsule);
 }
 
 void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
-						b2Shape::Type type1, b2Shape::Type type2)
+						b2ContactManifoldFcn* manifoldFcn, b2Shape::Type type1, b2Shape::Type type2)
 {
 	b2Assert(0 <= type1 && type1 < b2Shape::e_typeCount);
 	b2Assert(0 <= type2 && type2 < b2Shape::e_typeCount);
 	
 	s_registers[type1][type2].createFcn = createFcn;
 	s_registers[type1][type2].destroyFcn = destoryFcn;
+	s_registers[type1][type2].manifoldFcn = manifoldFcn;
 	s_registers[type1][type2].primary = true;
 
 	if (type1 != type2)
 	{
 		s_registers[type2][type1].createFcn = createFcn;
 		s_registers[type2][type1].destroyFcn = destoryFcn;
+		s_registers[type2][type1].manifoldFcn = manifoldFcn;
 		s_registers[type2][type1].primary = false;
 	}
 }
@@ -109,9 +159,7 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 	b2Fixture* fixtureA = contact->m_fixtureA;
 	b2Fixture* fixtureB = contact->m_fixtureB;
 
-	if (contact->m_manifold.pointCount > 0 &&
-		fixtureA->IsSensor() == false &&
-		fixtureB->IsSensor() == false)
+	if (contact->m_manifold.pointCount > 0)
 	{
 		fixtureA->GetBody()->SetAwake(true);
 		fixtureB->GetBody()->SetAwake(true);
@@ -130,6 +178,10 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 {
 	m_flags = e_enabledFlag;
+	if (fA->m_enableHitEvents || fB->m_enableHitEvents)
+	{
+		m_flags |= e_hitEventFlag;
+	}
 
 	m_fixtureA = fA;
 	m_fixtureB = fB;
@@ -161,69 +213,85 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_tangentSpeed = 0.0f;
 }
 
+void b2Contact::UpdateManifold(b2ContactManager* manager, const b2Transform& xfA, const b2Transform& xfB)
+{
+	B2_NOT_USED(manager);
+	Evaluate(&m_manifold, xfA, xfB);
+}
+
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+void b2Contact::Update(b2ContactManager* manager)
 {
 	b2Manifold oldManifold = m_manifold;
 
+	BeginUpdate();
+
+	// Sensors never get here, see b2SensorManager.
+	UpdateManifold(manager, m_fixtureA->GetBody()->GetTransform(), m_fixtureB->GetBody()->GetTransform());
+
+	FinishUpdate(manager, oldManifold);
+}
+
+void b2Contact::BeginUpdate()
+{
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
+	m_flags &= ~(e_speculativePointFlag | e_cachedAxisFlag | e_reusedManifoldFlag);
+}
 
-	bool touching = false;
-	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+void b2Contact::FinishUpdate(b2ContactManager* manager, const b2Manifold& oldManifold)
+{
+	b2ContactListener* listener = manager->m_contactListener;
 
-	bool sensorA = m_fixtureA->IsSensor();
-	bool sensorB = m_fixtureB->IsSensor();
-	bool sensor = sensorA || sensorB;
+	// The narrow phase leaves the touching flag alone.
+	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+	bool touching = m_manifold.pointCount > 0;
 
 	b2Body* bodyA = m_fixtureA->GetBody();
 	b2Body* bodyB = m_fixtureB->GetBody();
-	const b2Transform& xfA = bodyA->GetTransform();
-	const b2Transform& xfB = bodyB->GetTransform();
 
-	// Is this contact a sensor?
-	if (sensor)
+	if (m_flags & e_cachedAxisFlag)
 	{
-		const b2Shape* shapeA = m_fixtureA->GetShape();
-		const b2Shape* shapeB = m_fixtureB->GetShape();
-		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+		++manager->m_separatingAxisHits;
+	}
 
-		// Sensors don't generate manifolds.
-		m_manifold.pointCount = 0;
+	if (m_flags & e_reusedManifoldFlag)
+	{
+		++manager->m_manifoldReuses;
 	}
-	else
+
+	// Match old contact ids to new contact ids and copy the
+	// stored impulses to warm start the solver.
+	for (int32 i = 0; i < m_manifold.pointCount; ++i)
 	{
-		Evaluate(&m_manifold, xfA, xfB);
-		touching = m_manifold.pointCount > 0;
+		b2ManifoldPoint* mp2 = m_manifold.points + i;
+		mp2->normalImpulse = 0.0f;
+		mp2->tangentImpulse = 0.0f;
+		b2ContactID id2 = mp2->id;
 
-		// Match old contact ids to new contact ids and copy the
-		// stored impulses to warm start the solver.
-		for (int32 i = 0; i < m_manifold.pointCount; ++i)
+		for (int32 j = 0; j < oldManifold.pointCount; ++j)
 		{
-			b2ManifoldPoint* mp2 = m_manifold.points + i;
-			mp2->normalImpulse = 0.0f;
-			mp2->tangentImpulse = 0.0f;
-			b2ContactID id2 = mp2->id;
+			const b2ManifoldPoint* mp1 = oldManifold.points + j;
 
-			for (int32 j = 0; j < oldManifold.pointCount; ++j)
+			if (mp1->id.key == id2.key)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
-
-				if (mp1->id.key == id2.key)
-				{
-					mp2->normalImpulse = mp1->normalImpulse;
-					mp2->tangentImpulse = mp1->tangentImpulse;
-					break;
-				}
+				mp2->normalImpulse = mp1->normalImpulse;
+				mp2->tangentImpulse = mp1->tangentImpulse;
+				break;
 			}
 		}
+	}
 
-		if (touching != wasTouching)
-		{
-			bodyA->SetAwake(true);
-			bodyB->SetAwake(true);
-		}
+	if (touching == false && (m_flags & e_speculativeFlag))
+	{
+		AddSpeculativePoint(manager->m_dt);
+	}
+
+	if (touching != wasTouching)
+	{
+		bodyA->SetAwake(true);
+		bodyB->SetAwake(true);
 	}
 
 	if (touching)
@@ -235,18 +303,91 @@ void b2Contact::Update(b2ContactListener* listener)
 		m_flags &= ~e_touchingFlag;
 	}
 
-	if (wasTouching == false && touching == true && listener)
+	if (wasTouching == false && touching == true)
 	{
-		listener->BeginContact(this);
+		manager->BeginContact(this);
 	}
 
-	if (wasTouching == true && touching == false && listener)
+	if (wasTouching == true && touching == false)
 	{
-		listener->EndContact(this);
+		manager->EndContact(this);
 	}
 
-	if (sensor == false && touching && listener)
+	// Speculative points go to PreSolve so they can be disabled like real contacts,
+	// for example by one-sided platforms.
+	bool speculativePoint = (m_flags & e_speculativePointFlag) == e_speculativePointFlag;
+	if ((touching || speculativePoint) && listener)
 	{
 		listener->PreSolve(this, &oldManifold);
 	}
 }
+
+// Add a single speculative point at the closest features of two shapes that are not
+// touching. The solver lets the shapes approach until the gap is closed, so fast shapes
+// cannot pass through each other. The point is only added if the shapes can close the
+// gap within the time step.
+void b2Contact::AddSpeculativePoint(float dt)
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+	const b2Transform& xfA = bodyA->GetTransform();
+	const b2Transform& xfB = bodyB->GetTransform();
+
+	b2DistanceInput input;
+	input.proxyA.Set(m_fixtureA->GetShape(), m_indexA);
+	input.proxyB.Set(m_fixtureB->GetShape(), m_indexB);
+	input.transformA = xfA;
+	input.transformB = xfB;
+	input.useRadii = false;
+
+	b2SimplexCache cache;
+	cache.count = 0;
+
+	b2DistanceOutput output;
+	b2Distance(&output, &cache, &input);
+
+	if (output.distance < 10.0f * b2_epsilon)
+	{
+		// The cores overlap, there is no well defined normal.
+		return;
+	}
+
+	b2Vec2 normal = (1.0f / output.distance) * (output.pointB - output.pointA);
+	float separation = output.distance - input.proxyA.m_radius - input.proxyB.m_radius;
+
+	// Relative normal velocity of the closest points.
+	b2Vec2 vA = bodyA->m_linearVelocity + b2Cross(bodyA->m_angularVelocity, output.pointA - bodyA->m_sweep.c);
+	b2Vec2 vB = bodyB->m_linearVelocity + b2Cross(bodyB->m_angularVelocity, output.pointB - bodyB->m_sweep.c);
+	float approachSpeed = -b2Dot(vB - vA, normal);
+
+	if (separation > b2_speculativeDistance + b2Max(approachSpeed, 0.0f) * dt)
+	{
+		return;
+	}
+
+	m_manifold.type = b2Manifold::e_circles;
+	m_manifold.localNormal.SetZero();
+	m_manifold.localPoint = b2MulT(xfA, output.pointA);
+	m_manifold.pointCount = 1;
+
+	b2ManifoldPoint* mp = m_manifold.points + 0;
+	mp->localPoint = b2MulT(xfB, output.pointB);
+	mp->normalImpulse = 0.0f;
+	mp->tangentImpulse = 0.0f;
+	mp->id.key = 0;
+
+	m_flags |= e_speculativePointFlag;
+}
+
+void b2Contact::UpdateSpeculativeFlag(bool speculativeContacts)
+{
+	bool speculative = speculativeContacts || m_fixtureA->GetBody()->IsSpeculative() || m_fixtureB->GetBody()->IsSpeculative();
+	if (speculative)
+	{
+		m_flags |= e_speculativeFlag;
+	}
+	else
+	{
+		m_flags &= ~(e_speculativeFlag | e_speculativePointFlag);
+	}
+}
@@ -21,21 +21,59 @@
 // SOFTWARE.
 
 #include "box2d/b2_body.h"
+#include "box2d/b2_compound.h"
 #include "box2d/b2_contact.h"
 #include "box2d/b2_contact_manager.h"
 #include "box2d/b2_fixture.h"
+#include "box2d/b2_height_field_shape.h"
+#include "box2d/b2_mesh_shape.h"
+#include "box2d/b2_task.h"
 #include "box2d/b2_world_callbacks.h"
 
+#include <string.h>
+
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
+// Bound a world AABB in the frame of a transform.
+static b2AABB b2ComputeLocalAABB(const b2Transform& xf, const b2AABB& aabb)
+{
+	b2Vec2 center = b2MulT(xf, aabb.GetCenter());
+	b2Vec2 h = aabb.GetExtents();
+	float c = b2Abs(xf.q.c);
+	float s = b2Abs(xf.q.s);
+	b2Vec2 extents(c * h.x + s * h.y, s * h.x + c * h.y);
+
+	b2AABB localAABB;
+	localAABB.lowerBound = center - extents;
+	localAABB.upperBound = center + extents;
+	return localAABB;
+}
+
 b2ContactManager::b2ContactManager()
 {
 	m_contactList = nullptr;
 	m_contactCount = 0;
+	m_nextToiOrder = 0;
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
+	m_taskExecutor = nullptr;
 	m_allocator = nullptr;
+	m_sensorManager.m_contactManager = this;
+	m_speculativeContacts = false;
+	m_dt = 0.0f;
+	m_contactEvents = false;
+	m_reportedBeginCount = 0;
+	m_reportedEndCount = 0;
+	m_reportedSensorBeginCount = 0;
+	m_reportedSensorEndCount = 0;
+	m_reportedHitCount = 0;
+	m_hitEventThreshold = 1.0f * b2_lengthUnitsPerMeter;
+	m_reuseLinearTolerance = 0.0f;
+	m_reuseAngularTolerance = 0.0f;
+	m_separatingAxisHits = 0;
+	m_manifoldReuses = 0;
+	m_batchedNarrowPhase = false;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -45,9 +83,9 @@ void b2ContactManager::Destroy(b2Contact* c)
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
-	if (m_contactListener && c->IsTouching())
+	if (c->IsTouching())
 	{
-		m_contactListener->EndContact(c);
+		EndContact(c);
 	}
 
 	// Remove from the world.
@@ -108,6 +146,9 @@ void b2ContactManager::Destroy(b2Contact* c)
 // contact list.
 void b2ContactManager::Collide()
 {
+	m_separatingAxisHits = 0;
+	m_manifoldReuses = 0;
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
@@ -154,9 +195,38 @@ void b2ContactManager::Collide()
 			continue;
 		}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		bool overlap;
+		if (fixtureA->GetType() == b2Shape::e_mesh)
+		{
+			// Child index A is the mesh segment.
+			b2AABB segmentAABB;
+			((b2MeshShape*)fixtureA->GetShape())->ComputeSegmentAABB(&segmentAABB, bodyA->GetTransform(), indexA);
+			overlap = b2TestOverlap(segmentAABB, GetFatAABB(fixtureB->m_proxies + indexB));
+		}
+		else if (fixtureA->GetType() == b2Shape::e_heightField)
+		{
+			// Child index A is the cell. The cell is kept while it is under the fat AABB
+			// so that changing the heights does not lose contacts.
+			b2AABB aabbB = GetFatAABB(fixtureB->m_proxies + indexB);
+			overlap = b2TestOverlap(GetFatAABB(fixtureA->m_proxies), aabbB);
+			if (overlap)
+			{
+				b2AABB localAABB = b2ComputeLocalAABB(bodyA->GetTransform(), aabbB);
+				int32 lowerCell, upperCell;
+				overlap = ((b2HeightFieldShape*)fixtureA->GetShape())->GetCellRange(localAABB.lowerBound.x, localAABB.upperBound.x, &lowerCell, &upperCell);
+				overlap = overlap && lowerCell <= indexA && indexA <= upperCell;
+			}
+		}
+		else if (bodyA->m_compound || bodyB->m_compound)
+		{
+			overlap = b2TestOverlap(GetFatAABB(fixtureA->m_proxies + indexA), GetFatAABB(fixtureB->m_proxies + indexB));
+		}
+		else
+		{
+			int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+			int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+			overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		}
 
 		// Here we destroy contacts that cease to overlap in the broad-phase.
 		if (overlap == false)
@@ -168,9 +238,101 @@ void b2ContactManager::Collide()
 		}
 
 		// The contact persists.
-		c->Update(m_contactListener);
+		if (m_batchedNarrowPhase)
+		{
+			m_updateContacts.Push(c);
+		}
+		else
+		{
+			c->Update(this);
+		}
+
 		c = c->GetNext();
 	}
+
+	if (m_batchedNarrowPhase)
+	{
+		UpdateContacts();
+	}
+}
+
+struct b2ManifoldBatch
+{
+	b2ContactManifoldFcn* manifoldFcn;
+	b2Contact** contacts;
+	b2ContactManager* manager;
+};
+
+static void b2UpdateManifoldsTask(int32 startIndex, int32 endIndex, void* context)
+{
+	b2ManifoldBatch* batch = (b2ManifoldBatch*)context;
+	batch->manifoldFcn(batch->contacts + startIndex, endIndex - startIndex, batch->manager);
+}
+
+void b2ContactManager::UpdateContacts()
+{
+	const int32 pairCount = b2Shape::e_typeCount * b2Shape::e_typeCount;
+	int32 offsets[pairCount + 1] = { 0 };
+
+	int32 count = m_updateContacts.GetCount();
+	b2Contact** contacts = m_updateContacts.GetData();
+
+	// Contacts hold their fixtures in the order of their contact type.
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = contacts[i];
+		int32 pair = c->m_fixtureA->GetType() * b2Shape::e_typeCount + c->m_fixtureB->GetType();
+		++offsets[pair + 1];
+	}
+
+	for (int32 i = 0; i < pairCount; ++i)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+
+	m_batchContacts.Resize(count);
+	m_oldManifolds.Resize(count);
+	b2Contact** batchContacts = m_batchContacts.GetData();
+	b2Manifold* oldManifolds = m_oldManifolds.GetData();
+
+	int32 next[pairCount];
+	memcpy(next, offsets, sizeof(next));
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = contacts[i];
+		oldManifolds[i] = c->m_manifold;
+		c->BeginUpdate();
+
+		int32 pair = c->m_fixtureA->GetType() * b2Shape::e_typeCount + c->m_fixtureB->GetType();
+		batchContacts[next[pair]++] = c;
+	}
+
+	// Each shape pair runs in its own loop without virtual calls. The narrow phase
+	// only writes the manifold of each contact, so the loops can be split over threads.
+	for (int32 pair = 0; pair < pairCount; ++pair)
+	{
+		int32 pairStart = offsets[pair];
+		int32 pairEnd = offsets[pair + 1];
+		if (pairStart == pairEnd)
+		{
+			continue;
+		}
+
+		b2ManifoldBatch batch;
+		batch.manifoldFcn = b2Contact::s_registers[pair / b2Shape::e_typeCount][pair % b2Shape::e_typeCount].manifoldFcn;
+		batch.contacts = batchContacts + pairStart;
+		batch.manager = this;
+		b2ParallelFor(m_taskExecutor, b2UpdateManifoldsTask, pairEnd - pairStart, 64, &batch);
+	}
+
+	// Warm starting and events follow the contact list, like Update.
+	for (int32 i = 0; i < count; ++i)
+	{
+		contacts[i]->FinishUpdate(this, oldManifolds[i]);
+	}
+
+	m_updateContacts.Clear();
 }
 
 void b2ContactManager::FindNewContacts()
@@ -183,12 +345,61 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	b2FixtureProxy* proxyA = (b2FixtureProxy*)proxyUserDataA;
 	b2FixtureProxy* proxyB = (b2FixtureProxy*)proxyUserDataB;
 
+	// A compound body has a single proxy, its fixtures pair up here.
+	if (proxyA->fixture == nullptr)
+	{
+		AddCompoundPairs((b2Compound*)proxyA, proxyB);
+		return;
+	}
+
+	if (proxyB->fixture == nullptr)
+	{
+		AddCompoundPairs((b2Compound*)proxyB, proxyA);
+		return;
+	}
+
+	AddPair(proxyA, proxyB);
+}
+
+void b2ContactManager::AddPair(const b2FixtureProxy* proxyA, const b2FixtureProxy* proxyB)
+{
 	b2Fixture* fixtureA = proxyA->fixture;
 	b2Fixture* fixtureB = proxyB->fixture;
 
 	int32 indexA = proxyA->childIndex;
 	int32 indexB = proxyB->childIndex;
 
+	// A mesh has a single proxy, its segments pair up here.
+	if (fixtureA->GetType() == b2Shape::e_mesh)
+	{
+		AddMeshPairs(fixtureA, proxyB);
+		return;
+	}
+
+	if (fixtureB->GetType() == b2Shape::e_mesh)
+	{
+		AddMeshPairs(fixtureB, proxyA);
+		return;
+	}
+
+	// A height field has a single proxy, its cells pair up here.
+	if (fixtureA->GetType() == b2Shape::e_heightField)
+	{
+		AddHeightFieldPairs(fixtureA, proxyB);
+		return;
+	}
+
+	if (fixtureB->GetType() == b2Shape::e_heightField)
+	{
+		AddHeightFieldPairs(fixtureB, proxyA);
+		return;
+	}
+
+	AddPair(fixtureA, indexA, fixtureB, indexB);
+}
+
+void b2ContactManager::AddPair(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+{
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
@@ -246,13 +457,177 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
+	c->UpdateSpeculativeFlag(m_speculativeContacts);
+	InsertContact(c);
+}
+
+struct b2MeshPairCallback
+{
+	bool QueryCallback(int32 segment)
+	{
+		// The same test as the one that keeps the contact in Collide.
+		b2AABB segmentAABB;
+		mesh->ComputeSegmentAABB(&segmentAABB, transform, segment);
+		if (b2TestOverlap(segmentAABB, aabb))
+		{
+			manager->AddPair(meshFixture, segment, fixture, childIndex);
+		}
+
+		return true;
+	}
+
+	b2ContactManager* manager;
+	b2Fixture* meshFixture;
+	const b2MeshShape* mesh;
+	b2Transform transform;
+	b2Fixture* fixture;
+	int32 childIndex;
+	b2AABB aabb;
+};
+
+void b2ContactManager::AddMeshPairs(b2Fixture* mesh, const b2FixtureProxy* proxy)
+{
+	b2Fixture* fixture = proxy->fixture;
+	b2Body* meshBody = mesh->GetBody();
+	b2Body* body = fixture->GetBody();
+
+	// Skip the segment query when no contact can be created.
+	if (meshBody == body || body->ShouldCollide(meshBody) == false)
+	{
+		return;
+	}
+
+	if (b2Contact::s_registers[b2Shape::e_mesh][fixture->GetType()].createFcn == nullptr)
+	{
+		return;
+	}
+
+	b2MeshPairCallback callback;
+	callback.manager = this;
+	callback.meshFixture = mesh;
+	callback.mesh = (b2MeshShape*)mesh->GetShape();
+	callback.transform = meshBody->GetTransform();
+	callback.fixture = fixture;
+	callback.childIndex = proxy->childIndex;
+	callback.aabb = GetFatAABB(proxy);
+
+	// Bound the fat AABB in the mesh frame.
+	b2AABB localAABB = b2ComputeLocalAABB(callback.transform, callback.aabb);
+	callback.mesh->Query(&callback, localAABB);
+}
+
+void b2ContactManager::AddHeightFieldPairs(b2Fixture* heightField, const b2FixtureProxy* proxy)
+{
+	b2Fixture* fixture = proxy->fixture;
+	b2Body* heightFieldBody = heightField->GetBody();
+	b2Body* body = fixture->GetBody();
+
+	// Skip the cells when no contact can be created.
+	if (heightFieldBody == body || body->ShouldCollide(heightFieldBody) == false)
+	{
+		return;
+	}
+
+	if (b2Contact::s_registers[b2Shape::e_heightField][fixture->GetType()].createFcn == nullptr)
+	{
+		return;
+	}
+
+	// The cells are found from the x range alone, the same test that keeps the contact
+	// in Collide.
+	b2AABB localAABB = b2ComputeLocalAABB(heightFieldBody->GetTransform(), GetFatAABB(proxy));
+	int32 lowerCell, upperCell;
+	b2HeightFieldShape* shape = (b2HeightFieldShape*)heightField->GetShape();
+	if (shape->GetCellRange(localAABB.lowerBound.x, localAABB.upperBound.x, &lowerCell, &upperCell) == false)
+	{
+		return;
+	}
+
+	for (int32 cell = lowerCell; cell <= upperCell; ++cell)
+	{
+		AddPair(heightField, cell, fixture, proxy->childIndex);
+	}
+}
+
+struct b2CompoundPairCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		// The same test as the one that keeps the contact in Collide.
+		if (b2TestOverlap(compound->GetFatAABB(proxyId), aabb))
+		{
+			b2FixtureProxy* fixtureProxy = (b2FixtureProxy*)compound->m_tree.GetUserData(proxyId);
+			manager->AddPair(fixtureProxy, proxy);
+		}
+
+		return true;
+	}
+
+	b2ContactManager* manager;
+	const b2Compound* compound;
+	const b2FixtureProxy* proxy;
+	b2AABB aabb;
+};
+
+struct b2CompoundPairsCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* fixtureProxy = (b2FixtureProxy*)compound->m_tree.GetUserData(proxyId);
+		manager->AddCompoundPairs(other, fixtureProxy);
+		return true;
+	}
+
+	b2ContactManager* manager;
+	const b2Compound* compound;
+	const b2Compound* other;
+};
+
+void b2ContactManager::AddCompoundPairs(const b2Compound* compound, const b2FixtureProxy* proxy)
+{
+	b2Body* body = proxy->fixture ? proxy->fixture->GetBody() : ((const b2Compound*)proxy)->m_body;
+
+	// Skip the fixture query when no contact can be created.
+	if (compound->m_body == body || body->ShouldCollide(compound->m_body) == false)
+	{
+		return;
+	}
+
+	if (proxy->fixture == nullptr)
+	{
+		// Pair each fixture of one compound body with the other body.
+		b2CompoundPairsCallback callback;
+		callback.manager = this;
+		callback.compound = compound;
+		callback.other = (const b2Compound*)proxy;
+		compound->Query(&callback, m_broadPhase.GetFatAABB(proxy->proxyId));
+		return;
+	}
+
+	b2CompoundPairCallback callback;
+	callback.manager = this;
+	callback.compound = compound;
+	callback.proxy = proxy;
+	callback.aabb = GetFatAABB(proxy);
+	compound->Query(&callback, callback.aabb);
+}
+
+b2AABB b2ContactManager::GetFatAABB(const b2FixtureProxy* proxy) const
+{
+	const b2Compound* compound = proxy->fixture->m_body->m_compound;
+	if (compound)
+	{
+		return compound->GetFatAABB(proxy->proxyId);
+	}
+
+	return m_broadPhase.GetFatAABB(proxy->proxyId);
+}
+
+void b2ContactManager::InsertContact(b2Contact* c)
+{
 	// Contact creation may swap fixtures.
-	fixtureA = c->GetFixtureA();
-	fixtureB = c->GetFixtureB();
-	indexA = c->GetChildIndexA();
-	indexB = c->GetChildIndexB();
-	bodyA = fixtureA->GetBody();
-	bodyB = fixtureB->GetBody();
+	b2Body* bodyA = c->GetFixtureA()->GetBody();
+	b2Body* bodyB = c->GetFixtureB()->GetBody();
 
 	// Insert into the world.
 	c->m_prev = nullptr;
@@ -262,6 +637,7 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		m_contactList->m_prev = c;
 	}
 	m_contactList = c;
+	c->m_toiOrder = m_nextToiOrder++;
 
 	// Connect to island graph.
 
@@ -291,3 +667,159 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 
 	++m_contactCount;
 }
+
+void b2ContactManager::BeginContact(b2Contact* c)
+{
+	if (m_contactListener)
+	{
+		m_contactListener->BeginContact(c);
+	}
+
+	if (m_contactEvents == false)
+	{
+		return;
+	}
+
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	b2WorldManifold worldManifold;
+	c->GetWorldManifold(&worldManifold);
+
+	int32 pointCount = c->GetManifold()->pointCount;
+	b2Vec2 point = worldManifold.points[0];
+	if (pointCount == 2)
+	{
+		point = 0.5f * (worldManifold.points[0] + worldManifold.points[1]);
+	}
+
+	b2Vec2 vA = bodyA->m_linearVelocity + b2Cross(bodyA->m_angularVelocity, point - bodyA->m_sweep.c);
+	b2Vec2 vB = bodyB->m_linearVelocity + b2Cross(bodyB->m_angularVelocity, point - bodyB->m_sweep.c);
+
+	b2ContactBeginTouchEvent& event = m_beginEvents.Append();
+	event.fixtureA = fixtureA;
+	event.fixtureB = fixtureB;
+	event.userDataA = fixtureA->GetUserData();
+	event.userDataB = fixtureB->GetUserData();
+	event.childIndexA = c->GetChildIndexA();
+	event.childIndexB = c->GetChildIndexB();
+	event.point = point;
+	event.normal = worldManifold.normal;
+	event.approachSpeed = -b2Dot(vB - vA, worldManifold.normal);
+}
+
+void b2ContactManager::EndContact(b2Contact* c)
+{
+	if (m_contactListener)
+	{
+		m_contactListener->EndContact(c);
+	}
+
+	if (m_contactEvents == false)
+	{
+		return;
+	}
+
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+
+	b2ContactEndTouchEvent& event = m_endEvents.Append();
+	event.fixtureA = fixtureA;
+	event.fixtureB = fixtureB;
+	event.userDataA = fixtureA->GetUserData();
+	event.userDataB = fixtureB->GetUserData();
+	event.childIndexA = c->GetChildIndexA();
+	event.childIndexB = c->GetChildIndexB();
+}
+
+void b2ContactManager::BeginSensorOverlap(b2Fixture* sensor, b2Fixture* visitor)
+{
+	if (m_contactListener)
+	{
+		m_contactListener->BeginSensorOverlap(sensor, visitor);
+	}
+
+	if (m_contactEvents)
+	{
+		b2SensorTouchEvent& event = m_sensorBeginEvents.Append();
+		event.sensor = sensor;
+		event.visitor = visitor;
+		event.sensorUserData = sensor->GetUserData();
+		event.visitorUserData = visitor->GetUserData();
+	}
+}
+
+void b2ContactManager::EndSensorOverlap(b2Fixture* sensor, b2Fixture* visitor)
+{
+	if (m_contactListener)
+	{
+		m_contactListener->EndSensorOverlap(sensor, visitor);
+	}
+
+	if (m_contactEvents)
+	{
+		b2SensorTouchEvent& event = m_sensorEndEvents.Append();
+		event.sensor = sensor;
+		event.visitor = visitor;
+		event.sensorUserData = sensor->GetUserData();
+		event.visitorUserData = visitor->GetUserData();
+	}
+}
+
+void b2ContactManager::HitContact(b2Contact* c, const b2ContactHitEvent* event)
+{
+	if (m_contactListener)
+	{
+		m_contactListener->ContactHit(c, event);
+	}
+
+	if (m_contactEvents)
+	{
+		m_hitEvents.Push(*event);
+	}
+}
+
+void b2ContactManager::DiscardReportedEvents()
+{
+	m_beginEvents.RemoveFront(m_reportedBeginCount);
+	m_endEvents.RemoveFront(m_reportedEndCount);
+	m_sensorBeginEvents.RemoveFront(m_reportedSensorBeginCount);
+	m_sensorEndEvents.RemoveFront(m_reportedSensorEndCount);
+	m_hitEvents.RemoveFront(m_reportedHitCount);
+	m_reportedBeginCount = 0;
+	m_reportedEndCount = 0;
+	m_reportedSensorBeginCount = 0;
+	m_reportedSensorEndCount = 0;
+	m_reportedHitCount = 0;
+}
+
+void b2ContactManager::MarkEventsReported()
+{
+	m_reportedBeginCount = m_beginEvents.GetCount();
+	m_reportedEndCount = m_endEvents.GetCount();
+	m_reportedSensorBeginCount = m_sensorBeginEvents.GetCount();
+	m_reportedSensorEndCount = m_sensorEndEvents.GetCount();
+	m_reportedHitCount = m_hitEvents.GetCount();
+}
+
+void b2ContactManager::ClearEvents()
+{
+	m_beginEvents.Clear();
+	m_endEvents.Clear();
+	m_sensorBeginEvents.Clear();
+	m_sensorEndEvents.Clear();
+	m_hitEvents.Clear();
+	m_reportedBeginCount = 0;
+	m_reportedEndCount = 0;
+	m_reportedSensorBeginCount = 0;
+	m_reportedSensorEndCount = 0;
+	m_reportedHitCount = 0;
+}
+
+void b2ContactManager::ProxyMoved(void* proxyUserData, int32 proxyId)
+{
+	b2FixtureProxy* proxy = (b2FixtureProxy*)proxyUserData;
+	proxy->proxyId = proxyId;
+}
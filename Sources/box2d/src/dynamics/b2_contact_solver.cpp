@@ -152,7 +152,9 @@ void b2ContactSolver::InitializeVelocityConstraints()
 
 		float radiusA = pc->radiusA;
 		float radiusB = pc->radiusB;
-		b2Manifold* manifold = m_contacts[vc->contactIndex]->GetManifold();
+		b2Contact* contact = m_contacts[vc->contactIndex];
+		b2Manifold* manifold = contact->GetManifold();
+		bool speculative = (contact->m_flags & b2Contact::e_speculativeFlag) != 0;
 
 		int32 indexA = vc->indexA;
 		int32 indexB = vc->indexB;
@@ -165,20 +167,18 @@ void b2ContactSolver::InitializeVelocityConstraints()
 		b2Vec2 localCenterB = pc->localCenterB;
 
 		b2Vec2 cA = m_positions[indexA].c;
-		float aA = m_positions[indexA].a;
 		b2Vec2 vA = m_velocities[indexA].v;
 		float wA = m_velocities[indexA].w;
 
 		b2Vec2 cB = m_positions[indexB].c;
-		float aB = m_positions[indexB].a;
 		b2Vec2 vB = m_velocities[indexB].v;
 		float wB = m_velocities[indexB].w;
 
 		b2Assert(manifold->pointCount > 0);
 
 		b2Transform xfA, xfB;
-		xfA.q.Set(aA);
-		xfB.q.Set(aB);
+		xfA.q = m_positions[indexA].q;
+		xfB.q = m_positions[indexB].q;
 		xfA.p = cA - b2Mul(xfA.q, localCenterA);
 		xfB.p = cB - b2Mul(xfB.q, localCenterB);
 
@@ -214,7 +214,14 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			// Setup a velocity bias for restitution.
 			vcp->velocityBias = 0.0f;
 			float vRel = b2Dot(vc->normal, vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA));
-			if (vRel < -vc->threshold)
+			vcp->relativeVelocity = vRel;
+
+			// A separated speculative point allows the shapes to approach until they touch.
+			if (speculative && worldManifold.separations[j] > 0.0f)
+			{
+				vcp->velocityBias = -worldManifold.separations[j] * m_step.inv_dt;
+			}
+			else if (vRel < -vc->threshold)
 			{
 				vcp->velocityBias = -vc->restitution * vRel;
 			}
@@ -691,20 +698,17 @@ bool b2ContactSolver::SolvePositionConstraints()
 		float iB = pc->invIB;
 		int32 pointCount = pc->pointCount;
 
-		b2Vec2 cA = m_positions[indexA].c;
-		float aA = m_positions[indexA].a;
-
-		b2Vec2 cB = m_positions[indexB].c;
-		float aB = m_positions[indexB].a;
+		b2Position positionA = m_positions[indexA];
+		b2Position positionB = m_positions[indexB];
 
 		// Solve normal constraints
 		for (int32 j = 0; j < pointCount; ++j)
 		{
 			b2Transform xfA, xfB;
-			xfA.q.Set(aA);
-			xfB.q.Set(aB);
-			xfA.p = cA - b2Mul(xfA.q, localCenterA);
-			xfB.p = cB - b2Mul(xfB.q, localCenterB);
+			xfA.q = positionA.q;
+			xfB.q = positionB.q;
+			xfA.p = positionA.c - b2Mul(xfA.q, localCenterA);
+			xfB.p = positionB.c - b2Mul(xfB.q, localCenterB);
 
 			b2PositionSolverManifold psm;
 			psm.Initialize(pc, xfA, xfB, j);
@@ -713,8 +717,8 @@ bool b2ContactSolver::SolvePositionConstraints()
 			b2Vec2 point = psm.point;
 			float separation = psm.separation;
 
-			b2Vec2 rA = point - cA;
-			b2Vec2 rB = point - cB;
+			b2Vec2 rA = point - positionA.c;
+			b2Vec2 rB = point - positionB.c;
 
 			// Track max constraint error.
 			minSeparation = b2Min(minSeparation, separation);
@@ -732,18 +736,15 @@ bool b2ContactSolver::SolvePositionConstraints()
 
 			b2Vec2 P = impulse * normal;
 
-			cA -= mA * P;
-			aA -= iA * b2Cross(rA, P);
+			positionA.c -= mA * P;
+			positionA.SetAngle(positionA.a - iA * b2Cross(rA, P));
 
-			cB += mB * P;
-			aB += iB * b2Cross(rB, P);
+			positionB.c += mB * P;
+			positionB.SetAngle(positionB.a + iB * b2Cross(rB, P));
 		}
 
-		m_positions[indexA].c = cA;
-		m_positions[indexA].a = aA;
-
-		m_positions[indexB].c = cB;
-		m_positions[indexB].a = aB;
+		m_positions[indexA] = positionA;
+		m_positions[indexB] = positionB;
 	}
 
 	// We can't expect minSpeparation >= -b2_linearSlop because we don't
@@ -782,20 +783,17 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 			iB = pc->invIB;
 		}
 
-		b2Vec2 cA = m_positions[indexA].c;
-		float aA = m_positions[indexA].a;
-
-		b2Vec2 cB = m_positions[indexB].c;
-		float aB = m_positions[indexB].a;
+		b2Position positionA = m_positions[indexA];
+		b2Position positionB = m_positions[indexB];
 
 		// Solve normal constraints
 		for (int32 j = 0; j < pointCount; ++j)
 		{
 			b2Transform xfA, xfB;
-			xfA.q.Set(aA);
-			xfB.q.Set(aB);
-			xfA.p = cA - b2Mul(xfA.q, localCenterA);
-			xfB.p = cB - b2Mul(xfB.q, localCenterB);
+			xfA.q = positionA.q;
+			xfB.q = positionB.q;
+			xfA.p = positionA.c - b2Mul(xfA.q, localCenterA);
+			xfB.p = positionB.c - b2Mul(xfB.q, localCenterB);
 
 			b2PositionSolverManifold psm;
 			psm.Initialize(pc, xfA, xfB, j);
@@ -804,8 +802,8 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 			b2Vec2 point = psm.point;
 			float separation = psm.separation;
 
-			b2Vec2 rA = point - cA;
-			b2Vec2 rB = point - cB;
+			b2Vec2 rA = point - positionA.c;
+			b2Vec2 rB = point - positionB.c;
 
 			// Track max constraint error.
 			minSeparation = b2Min(minSeparation, separation);
@@ -823,18 +821,15 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 
 			b2Vec2 P = impulse * normal;
 
-			cA -= mA * P;
-			aA -= iA * b2Cross(rA, P);
+			positionA.c -= mA * P;
+			positionA.SetAngle(positionA.a - iA * b2Cross(rA, P));
 
-			cB += mB * P;
-			aB += iB * b2Cross(rB, P);
+			positionB.c += mB * P;
+			positionB.SetAngle(positionB.a + iB * b2Cross(rB, P));
 		}
 
-		m_positions[indexA].c = cA;
-		m_positions[indexA].a = aA;
-
-		m_positions[indexB].c = cB;
-		m_positions[indexB].a = aB;
+		m_positions[indexA] = positionA;
+		m_positions[indexB] = positionB;
 	}
 
 	// We can't expect minSpeparation >= -b2_linearSlop because we don't
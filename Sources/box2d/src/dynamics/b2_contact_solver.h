@@ -41,6 +41,7 @@ struct b2VelocityConstraintPoint
 	float normalMass;
 	float tangentMass;
 	float velocityBias;
+	float relativeVelocity;
 };
 
 struct b2ContactVelocityConstraint
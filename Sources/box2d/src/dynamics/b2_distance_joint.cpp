@@ -25,6 +25,8 @@
 #include "box2d/b2_distance_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // 1-D constrained system
 // m (v2 - v1) = lambda
 // v2 + (beta/h) * x1 + gamma * lambda = 0, gamma has units of inverse mass.
@@ -85,16 +87,15 @@ void b2DistanceJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_invIB = m_bodyB->m_invI;
 
 	b2Vec2 cA = data.positions[m_indexA].c;
-	float aA = data.positions[m_indexA].a;
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 
 	b2Vec2 cB = data.positions[m_indexB].c;
-	float aB = data.positions[m_indexB].a;
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	m_rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 	m_rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -272,7 +273,8 @@ bool b2DistanceJoint::SolvePositionConstraints(const b2SolverData& data)
 	b2Vec2 cB = data.positions[m_indexB].c;
 	float aB = data.positions[m_indexB].a;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 	b2Vec2 rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -306,9 +308,9 @@ bool b2DistanceJoint::SolvePositionConstraints(const b2SolverData& data)
 	aB += m_invIB * b2Cross(rB, P);
 
 	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
+	data.positions[m_indexA].SetAngle(aA);
 	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions[m_indexB].SetAngle(aB);
 
 	return b2Abs(C) < b2_linearSlop;
 }
@@ -419,3 +421,55 @@ void b2DistanceJoint::Draw(b2Draw* draw) const
 		}
 	}
 }
+
+struct b2DistanceJointState
+{
+	float length;
+	float minLength;
+	float maxLength;
+	float stiffness;
+	float damping;
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	float impulse;
+	float lowerImpulse;
+	float upperImpulse;
+};
+
+int32 b2DistanceJoint::GetStateSize() const
+{
+	return int32(sizeof(b2DistanceJointState));
+}
+
+void b2DistanceJoint::SaveState(void* data) const
+{
+	b2DistanceJointState state;
+	memset(&state, 0, sizeof(state));
+	state.length = m_length;
+	state.minLength = m_minLength;
+	state.maxLength = m_maxLength;
+	state.stiffness = m_stiffness;
+	state.damping = m_damping;
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.impulse = m_impulse;
+	state.lowerImpulse = m_lowerImpulse;
+	state.upperImpulse = m_upperImpulse;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2DistanceJoint::RestoreState(const void* data)
+{
+	b2DistanceJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_length = state.length;
+	m_minLength = state.minLength;
+	m_maxLength = state.maxLength;
+	m_stiffness = state.stiffness;
+	m_damping = state.damping;
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_impulse = state.impulse;
+	m_lowerImpulse = state.lowerImpulse;
+	m_upperImpulse = state.upperImpulse;
+}
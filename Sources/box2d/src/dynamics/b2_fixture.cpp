@@ -23,11 +23,15 @@
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_block_allocator.h"
 #include "box2d/b2_broad_phase.h"
+#include "box2d/b2_capsule_shape.h"
 #include "box2d/b2_chain_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_collision.h"
+#include "box2d/b2_compound.h"
 #include "box2d/b2_contact.h"
 #include "box2d/b2_edge_shape.h"
+#include "box2d/b2_height_field_shape.h"
+#include "box2d/b2_mesh_shape.h"
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_world.h"
 
@@ -39,6 +43,7 @@ b2Fixture::b2Fixture()
 	m_proxyCount = 0;
 	m_shape = nullptr;
 	m_density = 0.0f;
+	m_sensorOverlapCount = 0;
 }
 
 void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def)
@@ -55,6 +60,9 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 
 	m_isSensor = def->isSensor;
 
+	m_enableHitEvents = def->enableHitEvents;
+	m_hitEventThreshold = def->hitEventThreshold;
+
 	m_shape = def->shape->Clone(allocator);
 
 	// Reserve proxy space
@@ -64,6 +72,7 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 	{
 		m_proxies[i].fixture = nullptr;
 		m_proxies[i].proxyId = b2BroadPhase::e_nullProxy;
+		m_proxies[i].sensorIndex = -1;
 	}
 	m_proxyCount = 0;
 
@@ -115,6 +124,30 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 		}
 		break;
 
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			s->~b2CapsuleShape();
+			allocator->Free(s, sizeof(b2CapsuleShape));
+		}
+		break;
+
+	case b2Shape::e_mesh:
+		{
+			b2MeshShape* s = (b2MeshShape*)m_shape;
+			s->~b2MeshShape();
+			allocator->Free(s, sizeof(b2MeshShape));
+		}
+		break;
+
+	case b2Shape::e_heightField:
+		{
+			b2HeightFieldShape* s = (b2HeightFieldShape*)m_shape;
+			s->~b2HeightFieldShape();
+			allocator->Free(s, sizeof(b2HeightFieldShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -127,30 +160,82 @@ void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 {
 	b2Assert(m_proxyCount == 0);
 
-	// Create proxies in the broad-phase.
+	// Create proxies in the broad-phase. Sensors go to the sensor tree instead and
+	// the solid fixtures of a compound body go to its tree in body coordinates.
+	b2SensorManager* sensorManager = &m_body->GetWorld()->m_contactManager.m_sensorManager;
+	b2Compound* compound = m_isSensor ? nullptr : m_body->m_compound;
 	m_proxyCount = m_shape->GetChildCount();
 
+	b2Transform identity;
+	identity.SetIdentity();
+
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
-		m_shape->ComputeAABB(&proxy->aabb, xf, i);
-		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
 		proxy->fixture = this;
 		proxy->childIndex = i;
+
+		if (compound)
+		{
+			m_shape->ComputeAABB(&proxy->aabb, identity, i);
+			compound->CreateProxy(proxy);
+			continue;
+		}
+
+		m_shape->ComputeAABB(&proxy->aabb, xf, i);
+
+		if (m_isSensor)
+		{
+			sensorManager->CreateProxy(proxy);
+		}
+		else
+		{
+			proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
+		}
+	}
+
+	if (compound)
+	{
+		compound->Synchronize(broadPhase, xf, xf);
 	}
 }
 
 void b2Fixture::DestroyProxies(b2BroadPhase* broadPhase)
 {
+	b2SensorManager* sensorManager = &m_body->GetWorld()->m_contactManager.m_sensorManager;
+
+	// End the sensor overlaps of a solid fixture.
+	if (m_sensorOverlapCount > 0)
+	{
+		sensorManager->RemoveVisitor(this);
+	}
+
 	// Destroy proxies in the broad-phase.
+	b2Compound* compound = m_isSensor ? nullptr : m_body->m_compound;
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
-		broadPhase->DestroyProxy(proxy->proxyId);
+		if (m_isSensor)
+		{
+			sensorManager->DestroyProxy(proxy);
+		}
+		else if (compound)
+		{
+			compound->DestroyProxy(proxy);
+		}
+		else
+		{
+			broadPhase->DestroyProxy(proxy->proxyId);
+		}
 		proxy->proxyId = b2BroadPhase::e_nullProxy;
 	}
 
 	m_proxyCount = 0;
+
+	if (compound)
+	{
+		compound->Synchronize(broadPhase, m_body->m_xf, m_body->m_xf);
+	}
 }
 
 void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transform1, const b2Transform& transform2)
@@ -160,20 +245,38 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 		return;
 	}
 
+	// The body moves the proxy of a compound body.
+	if (m_isSensor == false && m_body->m_compound)
+	{
+		return;
+	}
+
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
 
 		// Compute an AABB that covers the swept shape (may miss some rotation effect).
 		b2AABB aabb1, aabb2;
-		m_shape->ComputeAABB(&aabb1, transform1, proxy->childIndex);
-		m_shape->ComputeAABB(&aabb2, transform2, proxy->childIndex);
+		m_shape->ComputeAABBs(&aabb1, &aabb2, transform1, transform2, proxy->childIndex);
 	
 		proxy->aabb.Combine(aabb1, aabb2);
 
 		b2Vec2 displacement = aabb2.GetCenter() - aabb1.GetCenter();
 
-		broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, displacement);
+		if (m_isSensor)
+		{
+			m_body->GetWorld()->m_contactManager.m_sensorManager.MoveProxy(proxy, displacement);
+		}
+		else
+		{
+			broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, displacement);
+
+			// The children of a moving mesh or height field pair up again, see b2ContactManager::AddPair.
+			if (m_shape->m_type == b2Shape::e_mesh || m_shape->m_type == b2Shape::e_heightField)
+			{
+				broadPhase->TouchProxy(proxy->proxyId);
+			}
+		}
 	}
 }
 
@@ -213,8 +316,28 @@ void b2Fixture::Refilter()
 		return;
 	}
 
+	// Sensor overlaps are filtered again on the next update.
+	if (m_isSensor || m_sensorOverlapCount > 0)
+	{
+		world->m_contactManager.m_sensorManager.m_refilter = true;
+	}
+
+	if (m_isSensor)
+	{
+		return;
+	}
+
 	// Touch each proxy so that new pairs may be created
 	b2BroadPhase* broadPhase = &world->m_contactManager.m_broadPhase;
+	if (m_body->m_compound)
+	{
+		if (m_proxyCount > 0)
+		{
+			broadPhase->TouchProxy(m_body->m_compound->m_proxy.proxyId);
+		}
+		return;
+	}
+
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		broadPhase->TouchProxy(m_proxies[i].proxyId);
@@ -223,10 +346,84 @@ void b2Fixture::Refilter()
 
 void b2Fixture::SetSensor(bool sensor)
 {
-	if (sensor != m_isSensor)
+	if (sensor == m_isSensor)
+	{
+		return;
+	}
+
+	b2World* world = m_body->GetWorld();
+	b2Assert(world->IsLocked() == false);
+	if (world->IsLocked() == true)
+	{
+		return;
+	}
+
+	m_body->SetAwake(true);
+
+	if (m_proxyCount == 0)
 	{
-		m_body->SetAwake(true);
 		m_isSensor = sensor;
+		return;
+	}
+
+	// Sensors do not have contacts.
+	if (sensor)
+	{
+		b2ContactEdge* edge = m_body->GetContactList();
+		while (edge)
+		{
+			b2Contact* c = edge->contact;
+			edge = edge->next;
+
+			if (c->GetFixtureA() == this || c->GetFixtureB() == this)
+			{
+				world->m_contactManager.Destroy(c);
+			}
+		}
+	}
+
+	// Move the proxies between the broad-phase and the sensor tree.
+	b2BroadPhase* broadPhase = &world->m_contactManager.m_broadPhase;
+	DestroyProxies(broadPhase);
+	m_isSensor = sensor;
+	CreateProxies(broadPhase, m_body->GetTransform());
+
+	world->m_newContacts = true;
+}
+
+void b2Fixture::EnableHitEvents(bool flag)
+{
+	if (flag == m_enableHitEvents)
+	{
+		return;
+	}
+
+	m_enableHitEvents = flag;
+
+	if (m_body == nullptr)
+	{
+		return;
+	}
+
+	// Update the existing contacts.
+	for (b2ContactEdge* edge = m_body->GetContactList(); edge; edge = edge->next)
+	{
+		b2Contact* contact = edge->contact;
+		b2Fixture* fixtureA = contact->GetFixtureA();
+		b2Fixture* fixtureB = contact->GetFixtureB();
+		if (fixtureA != this && fixtureB != this)
+		{
+			continue;
+		}
+
+		if (fixtureA->m_enableHitEvents || fixtureB->m_enableHitEvents)
+		{
+			contact->m_flags |= b2Contact::e_hitEventFlag;
+		}
+		else
+		{
+			contact->m_flags &= ~b2Contact::e_hitEventFlag;
+		}
 	}
 }
 
@@ -238,6 +435,8 @@ void b2Fixture::Dump(int32 bodyIndex)
 	b2Dump("    fd.restitutionThreshold = %.9g;\n", m_restitutionThreshold);
 	b2Dump("    fd.density = %.9g;\n", m_density);
 	b2Dump("    fd.isSensor = bool(%d);\n", m_isSensor);
+	b2Dump("    fd.enableHitEvents = bool(%d);\n", m_enableHitEvents);
+	b2Dump("    fd.hitEventThreshold = %.9g;\n", m_hitEventThreshold);
 	b2Dump("    fd.filter.categoryBits = uint16(%d);\n", m_filter.categoryBits);
 	b2Dump("    fd.filter.maskBits = uint16(%d);\n", m_filter.maskBits);
 	b2Dump("    fd.filter.groupIndex = int16(%d);\n", m_filter.groupIndex);
@@ -294,6 +493,43 @@ void b2Fixture::Dump(int32 bodyIndex)
 		}
 		break;
 
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			b2Dump("    b2CapsuleShape shape;\n");
+			b2Dump("    shape.m_radius = %.9g;\n", s->m_radius);
+			b2Dump("    shape.m_vertex1.Set(%.9g, %.9g);\n", s->m_vertex1.x, s->m_vertex1.y);
+			b2Dump("    shape.m_vertex2.Set(%.9g, %.9g);\n", s->m_vertex2.x, s->m_vertex2.y);
+		}
+		break;
+
+	case b2Shape::e_mesh:
+		{
+			b2MeshShape* s = (b2MeshShape*)m_shape;
+			b2Dump("    b2MeshShape shape;\n");
+			b2Dump("    b2Vec2 vs[%d];\n", s->m_count);
+			for (int32 i = 0; i < s->m_count; ++i)
+			{
+				b2Dump("    vs[%d].Set(%.9g, %.9g);\n", i, s->m_vertices[i].x, s->m_vertices[i].y);
+			}
+			b2Dump("    shape.CreateChain(vs, %d, b2Vec2(%.9g, %.9g), b2Vec2(%.9g, %.9g));\n", s->m_count,
+				s->m_prevVertex.x, s->m_prevVertex.y, s->m_nextVertex.x, s->m_nextVertex.y);
+		}
+		break;
+
+	case b2Shape::e_heightField:
+		{
+			b2HeightFieldShape* s = (b2HeightFieldShape*)m_shape;
+			b2Dump("    b2HeightFieldShape shape;\n");
+			b2Dump("    float hs[%d];\n", s->m_count);
+			for (int32 i = 0; i < s->m_count; ++i)
+			{
+				b2Dump("    hs[%d] = %.9g;\n", i, s->m_heights[i]);
+			}
+			b2Dump("    shape.CreateHeights(hs, %d, %.9g, %.9g, %.9g);\n", s->m_count, s->m_spacing, s->m_minHeight, s->m_maxHeight);
+		}
+		break;
+
 	default:
 		return;
 	}
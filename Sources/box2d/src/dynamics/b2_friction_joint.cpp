@@ -24,6 +24,8 @@
 #include "box2d/b2_body.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Point-to-point constraint
 // Cdot = v2 - v1
 //      = v2 + cross(w2, r2) - v1 - cross(w1, r1)
@@ -68,15 +70,14 @@ void b2FrictionJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_invIA = m_bodyA->m_invI;
 	m_invIB = m_bodyB->m_invI;
 
-	float aA = data.positions[m_indexA].a;
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 
-	float aB = data.positions[m_indexB].a;
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	// Compute the effective mass matrix.
 	m_rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
@@ -253,3 +254,43 @@ void b2FrictionJoint::Dump()
 	b2Dump("  jd.maxTorque = %.9g;\n", m_maxTorque);
 	b2Dump("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+struct b2FrictionJointState
+{
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 linearImpulse;
+	float angularImpulse;
+	float maxForce;
+	float maxTorque;
+};
+
+int32 b2FrictionJoint::GetStateSize() const
+{
+	return int32(sizeof(b2FrictionJointState));
+}
+
+void b2FrictionJoint::SaveState(void* data) const
+{
+	b2FrictionJointState state;
+	memset(&state, 0, sizeof(state));
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.linearImpulse = m_linearImpulse;
+	state.angularImpulse = m_angularImpulse;
+	state.maxForce = m_maxForce;
+	state.maxTorque = m_maxTorque;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2FrictionJoint::RestoreState(const void* data)
+{
+	b2FrictionJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_linearImpulse = state.linearImpulse;
+	m_angularImpulse = state.angularImpulse;
+	m_maxForce = state.maxForce;
+	m_maxTorque = state.maxTorque;
+}
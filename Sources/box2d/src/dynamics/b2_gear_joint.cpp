@@ -26,6 +26,8 @@
 #include "box2d/b2_body.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Gear Joint:
 // C0 = (coordinate1 + ratio * coordinate2)_initial
 // C = (coordinate1 + ratio * coordinate2) - C0 = 0
@@ -163,23 +165,22 @@ void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_iC = m_bodyC->m_invI;
 	m_iD = m_bodyD->m_invI;
 
-	float aA = data.positions[m_indexA].a;
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 
-	float aB = data.positions[m_indexB].a;
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	float aC = data.positions[m_indexC].a;
 	b2Vec2 vC = data.velocities[m_indexC].v;
 	float wC = data.velocities[m_indexC].w;
 
-	float aD = data.positions[m_indexD].a;
 	b2Vec2 vD = data.velocities[m_indexD].v;
 	float wD = data.velocities[m_indexD].w;
 
-	b2Rot qA(aA), qB(aB), qC(aC), qD(aD);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
+	b2Rot qC = data.positions[m_indexC].q;
+	b2Rot qD = data.positions[m_indexD].q;
 
 	m_mass = 0.0f;
 
@@ -295,7 +296,10 @@ bool b2GearJoint::SolvePositionConstraints(const b2SolverData& data)
 	b2Vec2 cD = data.positions[m_indexD].c;
 	float aD = data.positions[m_indexD].a;
 
-	b2Rot qA(aA), qB(aB), qC(aC), qD(aD);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
+	b2Rot qC = data.positions[m_indexC].q;
+	b2Rot qD = data.positions[m_indexD].q;
 
 	float coordinateA, coordinateB;
 
@@ -369,13 +373,13 @@ bool b2GearJoint::SolvePositionConstraints(const b2SolverData& data)
 	aD -= m_iD * impulse * JwD;
 
 	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
+	data.positions[m_indexA].SetAngle(aA);
 	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions[m_indexB].SetAngle(aB);
 	data.positions[m_indexC].c = cC;
-	data.positions[m_indexC].a = aC;
+	data.positions[m_indexC].SetAngle(aC);
 	data.positions[m_indexD].c = cD;
-	data.positions[m_indexD].a = aD;
+	data.positions[m_indexD].SetAngle(aD);
 
 	if (b2Abs(C) < m_tolerance)
 	{
@@ -435,3 +439,58 @@ void b2GearJoint::Dump()
 	b2Dump("  jd.ratio = %.9g;\n", m_ratio);
 	b2Dump("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+struct b2GearJointState
+{
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 localAnchorC;
+	b2Vec2 localAnchorD;
+	b2Vec2 localAxisC;
+	b2Vec2 localAxisD;
+	float referenceAngleA;
+	float referenceAngleB;
+	float constant;
+	float ratio;
+	float impulse;
+};
+
+int32 b2GearJoint::GetStateSize() const
+{
+	return int32(sizeof(b2GearJointState));
+}
+
+void b2GearJoint::SaveState(void* data) const
+{
+	b2GearJointState state;
+	memset(&state, 0, sizeof(state));
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.localAnchorC = m_localAnchorC;
+	state.localAnchorD = m_localAnchorD;
+	state.localAxisC = m_localAxisC;
+	state.localAxisD = m_localAxisD;
+	state.referenceAngleA = m_referenceAngleA;
+	state.referenceAngleB = m_referenceAngleB;
+	state.constant = m_constant;
+	state.ratio = m_ratio;
+	state.impulse = m_impulse;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2GearJoint::RestoreState(const void* data)
+{
+	b2GearJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_localAnchorC = state.localAnchorC;
+	m_localAnchorD = state.localAnchorD;
+	m_localAxisC = state.localAxisC;
+	m_localAxisD = state.localAxisD;
+	m_referenceAngleA = state.referenceAngleA;
+	m_referenceAngleB = state.referenceAngleB;
+	m_constant = state.constant;
+	m_ratio = state.ratio;
+	m_impulse = state.impulse;
+}
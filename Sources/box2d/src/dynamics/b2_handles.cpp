@@ -0,0 +1,293 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_handles.h"
+#include "box2d/b2_body.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_joint.h"
+#include "box2d/b2_world.h"
+
+static const b2BodyId b2_nullBodyId = {};
+static const b2FixtureId b2_nullFixtureId = {};
+static const b2JointId b2_nullJointId = {};
+
+b2BodyId b2World_CreateBody(b2World* world, const b2BodyDef* def)
+{
+	b2Body* body = world->CreateBody(def);
+	return body ? body->GetId() : b2_nullBodyId;
+}
+
+void b2World_DestroyBody(b2World* world, b2BodyId bodyId)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		world->DestroyBody(body);
+	}
+}
+
+b2JointId b2World_CreateJoint(b2World* world, const b2JointDef* def)
+{
+	b2Joint* joint = world->CreateJoint(def);
+	return joint ? joint->GetId() : b2_nullJointId;
+}
+
+void b2World_DestroyJoint(b2World* world, b2JointId jointId)
+{
+	b2Joint* joint = world->GetJoint(jointId);
+	b2Assert(joint != nullptr);
+	if (joint)
+	{
+		world->DestroyJoint(joint);
+	}
+}
+
+bool b2Body_IsValid(const b2World* world, b2BodyId bodyId)
+{
+	return world->GetBody(bodyId) != nullptr;
+}
+
+b2FixtureId b2Body_CreateFixture(b2World* world, b2BodyId bodyId, const b2FixtureDef* def)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body == nullptr)
+	{
+		return b2_nullFixtureId;
+	}
+
+	b2Fixture* fixture = body->CreateFixture(def);
+	return fixture ? fixture->GetId() : b2_nullFixtureId;
+}
+
+b2BodyType b2Body_GetType(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->GetType() : b2_staticBody;
+}
+
+b2Vec2 b2Body_GetPosition(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->GetPosition() : b2Vec2_zero;
+}
+
+float b2Body_GetAngle(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->GetAngle() : 0.0f;
+}
+
+b2Transform b2Body_GetTransform(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body == nullptr)
+	{
+		b2Transform xf;
+		xf.SetIdentity();
+		return xf;
+	}
+
+	return body->GetTransform();
+}
+
+b2Vec2 b2Body_GetWorldCenter(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->GetWorldCenter() : b2Vec2_zero;
+}
+
+b2Vec2 b2Body_GetLinearVelocity(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->GetLinearVelocity() : b2Vec2_zero;
+}
+
+float b2Body_GetAngularVelocity(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->GetAngularVelocity() : 0.0f;
+}
+
+float b2Body_GetMass(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->GetMass() : 0.0f;
+}
+
+bool b2Body_IsAwake(const b2World* world, b2BodyId bodyId)
+{
+	const b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	return body ? body->IsAwake() : false;
+}
+
+void b2Body_SetTransform(b2World* world, b2BodyId bodyId, b2Vec2 position, float angle)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		body->SetTransform(position, angle);
+	}
+}
+
+void b2Body_SetLinearVelocity(b2World* world, b2BodyId bodyId, b2Vec2 v)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		body->SetLinearVelocity(v);
+	}
+}
+
+void b2Body_SetAngularVelocity(b2World* world, b2BodyId bodyId, float w)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		body->SetAngularVelocity(w);
+	}
+}
+
+void b2Body_ApplyForceToCenter(b2World* world, b2BodyId bodyId, b2Vec2 force, bool wake)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		body->ApplyForceToCenter(force, wake);
+	}
+}
+
+void b2Body_ApplyTorque(b2World* world, b2BodyId bodyId, float torque, bool wake)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		body->ApplyTorque(torque, wake);
+	}
+}
+
+void b2Body_ApplyLinearImpulseToCenter(b2World* world, b2BodyId bodyId, b2Vec2 impulse, bool wake)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		body->ApplyLinearImpulseToCenter(impulse, wake);
+	}
+}
+
+void b2Body_SetAwake(b2World* world, b2BodyId bodyId, bool flag)
+{
+	b2Body* body = world->GetBody(bodyId);
+	b2Assert(body != nullptr);
+	if (body)
+	{
+		body->SetAwake(flag);
+	}
+}
+
+bool b2Fixture_IsValid(const b2World* world, b2FixtureId fixtureId)
+{
+	return world->GetFixture(fixtureId) != nullptr;
+}
+
+void b2Fixture_Destroy(b2World* world, b2FixtureId fixtureId)
+{
+	b2Fixture* fixture = world->GetFixture(fixtureId);
+	b2Assert(fixture != nullptr);
+	if (fixture)
+	{
+		fixture->GetBody()->DestroyFixture(fixture);
+	}
+}
+
+b2BodyId b2Fixture_GetBody(const b2World* world, b2FixtureId fixtureId)
+{
+	const b2Fixture* fixture = world->GetFixture(fixtureId);
+	b2Assert(fixture != nullptr);
+	return fixture ? fixture->GetBody()->GetId() : b2_nullBodyId;
+}
+
+bool b2Fixture_IsSensor(const b2World* world, b2FixtureId fixtureId)
+{
+	const b2Fixture* fixture = world->GetFixture(fixtureId);
+	b2Assert(fixture != nullptr);
+	return fixture ? fixture->IsSensor() : false;
+}
+
+void b2Fixture_SetSensor(b2World* world, b2FixtureId fixtureId, bool sensor)
+{
+	b2Fixture* fixture = world->GetFixture(fixtureId);
+	b2Assert(fixture != nullptr);
+	if (fixture)
+	{
+		fixture->SetSensor(sensor);
+	}
+}
+
+bool b2Fixture_TestPoint(const b2World* world, b2FixtureId fixtureId, b2Vec2 point)
+{
+	const b2Fixture* fixture = world->GetFixture(fixtureId);
+	b2Assert(fixture != nullptr);
+	return fixture ? fixture->TestPoint(point) : false;
+}
+
+bool b2Joint_IsValid(const b2World* world, b2JointId jointId)
+{
+	return world->GetJoint(jointId) != nullptr;
+}
+
+b2JointType b2Joint_GetType(const b2World* world, b2JointId jointId)
+{
+	const b2Joint* joint = world->GetJoint(jointId);
+	b2Assert(joint != nullptr);
+	return joint ? joint->GetType() : e_unknownJoint;
+}
+
+b2BodyId b2Joint_GetBodyA(const b2World* world, b2JointId jointId)
+{
+	const b2Joint* joint = world->GetJoint(jointId);
+	b2Assert(joint != nullptr);
+	return joint ? joint->GetBodyA()->GetId() : b2_nullBodyId;
+}
+
+b2BodyId b2Joint_GetBodyB(const b2World* world, b2JointId jointId)
+{
+	const b2Joint* joint = world->GetJoint(jointId);
+	b2Assert(joint != nullptr);
+	return joint ? joint->GetBodyB()->GetId() : b2_nullBodyId;
+}
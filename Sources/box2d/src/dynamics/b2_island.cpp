@@ -22,6 +22,7 @@
 
 #include "box2d/b2_body.h"
 #include "box2d/b2_contact.h"
+#include "box2d/b2_contact_manager.h"
 #include "box2d/b2_distance.h"
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_joint.h"
@@ -155,7 +156,7 @@ b2Island::b2Island(
 	int32 contactCapacity,
 	int32 jointCapacity,
 	b2StackAllocator* allocator,
-	b2ContactListener* listener)
+	b2ContactManager* contactManager)
 {
 	m_bodyCapacity = bodyCapacity;
 	m_contactCapacity = contactCapacity;
@@ -165,7 +166,8 @@ b2Island::b2Island(
 	m_jointCount = 0;
 
 	m_allocator = allocator;
-	m_listener = listener;
+	m_contactManager = contactManager;
+	m_listener = contactManager->m_contactListener;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -198,12 +200,14 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 		b2Vec2 c = b->m_sweep.c;
 		float a = b->m_sweep.a;
+		b2Rot q = b->m_sweep.q;
 		b2Vec2 v = b->m_linearVelocity;
 		float w = b->m_angularVelocity;
 
 		// Store positions for continuous collision.
 		b->m_sweep.c0 = b->m_sweep.c;
 		b->m_sweep.a0 = b->m_sweep.a;
+		b->m_sweep.q0 = b->m_sweep.q;
 
 		if (b->m_type == b2_dynamicBody)
 		{
@@ -224,6 +228,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 		m_positions[i].c = c;
 		m_positions[i].a = a;
+		m_positions[i].q = q;
 		m_velocities[i].v = v;
 		m_velocities[i].w = w;
 	}
@@ -304,7 +309,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		a += h * w;
 
 		m_positions[i].c = c;
-		m_positions[i].a = a;
+		m_positions[i].SetAngle(a);
 		m_velocities[i].v = v;
 		m_velocities[i].w = w;
 	}
@@ -337,6 +342,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		b2Body* body = m_bodies[i];
 		body->m_sweep.c = m_positions[i].c;
 		body->m_sweep.a = m_positions[i].a;
+		body->m_sweep.q = m_positions[i].q;
 		body->m_linearVelocity = m_velocities[i].v;
 		body->m_angularVelocity = m_velocities[i].w;
 		body->SynchronizeTransform();
@@ -397,6 +403,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 		b2Body* b = m_bodies[i];
 		m_positions[i].c = b->m_sweep.c;
 		m_positions[i].a = b->m_sweep.a;
+		m_positions[i].q = b->m_sweep.q;
 		m_velocities[i].v = b->m_linearVelocity;
 		m_velocities[i].w = b->m_angularVelocity;
 	}
@@ -456,8 +463,10 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	// Leap of faith to new safe state.
 	m_bodies[toiIndexA]->m_sweep.c0 = m_positions[toiIndexA].c;
 	m_bodies[toiIndexA]->m_sweep.a0 = m_positions[toiIndexA].a;
+	m_bodies[toiIndexA]->m_sweep.q0 = m_positions[toiIndexA].q;
 	m_bodies[toiIndexB]->m_sweep.c0 = m_positions[toiIndexB].c;
 	m_bodies[toiIndexB]->m_sweep.a0 = m_positions[toiIndexB].a;
+	m_bodies[toiIndexB]->m_sweep.q0 = m_positions[toiIndexB].q;
 
 	// No warm starting is needed for TOI events because warm
 	// starting impulses were applied in the discrete solver.
@@ -502,7 +511,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 		a += h * w;
 
 		m_positions[i].c = c;
-		m_positions[i].a = a;
+		m_positions[i].SetAngle(a);
 		m_velocities[i].v = v;
 		m_velocities[i].w = w;
 
@@ -510,6 +519,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 		b2Body* body = m_bodies[i];
 		body->m_sweep.c = c;
 		body->m_sweep.a = a;
+		body->m_sweep.q = m_positions[i].q;
 		body->m_linearVelocity = v;
 		body->m_angularVelocity = w;
 		body->SynchronizeTransform();
@@ -520,25 +530,68 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == nullptr)
-	{
-		return;
-	}
-
 	for (int32 i = 0; i < m_contactCount; ++i)
 	{
 		b2Contact* c = m_contacts[i];
 
 		const b2ContactVelocityConstraint* vc = constraints + i;
-		
-		b2ContactImpulse impulse;
-		impulse.count = vc->pointCount;
+
+		if (m_listener)
+		{
+			b2ContactImpulse impulse;
+			impulse.count = vc->pointCount;
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				impulse.normalImpulses[j] = vc->points[j].normalImpulse;
+				impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
+			}
+
+			m_listener->PostSolve(c, &impulse);
+		}
+
+		if ((c->m_flags & b2Contact::e_hitEventFlag) == 0)
+		{
+			continue;
+		}
+
+		// Use the point that approached the fastest before the solver ran.
+		float approachSpeed = 0.0f;
+		float maxNormalImpulse = 0.0f;
+		int32 index = 0;
 		for (int32 j = 0; j < vc->pointCount; ++j)
 		{
-			impulse.normalImpulses[j] = vc->points[j].normalImpulse;
-			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
+			const b2VelocityConstraintPoint* vcp = vc->points + j;
+			maxNormalImpulse = b2Max(maxNormalImpulse, vcp->normalImpulse);
+			if (-vcp->relativeVelocity > approachSpeed)
+			{
+				approachSpeed = -vcp->relativeVelocity;
+				index = j;
+			}
+		}
+
+		// Only real impacts. Speculative points that were never reached have no impulse.
+		b2Fixture* fixtureA = c->GetFixtureA();
+		b2Fixture* fixtureB = c->GetFixtureB();
+		float threshold = b2Max(fixtureA->GetHitEventThreshold(), fixtureB->GetHitEventThreshold());
+		threshold = b2Max(threshold, m_contactManager->m_hitEventThreshold);
+		if (approachSpeed <= threshold || maxNormalImpulse == 0.0f)
+		{
+			continue;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		b2ContactHitEvent event;
+		event.fixtureA = fixtureA;
+		event.fixtureB = fixtureB;
+		event.userDataA = fixtureA->GetUserData();
+		event.userDataB = fixtureB->GetUserData();
+		event.childIndexA = c->GetChildIndexA();
+		event.childIndexB = c->GetChildIndexB();
+		// The anchor is relative to the center the constraints were built at, which is
+		// c0 in both solvers. The center has been integrated since.
+		event.point = fixtureA->GetBody()->m_sweep.c0 + vc->points[index].rA;
+		event.normal = vc->normal;
+		event.approachSpeed = approachSpeed;
+		event.maxNormalImpulse = maxNormalImpulse;
+		m_contactManager->HitContact(c, &event);
 	}
 }
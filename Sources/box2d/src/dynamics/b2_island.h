@@ -31,6 +31,7 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+class b2ContactManager;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
@@ -39,7 +40,7 @@ class b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactManager* contactManager);
 	~b2Island();
 
 	void Clear()
@@ -76,6 +77,7 @@ public:
 	void Report(const b2ContactVelocityConstraint* constraints);
 
 	b2StackAllocator* m_allocator;
+	b2ContactManager* m_contactManager;
 	b2ContactListener* m_listener;
 
 	b2Body** m_bodies;
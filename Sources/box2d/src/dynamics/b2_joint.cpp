@@ -174,51 +174,46 @@ b2Joint* b2Joint::Create(const b2JointDef* def, b2BlockAllocator* allocator)
 void b2Joint::Destroy(b2Joint* joint, b2BlockAllocator* allocator)
 {
 	joint->~b2Joint();
-	switch (joint->m_type)
+	allocator->Free(joint, GetSize(joint->m_type));
+}
+
+int32 b2Joint::GetSize(b2JointType type)
+{
+	switch (type)
 	{
 	case e_distanceJoint:
-		allocator->Free(joint, sizeof(b2DistanceJoint));
-		break;
+		return int32(sizeof(b2DistanceJoint));
 
 	case e_mouseJoint:
-		allocator->Free(joint, sizeof(b2MouseJoint));
-		break;
+		return int32(sizeof(b2MouseJoint));
 
 	case e_prismaticJoint:
-		allocator->Free(joint, sizeof(b2PrismaticJoint));
-		break;
+		return int32(sizeof(b2PrismaticJoint));
 
 	case e_revoluteJoint:
-		allocator->Free(joint, sizeof(b2RevoluteJoint));
-		break;
+		return int32(sizeof(b2RevoluteJoint));
 
 	case e_pulleyJoint:
-		allocator->Free(joint, sizeof(b2PulleyJoint));
-		break;
+		return int32(sizeof(b2PulleyJoint));
 
 	case e_gearJoint:
-		allocator->Free(joint, sizeof(b2GearJoint));
-		break;
+		return int32(sizeof(b2GearJoint));
 
 	case e_wheelJoint:
-		allocator->Free(joint, sizeof(b2WheelJoint));
-		break;
+		return int32(sizeof(b2WheelJoint));
     
 	case e_weldJoint:
-		allocator->Free(joint, sizeof(b2WeldJoint));
-		break;
+		return int32(sizeof(b2WeldJoint));
 
 	case e_frictionJoint:
-		allocator->Free(joint, sizeof(b2FrictionJoint));
-		break;
+		return int32(sizeof(b2FrictionJoint));
 
 	case e_motorJoint:
-		allocator->Free(joint, sizeof(b2MotorJoint));
-		break;
+		return int32(sizeof(b2MotorJoint));
 
 	default:
 		b2Assert(false);
-		break;
+		return 0;
 	}
 }
 
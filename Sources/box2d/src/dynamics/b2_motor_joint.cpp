@@ -24,6 +24,8 @@
 #include "box2d/b2_motor_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Point-to-point constraint
 // Cdot = v2 - v1
 //      = v2 + cross(w2, r2) - v1 - cross(w1, r1)
@@ -86,7 +88,8 @@ void b2MotorJoint::InitVelocityConstraints(const b2SolverData& data)
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	// Compute the effective mass matrix.
 	m_rA = b2Mul(qA, m_linearOffset - m_localCenterA);
@@ -309,3 +312,46 @@ void b2MotorJoint::Dump()
 	b2Dump("  jd.correctionFactor = %.9g;\n", m_correctionFactor);
 	b2Dump("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+struct b2MotorJointState
+{
+	b2Vec2 linearOffset;
+	float angularOffset;
+	b2Vec2 linearImpulse;
+	float angularImpulse;
+	float maxForce;
+	float maxTorque;
+	float correctionFactor;
+};
+
+int32 b2MotorJoint::GetStateSize() const
+{
+	return int32(sizeof(b2MotorJointState));
+}
+
+void b2MotorJoint::SaveState(void* data) const
+{
+	b2MotorJointState state;
+	memset(&state, 0, sizeof(state));
+	state.linearOffset = m_linearOffset;
+	state.angularOffset = m_angularOffset;
+	state.linearImpulse = m_linearImpulse;
+	state.angularImpulse = m_angularImpulse;
+	state.maxForce = m_maxForce;
+	state.maxTorque = m_maxTorque;
+	state.correctionFactor = m_correctionFactor;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2MotorJoint::RestoreState(const void* data)
+{
+	b2MotorJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_linearOffset = state.linearOffset;
+	m_angularOffset = state.angularOffset;
+	m_linearImpulse = state.linearImpulse;
+	m_angularImpulse = state.angularImpulse;
+	m_maxForce = state.maxForce;
+	m_maxTorque = state.maxTorque;
+	m_correctionFactor = state.correctionFactor;
+}
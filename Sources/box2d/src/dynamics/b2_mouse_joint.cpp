@@ -24,6 +24,8 @@
 #include "box2d/b2_mouse_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // p = attached point, m = mouse point
 // C = p - m
 // Cdot = v
@@ -78,11 +80,10 @@ void b2MouseJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_invIB = m_bodyB->m_invI;
 
 	b2Vec2 cB = data.positions[m_indexB].c;
-	float aB = data.positions[m_indexB].a;
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qB(aB);
+	b2Rot qB = data.positions[m_indexB].q;
 
 	float d = m_damping;
 	float k = m_stiffness;
@@ -188,3 +189,43 @@ void b2MouseJoint::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	m_targetA -= newOrigin;
 }
+
+struct b2MouseJointState
+{
+	b2Vec2 localAnchorB;
+	b2Vec2 targetA;
+	float stiffness;
+	float damping;
+	b2Vec2 impulse;
+	float maxForce;
+};
+
+int32 b2MouseJoint::GetStateSize() const
+{
+	return int32(sizeof(b2MouseJointState));
+}
+
+void b2MouseJoint::SaveState(void* data) const
+{
+	b2MouseJointState state;
+	memset(&state, 0, sizeof(state));
+	state.localAnchorB = m_localAnchorB;
+	state.targetA = m_targetA;
+	state.stiffness = m_stiffness;
+	state.damping = m_damping;
+	state.impulse = m_impulse;
+	state.maxForce = m_maxForce;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2MouseJoint::RestoreState(const void* data)
+{
+	b2MouseJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_localAnchorB = state.localAnchorB;
+	m_targetA = state.targetA;
+	m_stiffness = state.stiffness;
+	m_damping = state.damping;
+	m_impulse = state.impulse;
+	m_maxForce = state.maxForce;
+}
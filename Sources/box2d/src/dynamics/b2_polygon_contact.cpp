@@ -24,6 +24,7 @@
 
 #include "box2d/b2_block_allocator.h"
 #include "box2d/b2_body.h"
+#include "box2d/b2_contact_manager.h"
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_time_of_impact.h"
 #include "box2d/b2_world_callbacks.h"
@@ -47,6 +48,10 @@ b2PolygonContact::b2PolygonContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
 {
 	b2Assert(m_fixtureA->GetType() == b2Shape::e_polygon);
 	b2Assert(m_fixtureB->GetType() == b2Shape::e_polygon);
+
+	m_axisCache.type = b2SeparatingAxisCache::e_empty;
+	m_axisCache.edge = 0;
+	m_relativeTransform.SetIdentity();
 }
 
 void b2PolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
@@ -55,3 +60,35 @@ void b2PolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, co
 						(b2PolygonShape*)m_fixtureA->GetShape(), xfA,
 						(b2PolygonShape*)m_fixtureB->GetShape(), xfB);
 }
+
+void b2PolygonContact::UpdateManifold(b2ContactManager* manager, const b2Transform& xfA, const b2Transform& xfB)
+{
+	b2Transform relativeTransform = b2MulT(xfA, xfB);
+
+	// Only a manifold of touching shapes is kept, the cached axis already makes
+	// separated pairs cheap.
+	if (m_flags & e_touchingFlag)
+	{
+		b2Vec2 d = relativeTransform.p - m_relativeTransform.p;
+		b2Rot dq = b2MulT(m_relativeTransform.q, relativeTransform.q);
+		float linearTolerance = manager->m_reuseLinearTolerance;
+
+		// The sine alone is also small near a half turn.
+		bool smallRotation = dq.c > 0.0f && b2Abs(dq.s) < manager->m_reuseAngularTolerance;
+		if (b2Dot(d, d) < linearTolerance * linearTolerance && smallRotation)
+		{
+			m_flags |= e_reusedManifoldFlag;
+			return;
+		}
+	}
+
+	bool separated = b2CollidePolygons(&m_manifold,
+									   (b2PolygonShape*)m_fixtureA->GetShape(), xfA,
+									   (b2PolygonShape*)m_fixtureB->GetShape(), xfB, &m_axisCache);
+	if (separated)
+	{
+		m_flags |= e_cachedAxisFlag;
+	}
+
+	m_relativeTransform = relativeTransform;
+}
@@ -38,6 +38,15 @@ public:
 	~b2PolygonContact() {}
 
 	void Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB) override;
+
+	// Test the last separating axis first and keep the manifold while the relative
+	// motion stays within the world's reuse tolerance.
+	void UpdateManifold(b2ContactManager* manager, const b2Transform& xfA, const b2Transform& xfB) override;
+
+	b2SeparatingAxisCache m_axisCache;
+
+	// The transform of body B in the frame of body A when the manifold was computed.
+	b2Transform m_relativeTransform;
 };
 
 #endif
@@ -25,6 +25,8 @@
 #include "box2d/b2_prismatic_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Linear constraint (point-to-line)
 // d = p2 - p1 = x2 + r2 - x1 - r1
 // C = dot(perp, d)
@@ -123,16 +125,15 @@ void b2PrismaticJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_invIB = m_bodyB->m_invI;
 
 	b2Vec2 cA = data.positions[m_indexA].c;
-	float aA = data.positions[m_indexA].a;
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 
 	b2Vec2 cB = data.positions[m_indexB].c;
-	float aB = data.positions[m_indexB].a;
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	// Compute the effective masses.
 	b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
@@ -336,7 +337,8 @@ bool b2PrismaticJoint::SolvePositionConstraints(const b2SolverData& data)
 	b2Vec2 cB = data.positions[m_indexB].c;
 	float aB = data.positions[m_indexB].a;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	float mA = m_invMassA, mB = m_invMassB;
 	float iA = m_invIA, iB = m_invIB;
@@ -443,9 +445,9 @@ bool b2PrismaticJoint::SolvePositionConstraints(const b2SolverData& data)
 	aB += iB * LB;
 
 	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
+	data.positions[m_indexA].SetAngle(aA);
 	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions[m_indexB].SetAngle(aB);
 
 	return linearError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
@@ -641,3 +643,70 @@ void b2PrismaticJoint::Draw(b2Draw* draw) const
 	draw->DrawPoint(pA, 5.0f, c1);
 	draw->DrawPoint(pB, 5.0f, c4);
 }
+
+struct b2PrismaticJointState
+{
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 localXAxisA;
+	b2Vec2 localYAxisA;
+	float referenceAngle;
+	b2Vec2 impulse;
+	float motorImpulse;
+	float lowerImpulse;
+	float upperImpulse;
+	float lowerTranslation;
+	float upperTranslation;
+	float maxMotorForce;
+	float motorSpeed;
+	uint8 enableLimit;
+	uint8 enableMotor;
+};
+
+int32 b2PrismaticJoint::GetStateSize() const
+{
+	return int32(sizeof(b2PrismaticJointState));
+}
+
+void b2PrismaticJoint::SaveState(void* data) const
+{
+	b2PrismaticJointState state;
+	memset(&state, 0, sizeof(state));
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.localXAxisA = m_localXAxisA;
+	state.localYAxisA = m_localYAxisA;
+	state.referenceAngle = m_referenceAngle;
+	state.impulse = m_impulse;
+	state.motorImpulse = m_motorImpulse;
+	state.lowerImpulse = m_lowerImpulse;
+	state.upperImpulse = m_upperImpulse;
+	state.lowerTranslation = m_lowerTranslation;
+	state.upperTranslation = m_upperTranslation;
+	state.maxMotorForce = m_maxMotorForce;
+	state.motorSpeed = m_motorSpeed;
+	state.enableLimit = m_enableLimit;
+	state.enableMotor = m_enableMotor;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2PrismaticJoint::RestoreState(const void* data)
+{
+	b2PrismaticJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_localXAxisA = state.localXAxisA;
+	m_localYAxisA = state.localYAxisA;
+	m_referenceAngle = state.referenceAngle;
+	m_impulse = state.impulse;
+	m_motorImpulse = state.motorImpulse;
+	m_lowerImpulse = state.lowerImpulse;
+	m_upperImpulse = state.upperImpulse;
+	m_lowerTranslation = state.lowerTranslation;
+	m_upperTranslation = state.upperTranslation;
+	m_maxMotorForce = state.maxMotorForce;
+	m_motorSpeed = state.motorSpeed;
+	m_enableLimit = state.enableLimit != 0;
+	m_enableMotor = state.enableMotor != 0;
+}
@@ -24,6 +24,8 @@
 #include "box2d/b2_pulley_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Pulley:
 // length1 = norm(p1 - s1)
 // length2 = norm(p2 - s2)
@@ -86,16 +88,15 @@ void b2PulleyJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_invIB = m_bodyB->m_invI;
 
 	b2Vec2 cA = data.positions[m_indexA].c;
-	float aA = data.positions[m_indexA].a;
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 
 	b2Vec2 cB = data.positions[m_indexB].c;
-	float aB = data.positions[m_indexB].a;
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	m_rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 	m_rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -198,7 +199,8 @@ bool b2PulleyJoint::SolvePositionConstraints(const b2SolverData& data)
 	b2Vec2 cB = data.positions[m_indexB].c;
 	float aB = data.positions[m_indexB].a;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 	b2Vec2 rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -256,9 +258,9 @@ bool b2PulleyJoint::SolvePositionConstraints(const b2SolverData& data)
 	aB += m_invIB * b2Cross(rB, PB);
 
 	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
+	data.positions[m_indexA].SetAngle(aA);
 	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions[m_indexB].SetAngle(aB);
 
 	return linearError < b2_linearSlop;
 }
@@ -350,3 +352,52 @@ void b2PulleyJoint::ShiftOrigin(const b2Vec2& newOrigin)
 	m_groundAnchorA -= newOrigin;
 	m_groundAnchorB -= newOrigin;
 }
+
+struct b2PulleyJointState
+{
+	b2Vec2 groundAnchorA;
+	b2Vec2 groundAnchorB;
+	float lengthA;
+	float lengthB;
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	float constant;
+	float ratio;
+	float impulse;
+};
+
+int32 b2PulleyJoint::GetStateSize() const
+{
+	return int32(sizeof(b2PulleyJointState));
+}
+
+void b2PulleyJoint::SaveState(void* data) const
+{
+	b2PulleyJointState state;
+	memset(&state, 0, sizeof(state));
+	state.groundAnchorA = m_groundAnchorA;
+	state.groundAnchorB = m_groundAnchorB;
+	state.lengthA = m_lengthA;
+	state.lengthB = m_lengthB;
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.constant = m_constant;
+	state.ratio = m_ratio;
+	state.impulse = m_impulse;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2PulleyJoint::RestoreState(const void* data)
+{
+	b2PulleyJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_groundAnchorA = state.groundAnchorA;
+	m_groundAnchorB = state.groundAnchorB;
+	m_lengthA = state.lengthA;
+	m_lengthB = state.lengthB;
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_constant = state.constant;
+	m_ratio = state.ratio;
+	m_impulse = state.impulse;
+}
@@ -25,6 +25,8 @@
 #include "box2d/b2_revolute_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Point-to-point constraint
 // C = p2 - p1
 // Cdot = v2 - v1
@@ -89,7 +91,8 @@ void b2RevoluteJoint::InitVelocityConstraints(const b2SolverData& data)
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	m_rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 	m_rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -249,7 +252,8 @@ bool b2RevoluteJoint::SolvePositionConstraints(const b2SolverData& data)
 	b2Vec2 cB = data.positions[m_indexB].c;
 	float aB = data.positions[m_indexB].a;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	float angularError = 0.0f;
 	float positionError = 0.0f;
@@ -313,9 +317,9 @@ bool b2RevoluteJoint::SolvePositionConstraints(const b2SolverData& data)
 	}
 
 	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
+	data.positions[m_indexA].SetAngle(aA);
 	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions[m_indexB].SetAngle(aB);
 
 	return positionError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
@@ -499,3 +503,64 @@ void b2RevoluteJoint::Draw(b2Draw* draw) const
 	draw->DrawSegment(pA, pB, color);
 	draw->DrawSegment(xfB.p, pB, color);
 }
+
+struct b2RevoluteJointState
+{
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 impulse;
+	float motorImpulse;
+	float lowerImpulse;
+	float upperImpulse;
+	float maxMotorTorque;
+	float motorSpeed;
+	float referenceAngle;
+	float lowerAngle;
+	float upperAngle;
+	uint8 enableMotor;
+	uint8 enableLimit;
+};
+
+int32 b2RevoluteJoint::GetStateSize() const
+{
+	return int32(sizeof(b2RevoluteJointState));
+}
+
+void b2RevoluteJoint::SaveState(void* data) const
+{
+	b2RevoluteJointState state;
+	memset(&state, 0, sizeof(state));
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.impulse = m_impulse;
+	state.motorImpulse = m_motorImpulse;
+	state.lowerImpulse = m_lowerImpulse;
+	state.upperImpulse = m_upperImpulse;
+	state.maxMotorTorque = m_maxMotorTorque;
+	state.motorSpeed = m_motorSpeed;
+	state.referenceAngle = m_referenceAngle;
+	state.lowerAngle = m_lowerAngle;
+	state.upperAngle = m_upperAngle;
+	state.enableMotor = m_enableMotor;
+	state.enableLimit = m_enableLimit;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2RevoluteJoint::RestoreState(const void* data)
+{
+	b2RevoluteJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_impulse = state.impulse;
+	m_motorImpulse = state.motorImpulse;
+	m_lowerImpulse = state.lowerImpulse;
+	m_upperImpulse = state.upperImpulse;
+	m_maxMotorTorque = state.maxMotorTorque;
+	m_motorSpeed = state.motorSpeed;
+	m_referenceAngle = state.referenceAngle;
+	m_lowerAngle = state.lowerAngle;
+	m_upperAngle = state.upperAngle;
+	m_enableMotor = state.enableMotor != 0;
+	m_enableLimit = state.enableLimit != 0;
+}
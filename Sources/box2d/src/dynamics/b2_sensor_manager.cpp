@@ -0,0 +1,444 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "box2d/b2_body.h"
+#include "box2d/b2_compound.h"
+#include "box2d/b2_contact_manager.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_sensor_manager.h"
+#include "box2d/b2_task.h"
+#include "box2d/b2_world_callbacks.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The fixtures of a compound body share its broad-phase proxy id and are told apart
+// by their id in the compound tree.
+b2SensorOverlap b2SensorManager::MakeOverlap(b2FixtureProxy* proxy)
+{
+	b2SensorOverlap overlap;
+	overlap.proxy = proxy;
+
+	const b2Compound* compound = proxy->fixture->m_body->m_compound;
+	if (compound)
+	{
+		overlap.proxyId = compound->m_proxy.proxyId;
+		overlap.childId = proxy->proxyId;
+	}
+	else
+	{
+		overlap.proxyId = proxy->proxyId;
+		overlap.childId = -1;
+	}
+
+	return overlap;
+}
+
+static int32 b2CompareOverlaps(const b2SensorOverlap* a, const b2SensorOverlap* b)
+{
+	if (a->proxyId != b->proxyId)
+	{
+		return a->proxyId < b->proxyId ? -1 : 1;
+	}
+
+	return a->childId < b->childId ? -1 : (a->childId > b->childId ? 1 : 0);
+}
+
+static int b2CompareOverlaps(const void* a, const void* b)
+{
+	return b2CompareOverlaps((const b2SensorOverlap*)a, (const b2SensorOverlap*)b);
+}
+
+// Binary search for a key in a sorted overlap array.
+static int32 b2FindOverlap(const b2SensorOverlap* overlaps, int32 count, const b2SensorOverlap& key)
+{
+	int32 low = 0;
+	int32 high = count - 1;
+	while (low <= high)
+	{
+		int32 mid = (low + high) >> 1;
+		int32 order = b2CompareOverlaps(overlaps + mid, &key);
+		if (order == 0)
+		{
+			return mid;
+		}
+
+		if (order < 0)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return -1;
+}
+
+static void b2GrowOverlaps(b2SensorOverlap** overlaps, int32 count, int32* capacity)
+{
+	b2SensorOverlap* old = *overlaps;
+	*capacity = *capacity == 0 ? 4 : 2 * *capacity;
+	*overlaps = (b2SensorOverlap*)b2Alloc(*capacity * sizeof(b2SensorOverlap));
+	if (old)
+	{
+		memcpy(*overlaps, old, count * sizeof(b2SensorOverlap));
+		b2Free(old);
+	}
+}
+
+b2SensorManager::b2SensorManager()
+{
+	m_sensorCapacity = 16;
+	m_sensorCount = 0;
+	m_sensors = (b2Sensor*)b2Alloc(m_sensorCapacity * sizeof(b2Sensor));
+
+	m_contactManager = nullptr;
+	m_refilter = false;
+}
+
+b2SensorManager::~b2SensorManager()
+{
+	for (int32 i = 0; i < m_sensorCount; ++i)
+	{
+		b2Free(m_sensors[i].overlaps);
+		b2Free(m_sensors[i].candidates);
+	}
+
+	b2Free(m_sensors);
+}
+
+void b2SensorManager::CreateProxy(b2FixtureProxy* proxy)
+{
+	if (m_sensorCount == m_sensorCapacity)
+	{
+		b2Sensor* oldSensors = m_sensors;
+		m_sensorCapacity *= 2;
+		m_sensors = (b2Sensor*)b2Alloc(m_sensorCapacity * sizeof(b2Sensor));
+		memcpy(m_sensors, oldSensors, m_sensorCount * sizeof(b2Sensor));
+		b2Free(oldSensors);
+	}
+
+	proxy->proxyId = m_tree.CreateProxy(proxy->aabb, proxy);
+	proxy->sensorIndex = m_sensorCount;
+
+	b2Sensor* sensor = m_sensors + m_sensorCount;
+	sensor->proxy = proxy;
+	sensor->overlaps = nullptr;
+	sensor->overlapCount = 0;
+	sensor->overlapCapacity = 0;
+	sensor->candidates = nullptr;
+	sensor->candidateCount = 0;
+	sensor->candidateCapacity = 0;
+	++m_sensorCount;
+}
+
+void b2SensorManager::DestroyProxy(b2FixtureProxy* proxy)
+{
+	int32 index = proxy->sensorIndex;
+	b2Assert(0 <= index && index < m_sensorCount);
+	b2Sensor* sensor = m_sensors + index;
+	b2Assert(sensor->proxy == proxy);
+
+	for (int32 i = 0; i < sensor->overlapCount; ++i)
+	{
+		b2Fixture* visitor = sensor->overlaps[i].proxy->fixture;
+		--visitor->m_sensorOverlapCount;
+		m_contactManager->EndSensorOverlap(proxy->fixture, visitor);
+	}
+
+	b2Free(sensor->overlaps);
+	b2Free(sensor->candidates);
+
+	m_tree.DestroyProxy(proxy->proxyId);
+	proxy->sensorIndex = -1;
+
+	// Swap in the last sensor to keep the array dense.
+	--m_sensorCount;
+	if (index < m_sensorCount)
+	{
+		m_sensors[index] = m_sensors[m_sensorCount];
+		m_sensors[index].proxy->sensorIndex = index;
+	}
+}
+
+void b2SensorManager::MoveProxy(b2FixtureProxy* proxy, const b2Vec2& displacement)
+{
+	m_tree.MoveProxy(proxy->proxyId, proxy->aabb, displacement);
+}
+
+void b2SensorManager::RemoveVisitor(b2Fixture* fixture)
+{
+	// The overlap count keeps this scan off the common path.
+	for (int32 i = 0; i < m_sensorCount && fixture->m_sensorOverlapCount > 0; ++i)
+	{
+		b2Sensor* sensor = m_sensors + i;
+		for (int32 j = 0; j < fixture->m_proxyCount; ++j)
+		{
+			int32 index = b2FindOverlap(sensor->overlaps, sensor->overlapCount, MakeOverlap(fixture->m_proxies + j));
+			if (index == -1)
+			{
+				continue;
+			}
+
+			--sensor->overlapCount;
+			memmove(sensor->overlaps + index, sensor->overlaps + index + 1, (sensor->overlapCount - index) * sizeof(b2SensorOverlap));
+			--fixture->m_sensorOverlapCount;
+			m_contactManager->EndSensorOverlap(sensor->proxy->fixture, fixture);
+		}
+	}
+
+	b2Assert(fixture->m_sensorOverlapCount == 0);
+}
+
+struct b2SensorManager::OverlapCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		if (proxy->fixture == nullptr)
+		{
+			// Visit the fixtures of a compound body.
+			CompoundCallback callback;
+			callback.overlapCallback = this;
+			callback.compound = (const b2Compound*)proxy;
+			callback.compound->Query(&callback, sensorAABB);
+			return true;
+		}
+
+		b2SensorOverlap key;
+		key.proxy = proxy;
+		key.proxyId = proxyId;
+		key.childId = -1;
+		Visit(key);
+		return true;
+	}
+
+	struct CompoundCallback
+	{
+		bool QueryCallback(int32 proxyId)
+		{
+			b2SensorOverlap key;
+			key.proxy = (b2FixtureProxy*)compound->m_tree.GetUserData(proxyId);
+			key.proxyId = compound->m_proxy.proxyId;
+			key.childId = proxyId;
+			overlapCallback->Visit(key);
+			return true;
+		}
+
+		OverlapCallback* overlapCallback;
+		const b2Compound* compound;
+	};
+
+	void Visit(const b2SensorOverlap& key)
+	{
+		b2FixtureProxy* proxy = key.proxy;
+		b2Fixture* fixture = proxy->fixture;
+		b2Body* body = fixture->GetBody();
+
+		// Does a joint override the overlap? Is at least one body dynamic?
+		if (body == sensorBody || body->ShouldCollide(sensorBody) == false)
+		{
+			return;
+		}
+
+		bool overlap;
+		if (sensorActive || (body->IsAwake() && body->GetType() != b2_staticBody))
+		{
+			overlap = b2TestOverlap(sensorShape, sensorChildIndex, fixture->GetShape(), proxy->childIndex,
+									sensorBody->GetTransform(), body->GetTransform());
+		}
+		else
+		{
+			// Nothing moved, keep the previous state.
+			overlap = b2FindOverlap(sensor->overlaps, sensor->overlapCount, key) != -1;
+		}
+
+		if (overlap)
+		{
+			if (sensor->candidateCount == sensor->candidateCapacity)
+			{
+				b2GrowOverlaps(&sensor->candidates, sensor->candidateCount, &sensor->candidateCapacity);
+			}
+
+			sensor->candidates[sensor->candidateCount] = key;
+			++sensor->candidateCount;
+		}
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2AABB sensorAABB;
+	b2Sensor* sensor;
+	const b2Body* sensorBody;
+	const b2Shape* sensorShape;
+	int32 sensorChildIndex;
+	bool sensorActive;
+};
+
+void b2SensorManager::FindOverlaps(b2Sensor* sensor)
+{
+	b2FixtureProxy* proxy = sensor->proxy;
+	const b2Body* body = proxy->fixture->GetBody();
+
+	OverlapCallback callback;
+	callback.broadPhase = &m_contactManager->m_broadPhase;
+	callback.sensor = sensor;
+	callback.sensorBody = body;
+	callback.sensorShape = proxy->fixture->GetShape();
+	callback.sensorChildIndex = proxy->childIndex;
+	callback.sensorActive = body->IsAwake() && body->GetType() != b2_staticBody;
+
+	callback.sensorAABB = m_tree.GetFatAABB(proxy->proxyId);
+
+	sensor->candidateCount = 0;
+	m_contactManager->m_broadPhase.Query(&callback, callback.sensorAABB);
+
+	if (sensor->candidateCount > 1)
+	{
+		qsort(sensor->candidates, sensor->candidateCount, sizeof(b2SensorOverlap), b2CompareOverlaps);
+	}
+}
+
+static void b2FindSensorOverlapsTask(int32 startIndex, int32 endIndex, void* context)
+{
+	b2SensorManager* manager = (b2SensorManager*)context;
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		manager->FindOverlaps(manager->m_sensors + i);
+	}
+}
+
+void b2SensorManager::Update()
+{
+	// Each task only writes the candidates of its own sensors. The overlap tests also
+	// bump the GJK counters, which are atomic for this reason.
+	b2ParallelFor(m_contactManager->m_taskExecutor, b2FindSensorOverlapsTask, m_sensorCount, 16, this);
+
+	b2ContactFilter* filter = m_contactManager->m_contactFilter;
+	bool refilter = m_refilter && filter != nullptr;
+	m_refilter = false;
+
+	// Merge the sorted arrays and report the differences. Accepted candidates are
+	// compacted in place and become the new overlaps.
+	for (int32 i = 0; i < m_sensorCount; ++i)
+	{
+		b2Sensor* sensor = m_sensors + i;
+		b2Fixture* sensorFixture = sensor->proxy->fixture;
+
+		b2SensorOverlap* overlaps = sensor->overlaps;
+		b2SensorOverlap* candidates = sensor->candidates;
+		int32 overlapCount = sensor->overlapCount;
+		int32 candidateCount = sensor->candidateCount;
+
+		int32 index1 = 0;
+		int32 index2 = 0;
+		int32 count = 0;
+		while (index1 < overlapCount || index2 < candidateCount)
+		{
+			int32 order = 0;
+			if (index1 < overlapCount && index2 < candidateCount)
+			{
+				order = b2CompareOverlaps(overlaps + index1, candidates + index2);
+			}
+
+			if (index2 == candidateCount || (index1 < overlapCount && order < 0))
+			{
+				// The overlap ended.
+				b2Fixture* visitor = overlaps[index1].proxy->fixture;
+				--visitor->m_sensorOverlapCount;
+				++index1;
+
+				m_contactManager->EndSensorOverlap(sensorFixture, visitor);
+			}
+			else if (index1 == overlapCount || order > 0)
+			{
+				// A new overlap, subject to user filtering.
+				b2SensorOverlap candidate = candidates[index2];
+				++index2;
+
+				b2Fixture* visitor = candidate.proxy->fixture;
+				if (filter && filter->ShouldCollide(sensorFixture, visitor) == false)
+				{
+					continue;
+				}
+
+				candidates[count++] = candidate;
+				++visitor->m_sensorOverlapCount;
+
+				m_contactManager->BeginSensorOverlap(sensorFixture, visitor);
+			}
+			else
+			{
+				// The overlap persists.
+				b2SensorOverlap candidate = candidates[index2];
+				++index1;
+				++index2;
+
+				b2Fixture* visitor = candidate.proxy->fixture;
+				if (refilter && filter->ShouldCollide(sensorFixture, visitor) == false)
+				{
+					--visitor->m_sensorOverlapCount;
+					m_contactManager->EndSensorOverlap(sensorFixture, visitor);
+					continue;
+				}
+
+				candidates[count++] = candidate;
+			}
+		}
+
+		// Swap the buffers.
+		sensor->overlaps = candidates;
+		sensor->overlapCount = count;
+		sensor->candidates = overlaps;
+		sensor->candidateCount = 0;
+
+		int32 capacity = sensor->overlapCapacity;
+		sensor->overlapCapacity = sensor->candidateCapacity;
+		sensor->candidateCapacity = capacity;
+	}
+}
+
+void b2SensorManager::SortOverlaps()
+{
+	for (int32 i = 0; i < m_sensorCount; ++i)
+	{
+		b2Sensor* sensor = m_sensors + i;
+		for (int32 j = 0; j < sensor->overlapCount; ++j)
+		{
+			sensor->overlaps[j] = MakeOverlap(sensor->overlaps[j].proxy);
+		}
+
+		qsort(sensor->overlaps, sensor->overlapCount, sizeof(b2SensorOverlap), b2CompareOverlaps);
+	}
+}
+
+bool b2SensorManager::Compact(int32 maxMoves)
+{
+	return m_tree.Compact(this, maxMoves);
+}
+
+void b2SensorManager::ProxyMoved(int32 oldProxyId, int32 newProxyId)
+{
+	B2_NOT_USED(oldProxyId);
+	b2FixtureProxy* proxy = (b2FixtureProxy*)m_tree.GetUserData(newProxyId);
+	proxy->proxyId = newProxyId;
+}
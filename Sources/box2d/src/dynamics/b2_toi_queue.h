@@ -0,0 +1,177 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_TOI_QUEUE_H
+#define B2_TOI_QUEUE_H
+
+#include <string.h>
+
+#include "box2d/b2_math.h"
+#include "box2d/b2_settings.h"
+
+class b2Contact;
+
+/// A contact that needs its time of impact computed. The sweeps are copied
+/// so the TOI can be computed without touching the bodies.
+struct b2TOICandidate
+{
+	b2Contact* contact;
+	b2Sweep sweepA;
+	b2Sweep sweepB;
+	float alpha0;
+	float alpha;
+};
+
+/// A pending time of impact event.
+struct b2TOIEvent
+{
+	float alpha;
+	uint32 order;
+	b2Contact* contact;
+};
+
+/// Does a come before b? Equal alphas go to the larger order, so the result does not
+/// depend on the shape of the heap.
+inline bool b2TOIEventLess(const b2TOIEvent& a, const b2TOIEvent& b)
+{
+	return a.alpha < b.alpha || (a.alpha == b.alpha && a.order > b.order);
+}
+
+/// This is an internal class.
+/// A binary min-heap of TOI events keyed on alpha, then on order. Events are not
+/// removed when their contact is invalidated. Instead the caller discards stale events
+/// as they reach the top of the heap.
+class b2TOIQueue
+{
+public:
+	b2TOIQueue()
+	{
+		m_events = m_array;
+		m_count = 0;
+		m_capacity = e_initialCapacity;
+	}
+
+	~b2TOIQueue()
+	{
+		if (m_events != m_array)
+		{
+			b2Free(m_events);
+			m_events = nullptr;
+		}
+	}
+
+	void Push(b2Contact* contact, float alpha, uint32 order)
+	{
+		if (m_count == m_capacity)
+		{
+			b2TOIEvent* old = m_events;
+			m_capacity *= 2;
+			m_events = (b2TOIEvent*)b2Alloc(m_capacity * sizeof(b2TOIEvent));
+			memcpy(m_events, old, m_count * sizeof(b2TOIEvent));
+			if (old != m_array)
+			{
+				b2Free(old);
+			}
+		}
+
+		b2TOIEvent event;
+		event.alpha = alpha;
+		event.order = order;
+		event.contact = contact;
+
+		// Sift up
+		int32 index = m_count;
+		++m_count;
+		while (index > 0)
+		{
+			int32 parent = (index - 1) >> 1;
+			if (b2TOIEventLess(event, m_events[parent]) == false)
+			{
+				break;
+			}
+
+			m_events[index] = m_events[parent];
+			index = parent;
+		}
+
+		m_events[index] = event;
+	}
+
+	b2TOIEvent Pop()
+	{
+		b2Assert(m_count > 0);
+		b2TOIEvent top = m_events[0];
+
+		--m_count;
+		if (m_count == 0)
+		{
+			return top;
+		}
+
+		// Sift the last event down from the root
+		b2TOIEvent last = m_events[m_count];
+		int32 index = 0;
+		for (;;)
+		{
+			int32 child = 2 * index + 1;
+			if (child >= m_count)
+			{
+				break;
+			}
+
+			if (child + 1 < m_count && b2TOIEventLess(m_events[child + 1], m_events[child]))
+			{
+				++child;
+			}
+
+			if (b2TOIEventLess(m_events[child], last) == false)
+			{
+				break;
+			}
+
+			m_events[index] = m_events[child];
+			index = child;
+		}
+
+		m_events[index] = last;
+		return top;
+	}
+
+	int32 GetCount() const
+	{
+		return m_count;
+	}
+
+private:
+
+	enum
+	{
+		e_initialCapacity = 256
+	};
+
+	b2TOIEvent* m_events;
+	b2TOIEvent m_array[e_initialCapacity];
+	int32 m_count;
+	int32 m_capacity;
+};
+
+#endif
@@ -24,6 +24,8 @@
 #include "box2d/b2_time_step.h"
 #include "box2d/b2_weld_joint.h"
 
+#include <string.h>
+
 // Point-to-point constraint
 // C = p2 - p1
 // Cdot = v2 - v1
@@ -78,7 +80,8 @@ void b2WeldJoint::InitVelocityConstraints(const b2SolverData& data)
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	m_rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 	m_rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -231,7 +234,8 @@ bool b2WeldJoint::SolvePositionConstraints(const b2SolverData& data)
 	b2Vec2 cB = data.positions[m_indexB].c;
 	float aB = data.positions[m_indexB].a;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	float mA = m_invMassA, mB = m_invMassB;
 	float iA = m_invIA, iB = m_invIB;
@@ -298,9 +302,9 @@ bool b2WeldJoint::SolvePositionConstraints(const b2SolverData& data)
 	}
 
 	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
+	data.positions[m_indexA].SetAngle(aA);
 	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions[m_indexB].SetAngle(aB);
 
 	return positionError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
@@ -342,3 +346,43 @@ void b2WeldJoint::Dump()
 	b2Dump("  jd.damping = %.9g;\n", m_damping);
 	b2Dump("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+struct b2WeldJointState
+{
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	float referenceAngle;
+	float stiffness;
+	float damping;
+	b2Vec3 impulse;
+};
+
+int32 b2WeldJoint::GetStateSize() const
+{
+	return int32(sizeof(b2WeldJointState));
+}
+
+void b2WeldJoint::SaveState(void* data) const
+{
+	b2WeldJointState state;
+	memset(&state, 0, sizeof(state));
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.referenceAngle = m_referenceAngle;
+	state.stiffness = m_stiffness;
+	state.damping = m_damping;
+	state.impulse = m_impulse;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2WeldJoint::RestoreState(const void* data)
+{
+	b2WeldJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_referenceAngle = state.referenceAngle;
+	m_stiffness = state.stiffness;
+	m_damping = state.damping;
+	m_impulse = state.impulse;
+}
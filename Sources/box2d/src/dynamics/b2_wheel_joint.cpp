@@ -25,6 +25,8 @@
 #include "box2d/b2_wheel_joint.h"
 #include "box2d/b2_time_step.h"
 
+#include <string.h>
+
 // Linear constraint (point-to-line)
 // d = pB - pA = xB + rB - xA - rA
 // C = dot(ay, d)
@@ -101,16 +103,15 @@ void b2WheelJoint::InitVelocityConstraints(const b2SolverData& data)
 	float iA = m_invIA, iB = m_invIB;
 
 	b2Vec2 cA = data.positions[m_indexA].c;
-	float aA = data.positions[m_indexA].a;
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 
 	b2Vec2 cB = data.positions[m_indexB].c;
-	float aB = data.positions[m_indexB].a;
 	b2Vec2 vB = data.velocities[m_indexB].v;
 	float wB = data.velocities[m_indexB].w;
 
-	b2Rot qA(aA), qB(aB);
+	b2Rot qA = data.positions[m_indexA].q;
+	b2Rot qB = data.positions[m_indexB].q;
 
 	// Compute the effective masses.
 	b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
@@ -352,7 +353,8 @@ bool b2WheelJoint::SolvePositionConstraints(const b2SolverData& data)
 
 	if (m_enableLimit)
 	{
-		b2Rot qA(aA), qB(aB);
+		b2Rot qA = data.positions[m_indexA].q;
+		b2Rot qB = data.positions[m_indexB].q;
 
 		b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 		b2Vec2 rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -402,7 +404,10 @@ bool b2WheelJoint::SolvePositionConstraints(const b2SolverData& data)
 
 	// Solve perpendicular constraint
 	{
-		b2Rot qA(aA), qB(aB);
+		data.positions[m_indexA].SetAngle(aA);
+		data.positions[m_indexB].SetAngle(aB);
+		b2Rot qA = data.positions[m_indexA].q;
+		b2Rot qB = data.positions[m_indexB].q;
 
 		b2Vec2 rA = b2Mul(qA, m_localAnchorA - m_localCenterA);
 		b2Vec2 rB = b2Mul(qB, m_localAnchorB - m_localCenterB);
@@ -436,9 +441,9 @@ bool b2WheelJoint::SolvePositionConstraints(const b2SolverData& data)
 	}
 
 	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
+	data.positions[m_indexA].SetAngle(aA);
 	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions[m_indexB].SetAngle(aB);
 
 	return linearError <= b2_linearSlop;
 }
@@ -670,3 +675,76 @@ void b2WheelJoint::Draw(b2Draw* draw) const
 	draw->DrawPoint(pA, 5.0f, c1);
 	draw->DrawPoint(pB, 5.0f, c4);
 }
+
+struct b2WheelJointState
+{
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 localXAxisA;
+	b2Vec2 localYAxisA;
+	float impulse;
+	float motorImpulse;
+	float springImpulse;
+	float lowerImpulse;
+	float upperImpulse;
+	float lowerTranslation;
+	float upperTranslation;
+	float maxMotorTorque;
+	float motorSpeed;
+	float stiffness;
+	float damping;
+	uint8 enableLimit;
+	uint8 enableMotor;
+};
+
+int32 b2WheelJoint::GetStateSize() const
+{
+	return int32(sizeof(b2WheelJointState));
+}
+
+void b2WheelJoint::SaveState(void* data) const
+{
+	b2WheelJointState state;
+	memset(&state, 0, sizeof(state));
+	state.localAnchorA = m_localAnchorA;
+	state.localAnchorB = m_localAnchorB;
+	state.localXAxisA = m_localXAxisA;
+	state.localYAxisA = m_localYAxisA;
+	state.impulse = m_impulse;
+	state.motorImpulse = m_motorImpulse;
+	state.springImpulse = m_springImpulse;
+	state.lowerImpulse = m_lowerImpulse;
+	state.upperImpulse = m_upperImpulse;
+	state.lowerTranslation = m_lowerTranslation;
+	state.upperTranslation = m_upperTranslation;
+	state.maxMotorTorque = m_maxMotorTorque;
+	state.motorSpeed = m_motorSpeed;
+	state.stiffness = m_stiffness;
+	state.damping = m_damping;
+	state.enableLimit = m_enableLimit;
+	state.enableMotor = m_enableMotor;
+	memcpy(data, &state, sizeof(state));
+}
+
+void b2WheelJoint::RestoreState(const void* data)
+{
+	b2WheelJointState state;
+	memcpy(&state, data, sizeof(state));
+	m_localAnchorA = state.localAnchorA;
+	m_localAnchorB = state.localAnchorB;
+	m_localXAxisA = state.localXAxisA;
+	m_localYAxisA = state.localYAxisA;
+	m_impulse = state.impulse;
+	m_motorImpulse = state.motorImpulse;
+	m_springImpulse = state.springImpulse;
+	m_lowerImpulse = state.lowerImpulse;
+	m_upperImpulse = state.upperImpulse;
+	m_lowerTranslation = state.lowerTranslation;
+	m_upperTranslation = state.upperTranslation;
+	m_maxMotorTorque = state.maxMotorTorque;
+	m_motorSpeed = state.motorSpeed;
+	m_stiffness = state.stiffness;
+	m_damping = state.damping;
+	m_enableLimit = state.enableLimit != 0;
+	m_enableMotor = state.enableMotor != 0;
+}
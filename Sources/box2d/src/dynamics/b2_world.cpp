@@ -22,23 +22,32 @@
 
 #include "b2_contact_solver.h"
 #include "b2_island.h"
+#include "b2_polygon_contact.h"
+#include "b2_toi_queue.h"
 
 #include "box2d/b2_body.h"
 #include "box2d/b2_broad_phase.h"
+#include "box2d/b2_capsule_shape.h"
 #include "box2d/b2_chain_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_collision.h"
+#include "box2d/b2_compound.h"
 #include "box2d/b2_contact.h"
 #include "box2d/b2_draw.h"
 #include "box2d/b2_edge_shape.h"
 #include "box2d/b2_fixture.h"
+#include "box2d/b2_height_field_shape.h"
+#include "box2d/b2_mesh_shape.h"
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_pulley_joint.h"
+#include "box2d/b2_task.h"
 #include "box2d/b2_time_of_impact.h"
 #include "box2d/b2_timer.h"
 #include "box2d/b2_world.h"
 
 #include <new>
+#include <stdlib.h>
+#include <string.h>
 
 b2World::b2World(const b2Vec2& gravity)
 {
@@ -49,11 +58,15 @@ b2World::b2World(const b2Vec2& gravity)
 	m_jointList = nullptr;
 
 	m_bodyCount = 0;
+	m_reportedMovedCount = 0;
+	m_reportedSleepCount = 0;
+	m_reportedWakeCount = 0;
 	m_jointCount = 0;
 
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_deterministic = false;
 
 	m_stepComplete = true;
 
@@ -88,6 +101,12 @@ b2World::~b2World()
 			f = fNext;
 		}
 
+		if (b->m_compound)
+		{
+			b->m_compound->~b2Compound();
+			b2Free(b->m_compound);
+		}
+
 		b = bNext;
 	}
 }
@@ -112,6 +131,109 @@ void b2World::SetDebugDraw(b2Draw* debugDraw)
 	m_debugDraw = debugDraw;
 }
 
+void b2World::MarkMoved(b2Body* body)
+{
+	if (body->m_flags & b2Body::e_movedFlag)
+	{
+		return;
+	}
+
+	body->m_flags |= b2Body::e_movedFlag;
+
+	// A body reported by the last step keeps its entry, see Step.
+	if (body->m_flags & b2Body::e_movedListedFlag)
+	{
+		return;
+	}
+
+	body->m_flags |= b2Body::e_movedListedFlag;
+	m_movedBodies.Push(body->m_index);
+}
+
+void b2World::ResetInterpolation(b2Body* body)
+{
+	m_previousTransforms[body->m_index] = body->m_xf;
+	m_currentTransforms[body->m_index] = body->m_xf;
+}
+
+void b2World::MarkAwake(b2Body* body, bool flag)
+{
+	if (flag)
+	{
+		m_wakeBodies.Push(body->m_index);
+	}
+	else
+	{
+		m_sleepBodies.Push(body->m_index);
+	}
+}
+
+b2BodyEvents b2World::GetBodyEvents() const
+{
+	b2BodyEvents events;
+	events.movedBodies = m_movedBodies.GetData();
+	events.sleepBodies = m_sleepBodies.GetData();
+	events.wakeBodies = m_wakeBodies.GetData();
+	events.movedCount = m_movedBodies.GetCount();
+	events.sleepCount = m_sleepBodies.GetCount();
+	events.wakeCount = m_wakeBodies.GetCount();
+	return events;
+}
+
+void b2World::SetBufferContactEvents(bool flag)
+{
+	m_contactManager.m_contactEvents = flag;
+	if (flag == false)
+	{
+		m_contactManager.ClearEvents();
+	}
+}
+
+b2ContactEvents b2World::GetContactEvents() const
+{
+	const b2ContactManager* cm = &m_contactManager;
+
+	b2ContactEvents events;
+	events.beginEvents = cm->m_beginEvents.GetData();
+	events.endEvents = cm->m_endEvents.GetData();
+	events.sensorBeginEvents = cm->m_sensorBeginEvents.GetData();
+	events.sensorEndEvents = cm->m_sensorEndEvents.GetData();
+	events.hitEvents = cm->m_hitEvents.GetData();
+	events.beginCount = cm->m_beginEvents.GetCount();
+	events.endCount = cm->m_endEvents.GetCount();
+	events.sensorBeginCount = cm->m_sensorBeginEvents.GetCount();
+	events.sensorEndCount = cm->m_sensorEndEvents.GetCount();
+	events.hitCount = cm->m_hitEvents.GetCount();
+	return events;
+}
+
+void b2World::SetSpeculativeContacts(bool flag)
+{
+	if (flag == m_contactManager.m_speculativeContacts)
+	{
+		return;
+	}
+
+	m_contactManager.m_speculativeContacts = flag;
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->UpdateSpeculativeFlag(flag);
+	}
+}
+
+void b2World::SetManifoldReuseTolerance(float linearTolerance, float angularTolerance)
+{
+	b2Assert(linearTolerance >= 0.0f && angularTolerance >= 0.0f);
+	m_contactManager.m_reuseLinearTolerance = linearTolerance;
+	m_contactManager.m_reuseAngularTolerance = angularTolerance;
+}
+
+void b2World::SetTaskExecutor(b2TaskExecutor* executor)
+{
+	b2Assert(m_locked == false);
+	m_contactManager.m_taskExecutor = executor;
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -133,6 +255,16 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	b->m_index = m_bodySlots.Add(b);
+	b->m_generation = m_bodySlots.GetGeneration(b->m_index);
+
+	if (b->m_index == m_currentTransforms.GetCount())
+	{
+		m_previousTransforms.Append();
+		m_currentTransforms.Append();
+	}
+	ResetInterpolation(b);
+
 	return b;
 }
 
@@ -186,6 +318,7 @@ void b2World::DestroyBody(b2Body* b)
 		}
 
 		f0->DestroyProxies(&m_contactManager.m_broadPhase);
+		m_fixtureSlots.Remove(f0->m_id.index);
 		f0->Destroy(&m_blockAllocator);
 		f0->~b2Fixture();
 		m_blockAllocator.Free(f0, sizeof(b2Fixture));
@@ -196,6 +329,14 @@ void b2World::DestroyBody(b2Body* b)
 	b->m_fixtureList = nullptr;
 	b->m_fixtureCount = 0;
 
+	// The compound proxy went away with the last fixture.
+	if (b->m_compound)
+	{
+		b->m_compound->~b2Compound();
+		b2Free(b->m_compound);
+		b->m_compound = nullptr;
+	}
+
 	// Remove world body list.
 	if (b->m_prev)
 	{
@@ -212,6 +353,31 @@ void b2World::DestroyBody(b2Body* b)
 		m_bodyList = b->m_next;
 	}
 
+	// Remove the entry from the moved list so a new body that reuses the index is not
+	// listed in its place. The reported entries stay in front.
+	if (b->m_flags & b2Body::e_movedListedFlag)
+	{
+		int32 count = m_movedBodies.GetCount();
+		for (int32 i = 0; i < count; ++i)
+		{
+			if (m_movedBodies[i] == b->m_index)
+			{
+				if (i < m_reportedMovedCount)
+				{
+					--m_reportedMovedCount;
+					m_movedBodies[i] = m_movedBodies[m_reportedMovedCount];
+					i = m_reportedMovedCount;
+				}
+
+				m_movedBodies[i] = m_movedBodies[count - 1];
+				m_movedBodies.RemoveBack();
+				break;
+			}
+		}
+	}
+
+	m_bodySlots.Remove(b->m_index);
+
 	--m_bodyCount;
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
@@ -237,6 +403,9 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 	m_jointList = j;
 	++m_jointCount;
 
+	j->m_id.index = m_jointSlots.Add(j);
+	j->m_id.generation = m_jointSlots.GetGeneration(j->m_id.index);
+
 	// Connect to the bodies' doubly linked lists.
 	j->m_edgeA.joint = j;
 	j->m_edgeA.other = j->m_bodyB;
@@ -349,6 +518,7 @@ void b2World::DestroyJoint(b2Joint* j)
 	j->m_edgeB.prev = nullptr;
 	j->m_edgeB.next = nullptr;
 
+	m_jointSlots.Remove(j->m_id.index);
 	b2Joint::Destroy(j, &m_blockAllocator);
 
 	b2Assert(m_jointCount > 0);
@@ -390,6 +560,34 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+// Order contacts by their fixture and child indices for deterministic solving.
+static int b2CompareContacts(const void* a, const void* b)
+{
+	const b2Contact* ca = *(const b2Contact* const*)a;
+	const b2Contact* cb = *(const b2Contact* const*)b;
+
+	int32 keyA[4] = { ca->GetFixtureA()->GetId().index, ca->GetFixtureB()->GetId().index, ca->GetChildIndexA(), ca->GetChildIndexB() };
+	int32 keyB[4] = { cb->GetFixtureA()->GetId().index, cb->GetFixtureB()->GetId().index, cb->GetChildIndexA(), cb->GetChildIndexB() };
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (keyA[i] != keyB[i])
+		{
+			return keyA[i] < keyB[i] ? -1 : 1;
+		}
+	}
+
+	return 0;
+}
+
+static int b2CompareJoints(const void* a, const void* b)
+{
+	const b2Joint* ja = *(const b2Joint* const*)a;
+	const b2Joint* jb = *(const b2Joint* const*)b;
+	int32 indexA = ja->GetId().index;
+	int32 indexB = jb->GetId().index;
+	return indexA < indexB ? -1 : (indexA > indexB ? 1 : 0);
+}
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -402,7 +600,7 @@ void b2World::Solve(const b2TimeStep& step)
 					m_contactManager.m_contactCount,
 					m_jointCount,
 					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+					&m_contactManager);
 
 	// Clear all the island flags.
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
@@ -421,8 +619,35 @@ void b2World::Solve(const b2TimeStep& step)
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	b2Body* nextSeed = m_bodyList;
+	int32 nextSeedIndex = 0;
+	for (;;)
 	{
+		b2Body* seed;
+		if (m_deterministic)
+		{
+			if (nextSeedIndex == m_bodySlots.GetCapacity())
+			{
+				break;
+			}
+
+			seed = m_bodySlots.Get(nextSeedIndex++);
+			if (seed == nullptr)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			if (nextSeed == nullptr)
+			{
+				break;
+			}
+
+			seed = nextSeed;
+			nextSeed = seed->m_next;
+		}
+
 		if (seed->m_flags & b2Body::e_islandFlag)
 		{
 			continue;
@@ -461,7 +686,11 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 
 			// Make sure the body is awake (without resetting sleep timer).
-			b->m_flags |= b2Body::e_awakeFlag;
+			if ((b->m_flags & b2Body::e_awakeFlag) == 0)
+			{
+				MarkAwake(b, true);
+				b->m_flags |= b2Body::e_awakeFlag;
+			}
 
 			// Search all contacts connected to this body.
 			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
@@ -474,17 +703,11 @@ void b2World::Solve(const b2TimeStep& step)
 					continue;
 				}
 
-				// Is this contact solid and touching?
+				// Is this contact solid and touching? Speculative points are solved
+				// with the island even though the shapes are not touching yet.
+				bool speculativePoint = (contact->m_flags & b2Contact::e_speculativePointFlag) != 0;
 				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
-				{
-					continue;
-				}
-
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
+					(contact->IsTouching() == false && speculativePoint == false))
 				{
 					continue;
 				}
@@ -535,6 +758,14 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 		}
 
+		// The solver is sensitive to the constraint order, which otherwise depends on
+		// the order the contacts were created in.
+		if (m_deterministic)
+		{
+			qsort(island.m_contacts, island.m_contactCount, sizeof(b2Contact*), b2CompareContacts);
+			qsort(island.m_joints, island.m_jointCount, sizeof(b2Joint*), b2CompareJoints);
+		}
+
 		b2Profile profile;
 		island.Solve(&profile, step, m_gravity, m_allowSleep);
 		m_profile.solveInit += profile.solveInit;
@@ -558,33 +789,276 @@ void b2World::Solve(const b2TimeStep& step)
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		SynchronizeBodies();
+
+		// Look for new contacts.
+		m_contactManager.FindNewContacts();
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
+
+// Check if a contact needs continuous collision and put the body sweeps onto the
+// same time interval. The sweeps are copied into the candidate.
+bool b2World::PrepareTOI(b2Contact* c, b2TOICandidate* candidate)
+{
+	b2Fixture* fA = c->GetFixtureA();
+	b2Fixture* fB = c->GetFixtureB();
+
+	// Speculative contacts are handled by the regular solver.
+	if (c->m_flags & b2Contact::e_speculativeFlag)
+	{
+		return false;
+	}
+
+	b2Body* bA = fA->GetBody();
+	b2Body* bB = fB->GetBody();
+
+	b2BodyType typeA = bA->m_type;
+	b2BodyType typeB = bB->m_type;
+	b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
+
+	bool activeA = bA->IsAwake() && typeA != b2_staticBody;
+	bool activeB = bB->IsAwake() && typeB != b2_staticBody;
+
+	// Is at least one body active (awake and dynamic or kinematic)?
+	if (activeA == false && activeB == false)
+	{
+		return false;
+	}
+
+	bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
+	bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+
+	// Are these two non-bullet dynamic bodies?
+	if (collideA == false && collideB == false)
+	{
+		return false;
+	}
+
+	// Put the sweeps onto the same time interval.
+	float alpha0 = bA->m_sweep.alpha0;
+
+	if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
+	{
+		alpha0 = bB->m_sweep.alpha0;
+		bA->m_sweep.Advance(alpha0);
+	}
+	else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
+	{
+		alpha0 = bA->m_sweep.alpha0;
+		bB->m_sweep.Advance(alpha0);
+	}
+
+	b2Assert(alpha0 < 1.0f);
+
+	candidate->contact = c;
+	candidate->sweepA = bA->m_sweep;
+	candidate->sweepB = bB->m_sweep;
+	candidate->alpha0 = alpha0;
+	candidate->alpha = 1.0f;
+	return true;
+}
+
+// Compute the time of impact of TOI candidates. Each candidate is independent.
+static void b2ComputeTOITask(int32 startIndex, int32 endIndex, void* context)
+{
+	b2TOICandidate* candidates = (b2TOICandidate*)context;
+
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		b2TOICandidate* candidate = candidates + i;
+		b2Contact* c = candidate->contact;
+
+		// Compute the time of impact in interval [0, minTOI]
+		b2TOIInput input;
+		input.proxyA.Set(c->GetFixtureA()->GetShape(), c->GetChildIndexA());
+		input.proxyB.Set(c->GetFixtureB()->GetShape(), c->GetChildIndexB());
+		input.sweepA = candidate->sweepA;
+		input.sweepB = candidate->sweepB;
+		input.tMax = 1.0f;
+
+		b2TOIOutput output;
+		b2TimeOfImpact(&output, &input);
+
+		// Beta is the fraction of the remaining portion of the .
+		float beta = output.t;
+		if (output.state == b2TOIOutput::e_touching)
+		{
+			float alpha0 = candidate->alpha0;
+			candidate->alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+		}
+		else
+		{
+			candidate->alpha = 1.0f;
+		}
+	}
+}
+
+// Compute the TOI of a contact and queue it if it happens within the step.
+// Contacts with a valid cached TOI are queued as is.
+void b2World::QueueTOI(b2TOIQueue* queue, b2Contact* c)
+{
+	// Is this contact disabled?
+	if (c->IsEnabled() == false)
+	{
+		return;
+	}
+
+	// Prevent excessive sub-stepping.
+	if (c->m_toiCount > b2_maxSubSteps)
+	{
+		return;
+	}
+
+	if ((c->m_flags & b2Contact::e_toiFlag) == 0)
+	{
+		b2TOICandidate candidate;
+		if (PrepareTOI(c, &candidate) == false)
+		{
+			return;
+		}
+
+		b2ComputeTOITask(0, 1, &candidate);
+
+		c->m_toi = candidate.alpha;
+		c->m_flags |= b2Contact::e_toiFlag;
+	}
+
+	if (c->m_toi < 1.0f - 10.0f * b2_epsilon)
+	{
+		queue->Push(c, c->m_toi, c->m_toiOrder);
+	}
+}
+
+// Update the broad-phase after the solver moved the bodies. This does the work of
+// b2Body::SynchronizeFixtures for all of them, with the containment test of
+// b2BroadPhase::MoveProxy run over the plain proxies in one batch so that only the
+// proxies that escaped their fat AABB go back into the tree. The bodies are visited
+// in list order both times, so the move buffer sees the same order as before.
+void b2World::SynchronizeBodies()
+{
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+
+	// If a body was not in an island then it did not move.
+	int32 count = 0;
+	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	{
+		if ((b->m_flags & b2Body::e_islandFlag) == 0 || b->GetType() == b2_staticBody || b->m_compound)
+		{
+			continue;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			if (f->m_isSensor == false)
 			{
-				continue;
+				count += f->m_proxyCount;
 			}
+		}
+	}
 
-			if (b->GetType() == b2_staticBody)
+	int32* proxyIds = (int32*)m_stackAllocator.Allocate(count * sizeof(int32));
+	b2AABB* aabbs = (b2AABB*)m_stackAllocator.Allocate(count * sizeof(b2AABB));
+	b2Vec2* displacements = (b2Vec2*)m_stackAllocator.Allocate(count * sizeof(b2Vec2));
+	bool* needsMove = (bool*)m_stackAllocator.Allocate(count * sizeof(bool));
+
+	// Compute the swept bounds of the plain proxies.
+	int32 index = 0;
+	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	{
+		if ((b->m_flags & b2Body::e_islandFlag) == 0 || b->GetType() == b2_staticBody || b->m_compound)
+		{
+			continue;
+		}
+
+		b2Transform xf1, xf2;
+		b->GetSweptTransforms(&xf1, &xf2);
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (f->m_isSensor)
 			{
 				continue;
 			}
 
-			// Update fixtures (for broad-phase).
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				b2FixtureProxy* proxy = f->m_proxies + i;
+
+				b2AABB aabb1, aabb2;
+				f->m_shape->ComputeAABBs(&aabb1, &aabb2, xf1, xf2, proxy->childIndex);
+				proxy->aabb.Combine(aabb1, aabb2);
+
+				proxyIds[index] = proxy->proxyId;
+				aabbs[index] = proxy->aabb;
+				displacements[index] = aabb2.GetCenter() - aabb1.GetCenter();
+				++index;
+			}
+		}
+	}
+
+	b2Assert(index == count);
+	broadPhase->TestMoves(proxyIds, aabbs, displacements, count, needsMove);
+
+	// Move the proxies in the order b2Body::SynchronizeFixtures would.
+	index = 0;
+	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	{
+		if ((b->m_flags & b2Body::e_islandFlag) == 0 || b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		if (b->m_compound)
+		{
+			// Only the sensors of a compound body have proxies of their own.
 			b->SynchronizeFixtures();
+			MarkMoved(b);
+			continue;
 		}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+		b2Transform xf1, xf2;
+		b->GetSweptTransforms(&xf1, &xf2);
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (f->m_isSensor)
+			{
+				f->Synchronize(broadPhase, xf1, xf2);
+				continue;
+			}
+
+			bool touch = f->m_shape->m_type == b2Shape::e_mesh || f->m_shape->m_type == b2Shape::e_heightField;
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				if (needsMove[index])
+				{
+					broadPhase->MoveProxy(proxyIds[index], aabbs[index], displacements[index]);
+				}
+
+				// The children of a moving mesh or height field pair up again, see b2ContactManager::AddPair.
+				if (touch)
+				{
+					broadPhase->TouchProxy(proxyIds[index]);
+				}
+
+				++index;
+			}
+		}
+
+		MarkMoved(b);
 	}
+
+	m_stackAllocator.Free(needsMove);
+	m_stackAllocator.Free(displacements);
+	m_stackAllocator.Free(aabbs);
+	m_stackAllocator.Free(proxyIds);
 }
 
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, &m_contactManager);
 
 	if (m_stepComplete)
 	{
@@ -603,124 +1077,91 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		}
 	}
 
-	// Find TOI events and solve them.
-	for (;;)
+	// Seed the event queue. The initial TOIs do not depend on each other, so they
+	// are gathered into a candidate buffer and computed in parallel. After this only
+	// the contacts of bodies displaced by a TOI event are evaluated again.
+	b2TOIQueue queue;
+	if (m_contactManager.m_contactCount > 0)
 	{
-		// Find the first TOI.
-		b2Contact* minContact = nullptr;
-		float minAlpha = 1.0f;
+		int32 candidateCapacity = m_contactManager.m_contactCount;
+		b2TOICandidate* candidates = (b2TOICandidate*)m_stackAllocator.Allocate(candidateCapacity * sizeof(b2TOICandidate));
+		int32 candidateCount = 0;
+
+		// Number the contacts so that equal TOIs are solved in list order, the first
+		// contact first. Contacts created by the TOI events below go to the head of
+		// the list and are numbered above these.
+		uint32 order = (uint32)m_contactManager.m_contactCount;
+		m_contactManager.m_nextToiOrder = order + 1;
 
 		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
 		{
-			// Is this contact disabled?
-			if (c->IsEnabled() == false)
-			{
-				continue;
-			}
+			c->m_toiOrder = order--;
 
-			// Prevent excessive sub-stepping.
-			if (c->m_toiCount > b2_maxSubSteps)
+			if (c->IsEnabled() == false || c->m_toiCount > b2_maxSubSteps)
 			{
 				continue;
 			}
 
-			float alpha = 1.0f;
 			if (c->m_flags & b2Contact::e_toiFlag)
 			{
 				// This contact has a valid cached TOI.
-				alpha = c->m_toi;
+				QueueTOI(&queue, c);
+				continue;
 			}
-			else
+
+			b2Assert(candidateCount < candidateCapacity);
+			if (PrepareTOI(c, candidates + candidateCount))
 			{
-				b2Fixture* fA = c->GetFixtureA();
-				b2Fixture* fB = c->GetFixtureB();
+				++candidateCount;
+			}
+		}
 
-				// Is there a sensor?
-				if (fA->IsSensor() || fB->IsSensor())
-				{
-					continue;
-				}
+		b2ParallelFor(m_contactManager.m_taskExecutor, b2ComputeTOITask, candidateCount, 32, candidates);
 
-				b2Body* bA = fA->GetBody();
-				b2Body* bB = fB->GetBody();
+		for (int32 i = 0; i < candidateCount; ++i)
+		{
+			b2Contact* c = candidates[i].contact;
+			c->m_toi = candidates[i].alpha;
+			c->m_flags |= b2Contact::e_toiFlag;
 
-				b2BodyType typeA = bA->m_type;
-				b2BodyType typeB = bB->m_type;
-				b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
+			if (c->m_toi < 1.0f - 10.0f * b2_epsilon)
+			{
+				queue.Push(c, c->m_toi, c->m_toiOrder);
+			}
+		}
 
-				bool activeA = bA->IsAwake() && typeA != b2_staticBody;
-				bool activeB = bB->IsAwake() && typeB != b2_staticBody;
+		m_stackAllocator.Free(candidates);
+	}
 
-				// Is at least one body active (awake and dynamic or kinematic)?
-				if (activeA == false && activeB == false)
-				{
-					continue;
-				}
+	// Find TOI events and solve them.
+	for (;;)
+	{
+		// Find the first TOI. Events are stale if their contact was invalidated
+		// or has been given a new TOI since the event was queued.
+		b2Contact* minContact = nullptr;
+		float minAlpha = 1.0f;
 
-				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
-				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+		while (queue.GetCount() > 0)
+		{
+			b2TOIEvent event = queue.Pop();
+			b2Contact* c = event.contact;
 
-				// Are these two non-bullet dynamic bodies?
-				if (collideA == false && collideB == false)
-				{
-					continue;
-				}
-
-				// Compute the TOI for this contact.
-				// Put the sweeps onto the same time interval.
-				float alpha0 = bA->m_sweep.alpha0;
-
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
-				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
-				}
-
-				b2Assert(alpha0 < 1.0f);
-
-				int32 indexA = c->GetChildIndexA();
-				int32 indexB = c->GetChildIndexB();
-
-				// Compute the time of impact in interval [0, minTOI]
-				b2TOIInput input;
-				input.proxyA.Set(fA->GetShape(), indexA);
-				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
-				input.tMax = 1.0f;
-
-				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
-
-				// Beta is the fraction of the remaining portion of the .
-				float beta = output.t;
-				if (output.state == b2TOIOutput::e_touching)
-				{
-					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
-				}
-				else
-				{
-					alpha = 1.0f;
-				}
-
-				c->m_toi = alpha;
-				c->m_flags |= b2Contact::e_toiFlag;
+			if ((c->m_flags & b2Contact::e_toiFlag) == 0 || c->m_toi != event.alpha)
+			{
+				continue;
 			}
 
-			if (alpha < minAlpha)
+			if (c->IsEnabled() == false || c->m_toiCount > b2_maxSubSteps)
 			{
-				// This is the minimum TOI found so far.
-				minContact = c;
-				minAlpha = alpha;
+				continue;
 			}
+
+			minContact = c;
+			minAlpha = event.alpha;
+			break;
 		}
 
-		if (minContact == nullptr || 1.0f - 10.0f * b2_epsilon < minAlpha)
+		if (minContact == nullptr)
 		{
 			// No more TOI events. Done!
 			m_stepComplete = true;
@@ -740,7 +1181,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		minContact->Update(&m_contactManager);
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -804,14 +1245,6 @@ void b2World::SolveTOI(const b2TimeStep& step)
 						continue;
 					}
 
-					// Skip sensors.
-					bool sensorA = contact->m_fixtureA->m_isSensor;
-					bool sensorB = contact->m_fixtureB->m_isSensor;
-					if (sensorA || sensorB)
-					{
-						continue;
-					}
-
 					// Tentatively advance the body to the TOI.
 					b2Sweep backup = other->m_sweep;
 					if ((other->m_flags & b2Body::e_islandFlag) == 0)
@@ -820,7 +1253,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					}
 
 					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+					contact->Update(&m_contactManager);
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
@@ -882,6 +1315,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			}
 
 			body->SynchronizeFixtures();
+			MarkMoved(body);
 
 			// Invalidate all contact TOIs on this displaced body.
 			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
@@ -894,6 +1328,28 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		// Also, some contacts can be destroyed.
 		m_contactManager.FindNewContacts();
 
+		// Queue new TOI events for the displaced bodies. This includes the contacts
+		// that were just created. Bodies that were woken up may also have contacts
+		// that were previously skipped.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* body = island.m_bodies[i];
+			if (body->m_type == b2_staticBody)
+			{
+				continue;
+			}
+
+			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+			{
+				if (ce->contact->m_flags & b2Contact::e_toiFlag)
+				{
+					continue;
+				}
+
+				QueueTOI(&queue, ce->contact);
+			}
+		}
+
 		if (m_subStepping)
 		{
 			m_stepComplete = false;
@@ -906,6 +1362,34 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 {
 	b2Timer stepTimer;
 
+	// Bodies that did not move keep matching transforms.
+	for (int32 i = 0; i < m_movedBodies.GetCount(); ++i)
+	{
+		int32 index = m_movedBodies[i];
+		m_previousTransforms[index] = m_currentTransforms[index];
+	}
+
+	// The user had the chance to read the events of the last step. Bodies moved since
+	// then keep their entries, in order.
+	m_contactManager.DiscardReportedEvents();
+	int32 movedCount = 0;
+	for (int32 i = 0; i < m_movedBodies.GetCount(); ++i)
+	{
+		int32 index = m_movedBodies[i];
+		b2Body* b = m_bodySlots.Get(index);
+		if (b->m_flags & b2Body::e_movedFlag)
+		{
+			m_movedBodies[movedCount++] = index;
+		}
+		else
+		{
+			b->m_flags &= ~b2Body::e_movedListedFlag;
+		}
+	}
+	m_movedBodies.Resize(movedCount);
+	m_sleepBodies.RemoveFront(m_reportedSleepCount);
+	m_wakeBodies.RemoveFront(m_reportedWakeCount);
+
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_newContacts)
 	{
@@ -931,12 +1415,16 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+
+	m_contactManager.m_dt = dt;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
 		m_contactManager.Collide();
 		m_profile.collide = timer.GetMilliseconds();
+		m_profile.separatingAxisHits = m_contactManager.m_separatingAxisHits;
+		m_profile.manifoldReuses = m_contactManager.m_manifoldReuses;
 	}
 
 	// Integrate velocities, solve velocity constraints, and integrate positions.
@@ -947,14 +1435,21 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 		m_profile.solve = timer.GetMilliseconds();
 	}
 
-	// Handle TOI events.
-	if (m_continuousPhysics && step.dt > 0.0f)
+	// Handle TOI events. Speculative contacts replace TOI events for the whole world.
+	if (m_continuousPhysics && m_contactManager.m_speculativeContacts == false && step.dt > 0.0f)
 	{
 		b2Timer timer;
 		SolveTOI(step);
 		m_profile.solveTOI = timer.GetMilliseconds();
 	}
 
+	// Report sensor overlaps at the final positions.
+	{
+		b2Timer timer;
+		m_contactManager.m_sensorManager.Update();
+		m_profile.sensors = timer.GetMilliseconds();
+	}
+
 	if (step.dt > 0.0f)
 	{
 		m_inv_dt0 = step.inv_dt;
@@ -965,6 +1460,22 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 		ClearForces();
 	}
 
+	m_contactManager.MarkEventsReported();
+
+	// Bodies moved after this point stay listed for the next step.
+	m_reportedMovedCount = m_movedBodies.GetCount();
+	m_reportedSleepCount = m_sleepBodies.GetCount();
+	m_reportedWakeCount = m_wakeBodies.GetCount();
+	for (int32 i = 0; i < m_reportedMovedCount; ++i)
+	{
+		b2Body* b = m_bodySlots.Get(m_movedBodies[i]);
+		if (b != nullptr)
+		{
+			b->m_flags &= ~b2Body::e_movedFlag;
+			m_currentTransforms[b->m_index] = b->m_xf;
+		}
+	}
+
 	m_locked = false;
 
 	m_profile.step = stepTimer.GetMilliseconds();
@@ -979,218 +1490,1429 @@ void b2World::ClearForces()
 	}
 }
 
+// The broad-phase and the sensor tree both store fixture proxies as user data.
+template <typename T>
 struct b2WorldQueryWrapper
 {
 	bool QueryCallback(int32 proxyId)
 	{
-		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
-		return callback->ReportFixture(proxy->fixture);
+		b2FixtureProxy* proxy = (b2FixtureProxy*)tree->GetUserData(proxyId);
+		if (proxy->fixture == nullptr)
+		{
+			// Query the fixtures of a compound body.
+			const b2Compound* compound = (const b2Compound*)proxy;
+			b2WorldQueryWrapper<b2DynamicTree> wrapper;
+			wrapper.tree = &compound->m_tree;
+			wrapper.callback = callback;
+			wrapper.aabb = aabb;
+			wrapper.terminated = false;
+			compound->Query(&wrapper, aabb);
+			terminated = wrapper.terminated;
+			return terminated == false;
+		}
+
+		terminated = callback->ReportFixture(proxy->fixture) == false;
+		return terminated == false;
 	}
 
-	const b2BroadPhase* broadPhase;
+	const T* tree;
 	b2QueryCallback* callback;
+	b2AABB aabb;
+	bool terminated;
 };
 
 void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
 {
-	b2WorldQueryWrapper wrapper;
-	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	b2WorldQueryWrapper<b2BroadPhase> wrapper;
+	wrapper.tree = &m_contactManager.m_broadPhase;
 	wrapper.callback = callback;
+	wrapper.aabb = aabb;
+	wrapper.terminated = false;
 	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
+
+	if (wrapper.terminated)
+	{
+		return;
+	}
+
+	b2WorldQueryWrapper<b2DynamicTree> sensorWrapper;
+	sensorWrapper.tree = &m_contactManager.m_sensorManager.m_tree;
+	sensorWrapper.callback = callback;
+	sensorWrapper.aabb = aabb;
+	sensorWrapper.terminated = false;
+	m_contactManager.m_sensorManager.m_tree.Query(&sensorWrapper, aabb);
 }
 
+template <typename T>
 struct b2WorldRayCastWrapper
 {
 	float RayCastCallback(const b2RayCastInput& input, int32 proxyId)
 	{
-		void* userData = broadPhase->GetUserData(proxyId);
+		void* userData = tree->GetUserData(proxyId);
 		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
 		b2Fixture* fixture = proxy->fixture;
+		if (fixture == nullptr)
+		{
+			// Cast against the fixtures of a compound body in body coordinates. The
+			// fraction is the same in both frames.
+			const b2Compound* compound = (const b2Compound*)proxy;
+			const b2Transform& xf = compound->m_body->GetTransform();
+			b2WorldRayCastWrapper<b2DynamicTree> wrapper;
+			wrapper.tree = &compound->m_tree;
+			wrapper.callback = callback;
+			wrapper.worldInput = &input;
+			wrapper.maxFraction = input.maxFraction;
+			b2RayCastInput localInput;
+			localInput.p1 = b2MulT(xf, input.p1);
+			localInput.p2 = b2MulT(xf, input.p2);
+			localInput.maxFraction = input.maxFraction;
+			compound->m_tree.RayCast(&wrapper, localInput);
+			maxFraction = wrapper.maxFraction;
+			return maxFraction;
+		}
+
+		// Fixtures cast the ray in world coordinates.
+		b2RayCastInput fixtureInput = input;
+		if (worldInput)
+		{
+			fixtureInput.p1 = worldInput->p1;
+			fixtureInput.p2 = worldInput->p2;
+		}
+
 		int32 index = proxy->childIndex;
 		b2RayCastOutput output;
-		bool hit = fixture->RayCast(&output, input, index);
+		bool hit = fixture->RayCast(&output, fixtureInput, index);
 
 		if (hit)
 		{
 			float fraction = output.fraction;
-			b2Vec2 point = (1.0f - fraction) * input.p1 + fraction * input.p2;
-			return callback->ReportFixture(fixture, point, output.normal, fraction);
+			b2Vec2 point = (1.0f - fraction) * fixtureInput.p1 + fraction * fixtureInput.p2;
+			float value = callback->ReportFixture(fixture, point, output.normal, fraction);
+
+			// Track the clipping like the tree does, so the next tree starts from it.
+			if (value >= 0.0f)
+			{
+				maxFraction = value;
+			}
+
+			return value;
 		}
 
 		return input.maxFraction;
 	}
 
-	const b2BroadPhase* broadPhase;
+	const T* tree;
 	b2RayCastCallback* callback;
+
+	// The world ray when the tree is in body coordinates, otherwise null.
+	const b2RayCastInput* worldInput;
+	float maxFraction;
 };
 
 void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const
 {
-	b2WorldRayCastWrapper wrapper;
-	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	b2WorldRayCastWrapper<b2BroadPhase> wrapper;
+	wrapper.tree = &m_contactManager.m_broadPhase;
 	wrapper.callback = callback;
+	wrapper.worldInput = nullptr;
+	wrapper.maxFraction = 1.0f;
 	b2RayCastInput input;
 	input.maxFraction = 1.0f;
 	input.p1 = point1;
 	input.p2 = point2;
 	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
+
+	if (wrapper.maxFraction == 0.0f)
+	{
+		return;
+	}
+
+	b2WorldRayCastWrapper<b2DynamicTree> sensorWrapper;
+	sensorWrapper.tree = &m_contactManager.m_sensorManager.m_tree;
+	sensorWrapper.callback = callback;
+	sensorWrapper.worldInput = nullptr;
+	sensorWrapper.maxFraction = wrapper.maxFraction;
+	input.maxFraction = wrapper.maxFraction;
+	m_contactManager.m_sensorManager.m_tree.RayCast(&sensorWrapper, input);
 }
 
-void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
+int32 b2World::ExportTransforms(void* buffer, int32 stride, int32 capacity, uint32 flags) const
 {
-	switch (fixture->GetType())
+	int32 size = (flags & b2_exportVelocities) ? int32(sizeof(b2BodyExport)) : b2_exportTransformSize;
+	b2Assert(stride >= size);
+
+	bool movedOnly = (flags & b2_exportMovedOnly) != 0;
+	int32 n = movedOnly ? m_movedBodies.GetCount() : m_bodySlots.GetCapacity();
+
+	char* p = (char*)buffer;
+	int32 count = 0;
+	for (int32 i = 0; i < n && count < capacity; ++i)
 	{
-	case b2Shape::e_circle:
+		int32 index = movedOnly ? m_movedBodies[i] : i;
+		const b2Body* b = m_bodySlots.Get(index);
+		if (b == nullptr)
 		{
-			b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+			continue;
+		}
 
-			b2Vec2 center = b2Mul(xf, circle->m_p);
-			float radius = circle->m_radius;
-			b2Vec2 axis = b2Mul(xf.q, b2Vec2(1.0f, 0.0f));
+		b2BodyExport record;
+		record.index = index;
+		record.position = b->m_xf.p;
+		record.rotation = b->m_xf.q;
+		record.linearVelocity = b->m_linearVelocity;
+		record.angularVelocity = b->m_angularVelocity;
+		memcpy(p, &record, size);
 
-			m_debugDraw->DrawSolidCircle(center, radius, axis, color);
-		}
-		break;
+		p += stride;
+		++count;
+	}
 
-	case b2Shape::e_edge:
-		{
-			b2EdgeShape* edge = (b2EdgeShape*)fixture->GetShape();
-			b2Vec2 v1 = b2Mul(xf, edge->m_vertex1);
-			b2Vec2 v2 = b2Mul(xf, edge->m_vertex2);
-			m_debugDraw->DrawSegment(v1, v2, color);
+	return count;
+}
 
-			if (edge->m_oneSided == false)
-			{
-				m_debugDraw->DrawPoint(v1, 4.0f, color);
-				m_debugDraw->DrawPoint(v2, 4.0f, color);
-			}
-		}
-		break;
+// FNV-1a over the bytes of a value.
+static uint32 b2HashBytes(uint32 hash, const void* data, int32 size)
+{
+	const uint8* bytes = (const uint8*)data;
+	for (int32 i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
 
-	case b2Shape::e_chain:
+uint32 b2World::GetStateHash() const
+{
+	uint32 hash = 2166136261u;
+	int32 capacity = m_bodySlots.GetCapacity();
+	for (int32 i = 0; i < capacity; ++i)
+	{
+		const b2Body* b = m_bodySlots.Get(i);
+		if (b == nullptr)
 		{
-			b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
-			int32 count = chain->m_count;
-			const b2Vec2* vertices = chain->m_vertices;
-
-			b2Vec2 v1 = b2Mul(xf, vertices[0]);
-			for (int32 i = 1; i < count; ++i)
-			{
-				b2Vec2 v2 = b2Mul(xf, vertices[i]);
-				m_debugDraw->DrawSegment(v1, v2, color);
-				v1 = v2;
-			}
+			continue;
 		}
-		break;
 
-	case b2Shape::e_polygon:
-		{
-			b2PolygonShape* poly = (b2PolygonShape*)fixture->GetShape();
-			int32 vertexCount = poly->m_count;
-			b2Assert(vertexCount <= b2_maxPolygonVertices);
-			b2Vec2 vertices[b2_maxPolygonVertices];
+		uint32 awake = b->IsAwake() ? 1 : 0;
+		hash = b2HashBytes(hash, &i, sizeof(i));
+		hash = b2HashBytes(hash, &b->m_sweep.c, sizeof(b->m_sweep.c));
+		hash = b2HashBytes(hash, &b->m_sweep.a, sizeof(b->m_sweep.a));
+		hash = b2HashBytes(hash, &b->m_linearVelocity, sizeof(b->m_linearVelocity));
+		hash = b2HashBytes(hash, &b->m_angularVelocity, sizeof(b->m_angularVelocity));
+		hash = b2HashBytes(hash, &awake, sizeof(awake));
+	}
 
-			for (int32 i = 0; i < vertexCount; ++i)
-			{
-				vertices[i] = b2Mul(xf, poly->m_vertices[i]);
-			}
+	return hash;
+}
 
-			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
-		}
-		break;
+uint32 b2World::GetTopologyHash() const
+{
+	uint32 hash = 2166136261u;
+	for (int32 i = 0; i < m_bodySlots.GetCapacity(); ++i)
+	{
+		const b2Body* b = m_bodySlots.Get(i);
+		int32 type = b ? int32(b->m_type) : -1;
+		int32 enabled = b ? int32(b->IsEnabled()) : -1;
+		uint32 generation = m_bodySlots.GetGeneration(i);
+		hash = b2HashBytes(hash, &type, sizeof(type));
+		hash = b2HashBytes(hash, &enabled, sizeof(enabled));
+		hash = b2HashBytes(hash, &generation, sizeof(generation));
+	}
 
-	default:
-	break;
+	// The proxy count sets the number of proxy records of a fixture.
+	for (int32 i = 0; i < m_fixtureSlots.GetCapacity(); ++i)
+	{
+		const b2Fixture* f = m_fixtureSlots.Get(i);
+		int32 sensor = f ? int32(f->m_isSensor) : -1;
+		int32 proxyCount = f ? f->m_proxyCount : -1;
+		uint32 generation = m_fixtureSlots.GetGeneration(i);
+		hash = b2HashBytes(hash, &sensor, sizeof(sensor));
+		hash = b2HashBytes(hash, &proxyCount, sizeof(proxyCount));
+		hash = b2HashBytes(hash, &generation, sizeof(generation));
+	}
+
+	for (int32 i = 0; i < m_jointSlots.GetCapacity(); ++i)
+	{
+		const b2Joint* j = m_jointSlots.Get(i);
+		int32 type = j ? int32(j->m_type) : -1;
+		uint32 generation = m_jointSlots.GetGeneration(i);
+		hash = b2HashBytes(hash, &type, sizeof(type));
+		hash = b2HashBytes(hash, &generation, sizeof(generation));
 	}
+
+	return hash;
 }
 
-void b2World::DebugDraw()
+#define b2_snapshotMagic 0x32534e50u
+#define b2_snapshotVersion 5u
+
+struct b2SnapshotHeader
 {
-	if (m_debugDraw == nullptr)
+	uint32 magic;
+	uint32 version;
+	int32 size;
+	uint32 topology;
+	int32 bodyCapacity;
+	int32 fixtureCapacity;
+	int32 jointCapacity;
+	int32 contactCount;
+	int32 sensorCount;
+	int32 movedCount;
+	int32 sleepCount;
+	int32 wakeCount;
+	int32 reportedMovedCount;
+	int32 reportedSleepCount;
+	int32 reportedWakeCount;
+	float inv_dt0;
+	uint8 newContacts;
+	uint8 stepComplete;
+	uint8 refilter;
+};
+
+struct b2BodySnapshot
+{
+	b2Transform xf;
+	b2Sweep sweep;
+	b2Vec2 linearVelocity;
+	float angularVelocity;
+	b2Vec2 force;
+	float torque;
+	float sleepTime;
+	b2Transform previousTransform;
+	b2Transform currentTransform;
+	uint16 flags;
+};
+
+struct b2ProxySnapshot
+{
+	b2AABB aabb;
+	int32 proxyId;
+	int32 sensorIndex;
+};
+
+// The fixture trees of compound bodies only change with their fixtures.
+struct b2CompoundSnapshot
+{
+	b2AABB aabb;
+	int32 proxyId;
+	b2Transform transform1;
+	b2Transform transform2;
+};
+
+// Fixtures are stored by index. The fixtures of a contact may be swapped
+// with respect to the broad-phase pair, so the order is kept as well.
+struct b2ContactSnapshot
+{
+	int32 fixtureA;
+	int32 fixtureB;
+	int32 indexA;
+	int32 indexB;
+	uint32 flags;
+	b2Manifold manifold;
+	int32 toiCount;
+	float toi;
+	float friction;
+	float restitution;
+	float restitutionThreshold;
+	float tangentSpeed;
+	b2SeparatingAxisCache axisCache;
+	b2Transform relativeTransform;
+};
+
+static bool b2IsPolygonContact(const b2Contact* c)
+{
+	return c->GetFixtureA()->GetType() == b2Shape::e_polygon && c->GetFixtureB()->GetType() == b2Shape::e_polygon;
+}
+
+struct b2OverlapSnapshot
+{
+	int32 fixture;
+	int32 childIndex;
+	int32 proxyId;
+	int32 childId;
+};
+
+// Writes the snapshot, or only adds up its size once the buffer is full.
+struct b2SnapshotWriter
+{
+	char* Reserve(int32 size)
 	{
-		return;
+		char* p = count + size <= capacity ? buffer + count : nullptr;
+		count += size;
+		return p;
 	}
 
-	uint32 flags = m_debugDraw->GetFlags();
+	void Write(const void* data, int32 size)
+	{
+		char* p = Reserve(size);
+		if (p && size > 0)
+		{
+			memcpy(p, data, size);
+		}
+	}
 
-	if (flags & b2Draw::e_shapeBit)
+	char* buffer;
+	int32 capacity;
+	int32 count;
+};
+
+// Reads never leave the buffer. Skip returns nullptr if there are not enough bytes
+// left, and Read returns false without touching the data.
+struct b2SnapshotReader
+{
+	const char* Skip(int32 size)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		if (size < 0 || size > capacity - count)
 		{
-			const b2Transform& xf = b->GetTransform();
-			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
-			{
-				if (b->GetType() == b2_dynamicBody && b->m_mass == 0.0f)
-				{
-					// Bad body
-					DrawShape(f, xf, b2Color(1.0f, 0.0f, 0.0f));
-				}
-				else if (b->IsEnabled() == false)
-				{
-					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.3f));
-				}
-				else if (b->GetType() == b2_staticBody)
-				{
-					DrawShape(f, xf, b2Color(0.5f, 0.9f, 0.5f));
-				}
-				else if (b->GetType() == b2_kinematicBody)
-				{
-					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.9f));
-				}
-				else if (b->IsAwake() == false)
-				{
-					DrawShape(f, xf, b2Color(0.6f, 0.6f, 0.6f));
-				}
-				else
-				{
-					DrawShape(f, xf, b2Color(0.9f, 0.7f, 0.7f));
-				}
-			}
+			return nullptr;
 		}
+
+		const char* p = buffer + count;
+		count += size;
+		return p;
 	}
 
-	if (flags & b2Draw::e_jointBit)
+	bool Read(void* data, int32 size)
 	{
-		for (b2Joint* j = m_jointList; j; j = j->GetNext())
+		const char* p = Skip(size);
+		if (p == nullptr)
 		{
-			j->Draw(m_debugDraw);
+			return false;
 		}
+
+		memcpy(data, p, size);
+		return true;
 	}
 
-	if (flags & b2Draw::e_pairBit)
+	const char* buffer;
+	int32 capacity;
+	int32 count;
+};
+
+int32 b2World::SaveSnapshot(void* buffer, int32 capacity) const
+{
+	b2SnapshotWriter writer;
+	writer.buffer = (char*)buffer;
+	writer.capacity = buffer ? capacity : 0;
+	writer.count = 0;
+
+	const b2SensorManager& sensorManager = m_contactManager.m_sensorManager;
+
+	// The size is only known at the end, it is patched in below.
+	b2SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = b2_snapshotMagic;
+	header.version = b2_snapshotVersion;
+	header.topology = GetTopologyHash();
+	header.bodyCapacity = m_bodySlots.GetCapacity();
+	header.fixtureCapacity = m_fixtureSlots.GetCapacity();
+	header.jointCapacity = m_jointSlots.GetCapacity();
+	header.contactCount = m_contactManager.m_contactCount;
+	header.sensorCount = sensorManager.m_sensorCount;
+	header.movedCount = m_movedBodies.GetCount();
+	header.sleepCount = m_sleepBodies.GetCount();
+	header.wakeCount = m_wakeBodies.GetCount();
+	header.reportedMovedCount = m_reportedMovedCount;
+	header.reportedSleepCount = m_reportedSleepCount;
+	header.reportedWakeCount = m_reportedWakeCount;
+	header.inv_dt0 = m_inv_dt0;
+	header.newContacts = m_newContacts;
+	header.stepComplete = m_stepComplete;
+	header.refilter = sensorManager.m_refilter;
+	char* headerData = writer.Reserve(sizeof(header));
+
+	for (int32 i = 0; i < header.bodyCapacity; ++i)
 	{
-		b2Color color(0.3f, 0.9f, 0.9f);
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->GetNext())
+		const b2Body* b = m_bodySlots.Get(i);
+		if (b == nullptr)
 		{
-			b2Fixture* fixtureA = c->GetFixtureA();
-			b2Fixture* fixtureB = c->GetFixtureB();
-			int32 indexA = c->GetChildIndexA();
-			int32 indexB = c->GetChildIndexB();
-			b2Vec2 cA = fixtureA->GetAABB(indexA).GetCenter();
-			b2Vec2 cB = fixtureB->GetAABB(indexB).GetCenter();
+			continue;
+		}
 
-			m_debugDraw->DrawSegment(cA, cB, color);
+		b2BodySnapshot record;
+		memset(&record, 0, sizeof(record));
+		record.xf = b->m_xf;
+		record.sweep = b->m_sweep;
+		record.linearVelocity = b->m_linearVelocity;
+		record.angularVelocity = b->m_angularVelocity;
+		record.force = b->m_force;
+		record.torque = b->m_torque;
+		record.sleepTime = b->m_sleepTime;
+		record.previousTransform = m_previousTransforms[i];
+		record.currentTransform = m_currentTransforms[i];
+		record.flags = b->m_flags;
+		writer.Write(&record, sizeof(record));
+
+		if (b->m_compound)
+		{
+			b2CompoundSnapshot compoundRecord;
+			compoundRecord.aabb = b->m_compound->m_proxy.aabb;
+			compoundRecord.proxyId = b->m_compound->m_proxy.proxyId;
+			compoundRecord.transform1 = b->m_compound->m_transform1;
+			compoundRecord.transform2 = b->m_compound->m_transform2;
+			writer.Write(&compoundRecord, sizeof(compoundRecord));
 		}
 	}
 
-	if (flags & b2Draw::e_aabbBit)
+	writer.Write(m_movedBodies.GetData(), header.movedCount * sizeof(int32));
+	writer.Write(m_sleepBodies.GetData(), header.sleepCount * sizeof(int32));
+	writer.Write(m_wakeBodies.GetData(), header.wakeCount * sizeof(int32));
+
+	for (int32 i = 0; i < header.fixtureCapacity; ++i)
 	{
-		b2Color color(0.9f, 0.3f, 0.9f);
-		b2BroadPhase* bp = &m_contactManager.m_broadPhase;
+		const b2Fixture* f = m_fixtureSlots.Get(i);
+		if (f == nullptr)
+		{
+			continue;
+		}
 
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		writer.Write(&f->m_sensorOverlapCount, sizeof(int32));
+		for (int32 j = 0; j < f->m_proxyCount; ++j)
 		{
-			if (b->IsEnabled() == false)
-			{
+			const b2FixtureProxy* proxy = f->m_proxies + j;
+			b2ProxySnapshot record;
+			record.aabb = proxy->aabb;
+			record.proxyId = proxy->proxyId;
+			record.sensorIndex = proxy->sensorIndex;
+			writer.Write(&record, sizeof(record));
+		}
+	}
+
+	for (int32 i = 0; i < header.jointCapacity; ++i)
+	{
+		const b2Joint* j = m_jointSlots.Get(i);
+		if (j == nullptr)
+		{
+			continue;
+		}
+
+		char* jointData = writer.Reserve(j->GetStateSize());
+		if (jointData)
+		{
+			j->SaveState(jointData);
+		}
+	}
+
+	// Contacts are stored in list order, newest first.
+	for (const b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		b2ContactSnapshot record;
+		memset(&record, 0, sizeof(record));
+		record.fixtureA = c->m_fixtureA->m_id.index;
+		record.fixtureB = c->m_fixtureB->m_id.index;
+		record.indexA = c->m_indexA;
+		record.indexB = c->m_indexB;
+		record.flags = c->m_flags;
+		record.manifold = c->m_manifold;
+		record.toiCount = c->m_toiCount;
+		record.toi = c->m_toi;
+		record.friction = c->m_friction;
+		record.restitution = c->m_restitution;
+		record.restitutionThreshold = c->m_restitutionThreshold;
+		record.tangentSpeed = c->m_tangentSpeed;
+		if (b2IsPolygonContact(c))
+		{
+			const b2PolygonContact* pc = (const b2PolygonContact*)c;
+			record.axisCache = pc->m_axisCache;
+			record.relativeTransform = pc->m_relativeTransform;
+		}
+		writer.Write(&record, sizeof(record));
+	}
+
+	const b2BroadPhase& broadPhase = m_contactManager.m_broadPhase;
+	char* broadPhaseData = writer.Reserve(broadPhase.GetStateSize());
+	if (broadPhaseData)
+	{
+		broadPhase.SaveState(broadPhaseData);
+	}
+
+	char* sensorTreeData = writer.Reserve(sensorManager.m_tree.GetStateSize());
+	if (sensorTreeData)
+	{
+		sensorManager.m_tree.SaveState(sensorTreeData);
+	}
+
+	for (int32 i = 0; i < header.sensorCount; ++i)
+	{
+		const b2Sensor* sensor = sensorManager.m_sensors + i;
+		writer.Write(&sensor->overlapCount, sizeof(int32));
+		for (int32 j = 0; j < sensor->overlapCount; ++j)
+		{
+			const b2SensorOverlap* overlap = sensor->overlaps + j;
+			const b2Fixture* visitor = overlap->proxy->fixture;
+			b2OverlapSnapshot record;
+			record.fixture = visitor->m_id.index;
+			record.childIndex = int32(overlap->proxy - visitor->m_proxies);
+			record.proxyId = overlap->proxyId;
+			record.childId = overlap->childId;
+			writer.Write(&record, sizeof(record));
+		}
+	}
+
+	header.size = writer.count;
+	if (headerData && writer.count <= writer.capacity)
+	{
+		memcpy(headerData, &header, sizeof(header));
+	}
+
+	return writer.count;
+}
+
+// Mesh segments and height field cells pair up with a single proxy, so their
+// contacts have more child indices than the shape has children.
+static int32 b2GetContactChildCount(const b2Shape* shape)
+{
+	switch (shape->GetType())
+	{
+	case b2Shape::e_mesh:
+		return ((const b2MeshShape*)shape)->GetSegmentCount();
+
+	case b2Shape::e_heightField:
+		return ((const b2HeightFieldShape*)shape)->GetCellCount();
+
+	default:
+		return shape->GetChildCount();
+	}
+}
+
+static bool b2ReadBodyIndices(b2SnapshotReader* reader, int32 count, const b2SlotArray<b2Body>& bodies)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 index;
+		if (reader->Read(&index, sizeof(index)) == false || bodies.Find(index) == nullptr)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Walk a snapshot the way RestoreSnapshot reads it, without changing the world.
+// Once this passes, every read of the restore stays inside the buffer and every
+// body, fixture and proxy index in the snapshot is live.
+bool b2World::CheckSnapshot(const void* buffer, int32 size) const
+{
+	if (buffer == nullptr || size < int32(sizeof(b2SnapshotHeader)))
+	{
+		return false;
+	}
+
+	b2SnapshotReader reader;
+	reader.buffer = (const char*)buffer;
+	reader.capacity = size;
+	reader.count = 0;
+
+	b2SnapshotHeader header;
+	reader.Read(&header, sizeof(header));
+
+	const b2SensorManager& sensorManager = m_contactManager.m_sensorManager;
+
+	if (header.magic != b2_snapshotMagic || header.version != b2_snapshotVersion || header.size != size ||
+		header.bodyCapacity != m_bodySlots.GetCapacity() ||
+		header.fixtureCapacity != m_fixtureSlots.GetCapacity() ||
+		header.jointCapacity != m_jointSlots.GetCapacity() ||
+		header.sensorCount != sensorManager.m_sensorCount ||
+		header.topology != GetTopologyHash())
+	{
+		return false;
+	}
+
+	if (header.contactCount < 0 ||
+		header.reportedMovedCount < 0 || header.reportedMovedCount > header.movedCount ||
+		header.reportedSleepCount < 0 || header.reportedSleepCount > header.sleepCount ||
+		header.reportedWakeCount < 0 || header.reportedWakeCount > header.wakeCount)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < header.bodyCapacity; ++i)
+	{
+		const b2Body* b = m_bodySlots.Get(i);
+		if (b == nullptr)
+		{
+			continue;
+		}
+
+		if (reader.Skip(sizeof(b2BodySnapshot)) == nullptr)
+		{
+			return false;
+		}
+
+		if (b->m_compound && reader.Skip(sizeof(b2CompoundSnapshot)) == nullptr)
+		{
+			return false;
+		}
+	}
+
+	if (b2ReadBodyIndices(&reader, header.movedCount, m_bodySlots) == false ||
+		b2ReadBodyIndices(&reader, header.sleepCount, m_bodySlots) == false ||
+		b2ReadBodyIndices(&reader, header.wakeCount, m_bodySlots) == false)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < header.fixtureCapacity; ++i)
+	{
+		const b2Fixture* f = m_fixtureSlots.Get(i);
+		if (f == nullptr)
+		{
+			continue;
+		}
+
+		if (reader.Skip(sizeof(int32)) == nullptr || reader.Skip(f->m_proxyCount * sizeof(b2ProxySnapshot)) == nullptr)
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < header.jointCapacity; ++i)
+	{
+		const b2Joint* j = m_jointSlots.Get(i);
+		if (j != nullptr && reader.Skip(j->GetStateSize()) == nullptr)
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < header.contactCount; ++i)
+	{
+		b2ContactSnapshot record;
+		if (reader.Read(&record, sizeof(record)) == false)
+		{
+			return false;
+		}
+
+		const b2Fixture* fixtureA = m_fixtureSlots.Find(record.fixtureA);
+		const b2Fixture* fixtureB = m_fixtureSlots.Find(record.fixtureB);
+		if (fixtureA == nullptr || fixtureB == nullptr ||
+			record.indexA < 0 || record.indexA >= b2GetContactChildCount(fixtureA->GetShape()) ||
+			record.indexB < 0 || record.indexB >= b2GetContactChildCount(fixtureB->GetShape()) ||
+			record.manifold.pointCount < 0 || record.manifold.pointCount > b2_maxManifoldPoints)
+		{
+			return false;
+		}
+
+		if (fixtureA->GetType() == b2Shape::e_polygon && fixtureB->GetType() == b2Shape::e_polygon)
+		{
+			const b2SeparatingAxisCache& cache = record.axisCache;
+			const b2Fixture* owner = cache.type == b2SeparatingAxisCache::e_edgeB ? fixtureB : fixtureA;
+			const b2PolygonShape* polygon = (const b2PolygonShape*)owner->GetShape();
+			if (cache.type > b2SeparatingAxisCache::e_edgeB ||
+				(cache.type != b2SeparatingAxisCache::e_empty && cache.edge >= polygon->m_count))
+			{
+				return false;
+			}
+		}
+	}
+
+	int32 broadPhaseSize = b2BroadPhase::ReadStateSize(reader.buffer + reader.count, reader.capacity - reader.count);
+	if (broadPhaseSize == 0 || reader.Skip(broadPhaseSize) == nullptr)
+	{
+		return false;
+	}
+
+	int32 sensorTreeSize = b2DynamicTree::ReadStateSize(reader.buffer + reader.count, reader.capacity - reader.count);
+	if (sensorTreeSize == 0 || reader.Skip(sensorTreeSize) == nullptr)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < header.sensorCount; ++i)
+	{
+		int32 overlapCount;
+		if (reader.Read(&overlapCount, sizeof(int32)) == false)
+		{
+			return false;
+		}
+
+		for (int32 j = 0; j < overlapCount; ++j)
+		{
+			b2OverlapSnapshot record;
+			if (reader.Read(&record, sizeof(record)) == false)
+			{
+				return false;
+			}
+
+			const b2Fixture* f = m_fixtureSlots.Find(record.fixture);
+			if (f == nullptr || record.childIndex < 0 || record.childIndex >= f->m_proxyCount)
+			{
+				return false;
+			}
+		}
+	}
+
+	return reader.count == size;
+}
+
+bool b2World::RestoreSnapshot(const void* buffer, int32 size)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return false;
+	}
+
+	if (CheckSnapshot(buffer, size) == false)
+	{
+		return false;
+	}
+
+	b2SnapshotReader reader;
+	reader.buffer = (const char*)buffer;
+	reader.capacity = size;
+	reader.count = 0;
+
+	b2SnapshotHeader header;
+	reader.Read(&header, sizeof(header));
+
+	b2SensorManager& sensorManager = m_contactManager.m_sensorManager;
+
+	// Drop the current contacts without telling anyone. Contacts that are
+	// touching wake their bodies, which the body state below overwrites.
+	b2Contact* c = m_contactManager.m_contactList;
+	while (c)
+	{
+		b2Contact* next = c->m_next;
+		b2Contact::Destroy(c, &m_blockAllocator);
+		c = next;
+	}
+
+	m_contactManager.m_contactList = nullptr;
+	m_contactManager.m_contactCount = 0;
+
+	for (int32 i = 0; i < header.bodyCapacity; ++i)
+	{
+		b2Body* b = m_bodySlots.Get(i);
+		if (b == nullptr)
+		{
+			continue;
+		}
+
+		b2BodySnapshot record;
+		reader.Read(&record, sizeof(record));
+		b->m_xf = record.xf;
+		b->m_sweep = record.sweep;
+		b->m_linearVelocity = record.linearVelocity;
+		b->m_angularVelocity = record.angularVelocity;
+		b->m_force = record.force;
+		b->m_torque = record.torque;
+		b->m_sleepTime = record.sleepTime;
+		// The enabled flag is part of the topology, it already matches.
+		b->m_flags = (record.flags & ~b2Body::e_enabledFlag) | (b->m_flags & b2Body::e_enabledFlag);
+		b->m_contactList = nullptr;
+		m_previousTransforms[i] = record.previousTransform;
+		m_currentTransforms[i] = record.currentTransform;
+
+		if (b->m_compound)
+		{
+			b2CompoundSnapshot compoundRecord;
+			reader.Read(&compoundRecord, sizeof(compoundRecord));
+			b->m_compound->m_proxy.aabb = compoundRecord.aabb;
+			b->m_compound->m_proxy.proxyId = compoundRecord.proxyId;
+			b->m_compound->m_transform1 = compoundRecord.transform1;
+			b->m_compound->m_transform2 = compoundRecord.transform2;
+		}
+	}
+
+	m_movedBodies.Clear();
+	for (int32 i = 0; i < header.movedCount; ++i)
+	{
+		reader.Read(&m_movedBodies.Append(), sizeof(int32));
+	}
+
+	m_sleepBodies.Clear();
+	for (int32 i = 0; i < header.sleepCount; ++i)
+	{
+		reader.Read(&m_sleepBodies.Append(), sizeof(int32));
+	}
+
+	m_wakeBodies.Clear();
+	for (int32 i = 0; i < header.wakeCount; ++i)
+	{
+		reader.Read(&m_wakeBodies.Append(), sizeof(int32));
+	}
+
+	m_reportedMovedCount = header.reportedMovedCount;
+	m_reportedSleepCount = header.reportedSleepCount;
+	m_reportedWakeCount = header.reportedWakeCount;
+
+	for (int32 i = 0; i < header.fixtureCapacity; ++i)
+	{
+		b2Fixture* f = m_fixtureSlots.Get(i);
+		if (f == nullptr)
+		{
+			continue;
+		}
+
+		reader.Read(&f->m_sensorOverlapCount, sizeof(int32));
+		for (int32 j = 0; j < f->m_proxyCount; ++j)
+		{
+			b2FixtureProxy* proxy = f->m_proxies + j;
+			b2ProxySnapshot record;
+			reader.Read(&record, sizeof(record));
+			proxy->aabb = record.aabb;
+			proxy->proxyId = record.proxyId;
+			proxy->sensorIndex = record.sensorIndex;
+		}
+	}
+
+	for (int32 i = 0; i < header.jointCapacity; ++i)
+	{
+		b2Joint* j = m_jointSlots.Get(i);
+		if (j == nullptr)
+		{
+			continue;
+		}
+
+		j->RestoreState(reader.Skip(j->GetStateSize()));
+	}
+
+	// Recreating the contacts oldest first rebuilds the world and body lists in
+	// their saved order.
+	const char* contactData = reader.Skip(header.contactCount * sizeof(b2ContactSnapshot));
+	for (int32 i = header.contactCount - 1; i >= 0; --i)
+	{
+		b2ContactSnapshot record;
+		memcpy(&record, contactData + i * sizeof(b2ContactSnapshot), sizeof(record));
+
+		b2Fixture* fixtureA = m_fixtureSlots.Get(record.fixtureA);
+		b2Fixture* fixtureB = m_fixtureSlots.Get(record.fixtureB);
+		c = b2Contact::Create(fixtureA, record.indexA, fixtureB, record.indexB, &m_blockAllocator);
+		b2Assert(c->m_fixtureA == fixtureA);
+
+		c->m_flags = record.flags;
+		c->m_manifold = record.manifold;
+		c->m_toiCount = record.toiCount;
+		c->m_toi = record.toi;
+		c->m_friction = record.friction;
+		c->m_restitution = record.restitution;
+		c->m_restitutionThreshold = record.restitutionThreshold;
+		c->m_tangentSpeed = record.tangentSpeed;
+		if (b2IsPolygonContact(c))
+		{
+			b2PolygonContact* pc = (b2PolygonContact*)c;
+			pc->m_axisCache = record.axisCache;
+			pc->m_relativeTransform = record.relativeTransform;
+		}
+		m_contactManager.InsertContact(c);
+	}
+
+	reader.Skip(m_contactManager.m_broadPhase.RestoreState(reader.buffer + reader.count));
+	reader.Skip(sensorManager.m_tree.RestoreState(reader.buffer + reader.count));
+
+	for (int32 i = 0; i < header.sensorCount; ++i)
+	{
+		b2Sensor* sensor = sensorManager.m_sensors + i;
+		reader.Read(&sensor->overlapCount, sizeof(int32));
+		if (sensor->overlapCount > sensor->overlapCapacity)
+		{
+			b2Free(sensor->overlaps);
+			sensor->overlapCapacity = b2Max(sensor->overlapCapacity, 4);
+			while (sensor->overlapCapacity < sensor->overlapCount)
+			{
+				sensor->overlapCapacity *= 2;
+			}
+			sensor->overlaps = (b2SensorOverlap*)b2Alloc(sensor->overlapCapacity * sizeof(b2SensorOverlap));
+		}
+
+		for (int32 j = 0; j < sensor->overlapCount; ++j)
+		{
+			b2OverlapSnapshot record;
+			reader.Read(&record, sizeof(record));
+			b2SensorOverlap* overlap = sensor->overlaps + j;
+			overlap->proxy = m_fixtureSlots.Get(record.fixture)->m_proxies + record.childIndex;
+			overlap->proxyId = record.proxyId;
+			overlap->childId = record.childId;
+		}
+
+		sensor->candidateCount = 0;
+	}
+
+	sensorManager.m_refilter = header.refilter != 0;
+
+	m_inv_dt0 = header.inv_dt0;
+	m_newContacts = header.newContacts != 0;
+	m_stepComplete = header.stepComplete != 0;
+
+	// Buffered contact events point at the destroyed contacts.
+	m_contactManager.ClearEvents();
+
+	return true;
+}
+
+int32 b2World::GetInterpolatedTransforms(float alpha, b2Transform* transforms, int32 capacity) const
+{
+	int32 count = b2Min(capacity, m_currentTransforms.GetCount());
+	const b2Transform* xf1 = m_previousTransforms.GetData();
+	const b2Transform* xf2 = m_currentTransforms.GetData();
+	float beta = 1.0f - alpha;
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Transform xf;
+		xf.p = beta * xf1[i].p + alpha * xf2[i].p;
+
+		// Rotations change little per step, so nlerp is close to slerp.
+		float s = beta * xf1[i].q.s + alpha * xf2[i].q.s;
+		float c = beta * xf1[i].q.c + alpha * xf2[i].q.c;
+		float invLength = 1.0f / b2Sqrt(s * s + c * c);
+		xf.q.s = s * invLength;
+		xf.q.c = c * invLength;
+
+		transforms[i] = xf;
+	}
+
+	return count;
+}
+
+void b2World::SetTransforms(const int32* bodyIndices, const b2Vec2* positions, const float* angles, int32 count)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked() || count <= 0)
+	{
+		return;
+	}
+
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(count * sizeof(b2Body*));
+	int32 bodyCount = 0;
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		// The indices come from the caller, skip the ones that name no body.
+		b2Body* b = m_bodySlots.Find(bodyIndices[i]);
+		if (b == nullptr)
+		{
+			continue;
+		}
+
+		bodies[bodyCount++] = b;
+
+		float angle = angles[i];
+		b->m_xf.q.Set(angle);
+		b->m_xf.p = positions[i];
+
+		b->m_sweep.c = b2Mul(b->m_xf, b->m_sweep.localCenter);
+		b->m_sweep.a = angle;
+		b->m_sweep.q = b->m_xf.q;
+
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = angle;
+		b->m_sweep.q0 = b->m_xf.q;
+
+		MarkMoved(b);
+		ResetInterpolation(b);
+	}
+
+	// Sync after all transforms are written so a body listed twice only uses its last
+	// transform. Moving the same proxy again is cheap because the fat AABB contains it.
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		if (b->m_compound)
+		{
+			b->m_compound->Synchronize(broadPhase, b->m_xf, b->m_xf);
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->Synchronize(broadPhase, b->m_xf, b->m_xf);
+		}
+	}
+
+	m_stackAllocator.Free(bodies);
+
+	// Check for new contacts the next step
+	m_newContacts = true;
+}
+
+void b2World::SetVelocities(const int32* bodyIndices, const b2Vec2* linearVelocities, const float* angularVelocities, int32 count)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = m_bodySlots.Find(bodyIndices[i]);
+		if (b == nullptr || b->m_type == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2Vec2 v = linearVelocities[i];
+		float w = angularVelocities ? angularVelocities[i] : b->m_angularVelocity;
+		if (b2Dot(v, v) > 0.0f || w * w > 0.0f)
+		{
+			b->SetAwake(true);
+		}
+
+		b->m_linearVelocity = v;
+		b->m_angularVelocity = w;
+	}
+}
+
+void b2World::ApplyForces(const int32* bodyIndices, const b2Vec2* forces, const float* torques, int32 count, bool wake)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = m_bodySlots.Find(bodyIndices[i]);
+		if (b == nullptr || b->m_type != b2_dynamicBody)
+		{
+			continue;
+		}
+
+		if (wake && (b->m_flags & b2Body::e_awakeFlag) == 0)
+		{
+			b->SetAwake(true);
+		}
+
+		// Don't accumulate a force if the body is sleeping
+		if (b->m_flags & b2Body::e_awakeFlag)
+		{
+			b->m_force += forces[i];
+			if (torques)
+			{
+				b->m_torque += torques[i];
+			}
+		}
+	}
+}
+
+// These live on the caller's stack so concurrent queries share no state.
+struct b2QueryFunctionCallback : public b2QueryCallback
+{
+	bool ReportFixture(b2Fixture* fixture) override
+	{
+		return fcn(fixture, context);
+	}
+
+	b2QueryFixtureFunction* fcn;
+	void* context;
+};
+
+struct b2QueryArrayCallback : public b2QueryCallback
+{
+	bool ReportFixture(b2Fixture* fixture) override
+	{
+		fixtures[count++] = fixture;
+		return count < capacity;
+	}
+
+	b2Fixture** fixtures;
+	int32 count;
+	int32 capacity;
+};
+
+struct b2RayCastFunctionCallback : public b2RayCastCallback
+{
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		return fcn(fixture, point, normal, fraction, context);
+	}
+
+	b2RayCastFixtureFunction* fcn;
+	void* context;
+};
+
+struct b2RayCastClosestCallback : public b2RayCastCallback
+{
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		hit->fixture = fixture;
+		hit->point = point;
+		hit->normal = normal;
+		hit->fraction = fraction;
+		found = true;
+		return fraction;
+	}
+
+	b2RayCastHit* hit;
+	bool found;
+};
+
+void b2World::QueryAABB(b2QueryFixtureFunction* fcn, void* context, const b2AABB& aabb) const
+{
+	b2QueryFunctionCallback callback;
+	callback.fcn = fcn;
+	callback.context = context;
+	QueryAABB(&callback, aabb);
+}
+
+int32 b2World::QueryAABB(const b2AABB& aabb, b2Fixture** fixtures, int32 capacity) const
+{
+	if (capacity <= 0)
+	{
+		return 0;
+	}
+
+	b2QueryArrayCallback callback;
+	callback.fixtures = fixtures;
+	callback.count = 0;
+	callback.capacity = capacity;
+	QueryAABB(&callback, aabb);
+	return callback.count;
+}
+
+void b2World::RayCast(b2RayCastFixtureFunction* fcn, void* context, const b2Vec2& point1, const b2Vec2& point2) const
+{
+	b2RayCastFunctionCallback callback;
+	callback.fcn = fcn;
+	callback.context = context;
+	RayCast(&callback, point1, point2);
+}
+
+bool b2World::RayCastClosest(const b2Vec2& point1, const b2Vec2& point2, b2RayCastHit* hit) const
+{
+	b2RayCastHit closest;
+	b2RayCastClosestCallback callback;
+	callback.hit = &closest;
+	callback.found = false;
+	RayCast(&callback, point1, point2);
+
+	if (callback.found)
+	{
+		*hit = closest;
+	}
+
+	return callback.found;
+}
+
+void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
+{
+	switch (fixture->GetType())
+	{
+	case b2Shape::e_circle:
+		{
+			b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+
+			b2Vec2 center = b2Mul(xf, circle->m_p);
+			float radius = circle->m_radius;
+			b2Vec2 axis = b2Mul(xf.q, b2Vec2(1.0f, 0.0f));
+
+			m_debugDraw->DrawSolidCircle(center, radius, axis, color);
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			b2EdgeShape* edge = (b2EdgeShape*)fixture->GetShape();
+			b2Vec2 v1 = b2Mul(xf, edge->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf, edge->m_vertex2);
+			m_debugDraw->DrawSegment(v1, v2, color);
+
+			if (edge->m_oneSided == false)
+			{
+				m_debugDraw->DrawPoint(v1, 4.0f, color);
+				m_debugDraw->DrawPoint(v2, 4.0f, color);
+			}
+		}
+		break;
+
+	case b2Shape::e_chain:
+	case b2Shape::e_mesh:
+		{
+			b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
+			int32 count = chain->m_count;
+			const b2Vec2* vertices = chain->m_vertices;
+
+			b2Vec2 v1 = b2Mul(xf, vertices[0]);
+			for (int32 i = 1; i < count; ++i)
+			{
+				b2Vec2 v2 = b2Mul(xf, vertices[i]);
+				m_debugDraw->DrawSegment(v1, v2, color);
+				v1 = v2;
+			}
+		}
+		break;
+
+	case b2Shape::e_heightField:
+		{
+			b2HeightFieldShape* heightField = (b2HeightFieldShape*)fixture->GetShape();
+			int32 count = heightField->m_count;
+			float spacing = heightField->m_spacing;
+			const float* heights = heightField->m_heights;
+
+			b2Vec2 v1 = b2Mul(xf, b2Vec2(0.0f, heights[0]));
+			for (int32 i = 1; i < count; ++i)
+			{
+				b2Vec2 v2 = b2Mul(xf, b2Vec2(i * spacing, heights[i]));
+				m_debugDraw->DrawSegment(v1, v2, color);
+				v1 = v2;
+			}
+		}
+		break;
+
+	case b2Shape::e_polygon:
+		{
+			b2PolygonShape* poly = (b2PolygonShape*)fixture->GetShape();
+			int32 vertexCount = poly->m_count;
+			b2Assert(vertexCount <= b2_maxPolygonVertices);
+			b2Vec2 vertices[b2_maxPolygonVertices];
+
+			for (int32 i = 0; i < vertexCount; ++i)
+			{
+				vertices[i] = b2Mul(xf, poly->m_vertices[i]);
+			}
+
+			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* capsule = (b2CapsuleShape*)fixture->GetShape();
+			b2Vec2 v1 = b2Mul(xf, capsule->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf, capsule->m_vertex2);
+			float radius = capsule->m_radius;
+
+			b2Vec2 axis = v2 - v1;
+			axis.Normalize();
+			b2Vec2 offset = radius * b2Vec2(axis.y, -axis.x);
+
+			m_debugDraw->DrawSolidCircle(v1, radius, -axis, color);
+			m_debugDraw->DrawSolidCircle(v2, radius, axis, color);
+			m_debugDraw->DrawSegment(v1 + offset, v2 + offset, color);
+			m_debugDraw->DrawSegment(v1 - offset, v2 - offset, color);
+		}
+		break;
+
+	default:
+	break;
+	}
+}
+
+void b2World::DebugDraw()
+{
+	if (m_debugDraw == nullptr)
+	{
+		return;
+	}
+
+	uint32 flags = m_debugDraw->GetFlags();
+
+	if (flags & b2Draw::e_shapeBit)
+	{
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			const b2Transform& xf = b->GetTransform();
+			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+			{
+				if (b->GetType() == b2_dynamicBody && b->m_mass == 0.0f)
+				{
+					// Bad body
+					DrawShape(f, xf, b2Color(1.0f, 0.0f, 0.0f));
+				}
+				else if (b->IsEnabled() == false)
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.3f));
+				}
+				else if (b->GetType() == b2_staticBody)
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.9f, 0.5f));
+				}
+				else if (b->GetType() == b2_kinematicBody)
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.9f));
+				}
+				else if (b->IsAwake() == false)
+				{
+					DrawShape(f, xf, b2Color(0.6f, 0.6f, 0.6f));
+				}
+				else
+				{
+					DrawShape(f, xf, b2Color(0.9f, 0.7f, 0.7f));
+				}
+			}
+		}
+	}
+
+	if (flags & b2Draw::e_jointBit)
+	{
+		for (b2Joint* j = m_jointList; j; j = j->GetNext())
+		{
+			j->Draw(m_debugDraw);
+		}
+	}
+
+	if (flags & b2Draw::e_pairBit)
+	{
+		b2Color color(0.3f, 0.9f, 0.9f);
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->GetNext())
+		{
+			b2Fixture* fixtureA = c->GetFixtureA();
+			b2Fixture* fixtureB = c->GetFixtureB();
+			int32 indexA = c->GetChildIndexA();
+			int32 indexB = c->GetChildIndexB();
+			b2Vec2 cA;
+			if (fixtureA->GetType() == b2Shape::e_mesh)
+			{
+				// Child index A is the mesh segment.
+				b2AABB segmentAABB;
+				((b2MeshShape*)fixtureA->GetShape())->ComputeSegmentAABB(&segmentAABB, fixtureA->GetBody()->GetTransform(), indexA);
+				cA = segmentAABB.GetCenter();
+			}
+			else if (fixtureA->GetType() == b2Shape::e_heightField)
+			{
+				// Child index A is the height field cell.
+				b2AABB cellAABB;
+				((b2HeightFieldShape*)fixtureA->GetShape())->ComputeCellAABB(&cellAABB, fixtureA->GetBody()->GetTransform(), indexA);
+				cA = cellAABB.GetCenter();
+			}
+			else if (fixtureA->GetBody()->IsCompound())
+			{
+				cA = m_contactManager.GetFatAABB(fixtureA->m_proxies + indexA).GetCenter();
+			}
+			else
+			{
+				cA = fixtureA->GetAABB(indexA).GetCenter();
+			}
+
+			// Fixture AABBs of a compound body are in body coordinates.
+			b2Vec2 cB;
+			if (fixtureB->GetBody()->IsCompound())
+			{
+				cB = m_contactManager.GetFatAABB(fixtureB->m_proxies + indexB).GetCenter();
+			}
+			else
+			{
+				cB = fixtureB->GetAABB(indexB).GetCenter();
+			}
+
+			m_debugDraw->DrawSegment(cA, cB, color);
+		}
+	}
+
+	if (flags & b2Draw::e_aabbBit)
+	{
+		b2Color color(0.9f, 0.3f, 0.9f);
+		b2BroadPhase* bp = &m_contactManager.m_broadPhase;
+
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			if (b->IsEnabled() == false)
+			{
 				continue;
 			}
 
+			const b2Compound* compound = b->m_compound;
+			if (compound && compound->m_proxy.proxyId != b2BroadPhase::e_nullProxy)
+			{
+				b2AABB aabb = bp->GetFatAABB(compound->m_proxy.proxyId);
+				b2Vec2 vs[4];
+				vs[0].Set(aabb.lowerBound.x, aabb.lowerBound.y);
+				vs[1].Set(aabb.upperBound.x, aabb.lowerBound.y);
+				vs[2].Set(aabb.upperBound.x, aabb.upperBound.y);
+				vs[3].Set(aabb.lowerBound.x, aabb.upperBound.y);
+
+				m_debugDraw->DrawPolygon(vs, 4, color);
+			}
+
 			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
 			{
 				for (int32 i = 0; i < f->m_proxyCount; ++i)
 				{
 					b2FixtureProxy* proxy = f->m_proxies + i;
-					b2AABB aabb = bp->GetFatAABB(proxy->proxyId);
+					b2AABB aabb = f->m_isSensor ? m_contactManager.m_sensorManager.m_tree.GetFatAABB(proxy->proxyId) : m_contactManager.GetFatAABB(proxy);
 					b2Vec2 vs[4];
 					vs[0].Set(aabb.lowerBound.x, aabb.lowerBound.y);
 					vs[1].Set(aabb.upperBound.x, aabb.lowerBound.y);
@@ -1249,12 +2971,43 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 		b->m_sweep.c -= newOrigin;
 	}
 
+	for (int32 i = 0; i < m_currentTransforms.GetCount(); ++i)
+	{
+		m_previousTransforms[i].p -= newOrigin;
+		m_currentTransforms[i].p -= newOrigin;
+	}
+
 	for (b2Joint* j = m_jointList; j; j = j->m_next)
 	{
 		j->ShiftOrigin(newOrigin);
 	}
 
 	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
+	m_contactManager.m_sensorManager.m_tree.ShiftOrigin(newOrigin);
+}
+
+bool b2World::Compact(int32 maxNodeMoves)
+{
+	b2Assert(m_locked == false);
+	if (m_locked)
+	{
+		return false;
+	}
+
+	// Fixture proxies are told about their new ids through the contact manager.
+	bool done = m_contactManager.m_broadPhase.Compact(&m_contactManager, maxNodeMoves);
+
+	// Solid proxy ids are the sort keys of sensor overlaps.
+	m_contactManager.m_sensorManager.SortOverlaps();
+	done = m_contactManager.m_sensorManager.Compact(maxNodeMoves) && done;
+
+	// Sorting the free lists is the expensive part, so only do it once the tree is done.
+	if (done)
+	{
+		m_blockAllocator.Compact();
+	}
+
+	return done;
 }
 
 void b2World::Dump()
@@ -0,0 +1,62 @@
+import XCTest
+import box2d
+
+final class BulkBodyTests: XCTestCase {
+
+    func testInvalidIndicesAreSkipped() {
+        let world = createStackWorld()
+        let body = createBox(world, 10, 5)
+        let destroyed = createBox(world, 12, 5)
+        let destroyedIndex = destroyed.GetIndex()
+        world.DestroyBody(destroyed)
+
+        let indices: [Int32] = [-1, destroyedIndex, body.GetIndex(), world.GetBodyCapacity(), 1 << 20]
+        let positions = [b2Vec2](repeating: b2Vec2(20, 3), count: indices.count)
+        let angles = [Float](repeating: 0.5, count: indices.count)
+        let velocities = [b2Vec2](repeating: b2Vec2(1, 2), count: indices.count)
+        let forces = [b2Vec2](repeating: b2Vec2(0, 5), count: indices.count)
+
+        world.SetTransforms(indices, positions, angles, Int32(indices.count))
+        world.SetVelocities(indices, velocities, nil, Int32(indices.count))
+        world.ApplyForces(indices, forces, nil, Int32(indices.count), true)
+
+        XCTAssertEqual(body.GetPosition().x, 20)
+        XCTAssertEqual(body.GetPosition().y, 3)
+        XCTAssertEqual(body.GetAngle(), 0.5)
+        XCTAssertEqual(body.GetLinearVelocity().x, 1)
+        XCTAssertEqual(body.GetLinearVelocity().y, 2)
+        XCTAssertNil(world.GetBody(destroyedIndex))
+        XCTAssertNil(world.GetBody(-1))
+        XCTAssertNil(world.GetBody(world.GetBodyCapacity()))
+        step(world, 10)
+    }
+
+    /// SetTransforms behaves like a loop over b2Body::SetTransform, which leaves a
+    /// sleeping body asleep.
+    func testSetTransformsMatchesSetTransform() {
+        var worlds: [b2World] = []
+        var boxes: [b2Body] = []
+        for _ in 0..<2 {
+            let world = b2World.CreateWorld(b2Vec2(0, -10))
+            createGround(world)
+            boxes.append(createBox(world, 0, 0.5))
+            step(world, 120)
+            worlds.append(world)
+        }
+        XCTAssertFalse(boxes[0].IsAwake())
+
+        boxes[0].SetTransform(b2Vec2(5, 0.5), 0)
+        var index = boxes[1].GetIndex()
+        var position = b2Vec2(5, 0.5)
+        var angle: Float = 0
+        worlds[1].SetTransforms(&index, &position, &angle, 1)
+
+        XCTAssertFalse(boxes[0].IsAwake())
+        XCTAssertFalse(boxes[1].IsAwake())
+        for _ in 0..<30 {
+            step(worlds[0], 1)
+            step(worlds[1], 1)
+            XCTAssertEqual(worlds[0].GetStateHash(), worlds[1].GetStateHash())
+        }
+    }
+}
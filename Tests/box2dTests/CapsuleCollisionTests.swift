@@ -0,0 +1,29 @@
+import XCTest
+import box2d
+
+final class CapsuleCollisionTests: XCTestCase {
+
+    /// Capsules meeting end to end have collinear cores, so clipping finds no points
+    /// and the contact must come from the closest points of the cores.
+    func testCollinearCapsulesEndToEnd() {
+        let capsuleA = b2CapsuleShape.Create()!
+        let capsuleB = b2CapsuleShape.Create()!
+        capsuleA.Set(b2Vec2(0, 0), b2Vec2(1, 0), 0.5)
+        capsuleB.Set(b2Vec2(0, 0), b2Vec2(1, 0), 0.5)
+
+        let xfA = b2Transform(b2Vec2(0, 0), b2Rot(0))
+
+        for offset: Float in [0, 0.0003, -0.0003] {
+            var manifold = b2Manifold()
+            let xfB = b2Transform(b2Vec2(1.5, offset), b2Rot(0))
+            b2CollideCapsules(&manifold, capsuleA, xfA, capsuleB, xfB)
+            XCTAssertEqual(manifold.pointCount, 1, "offset \(offset)")
+        }
+
+        // Apart along the same line
+        var manifold = b2Manifold()
+        let xfB = b2Transform(b2Vec2(2.5, 0), b2Rot(0))
+        b2CollideCapsules(&manifold, capsuleA, xfA, capsuleB, xfB)
+        XCTAssertEqual(manifold.pointCount, 0)
+    }
+}
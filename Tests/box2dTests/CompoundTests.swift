@@ -0,0 +1,29 @@
+import XCTest
+import box2d
+
+final class CompoundTests: XCTestCase {
+
+    /// The compound proxy must cover every fixture, including the one created last.
+    /// Only that fixture is over the ledge, so the body falls if it is left out.
+    func testProxyCoversLastFixture() {
+        let world = b2World.CreateWorld(b2Vec2(0, -10))
+        createBox(world, 10, -0.5, halfWidth: 1, halfHeight: 0.5, type: b2_staticBody)
+
+        var bodyDef = b2BodyDef()
+        bodyDef.type = b2_dynamicBody
+        bodyDef.compound = true
+        bodyDef.fixedRotation = true
+        bodyDef.position = b2Vec2(0, 2)
+        let body = world.CreateBody(&bodyDef)!
+
+        let box = b2PolygonShape.Create()!
+        box.SetAsBox(0.5, 0.5)
+        body.CreateFixture(asShape(box), 1)
+        box.SetAsBox(0.5, 0.5, b2Vec2(10, 0), 0)
+        body.CreateFixture(asShape(box), 1)
+
+        step(world, 90)
+        XCTAssertEqual(body.GetPosition().y, 0.5, accuracy: 0.05)
+        XCTAssertEqual(world.GetContactCount(), 1)
+    }
+}
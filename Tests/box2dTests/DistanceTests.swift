@@ -0,0 +1,145 @@
+import XCTest
+import box2d
+
+final class DistanceTests: XCTestCase {
+
+    private func createCircle(_ radius: Float, _ center: b2Vec2 = b2Vec2(0, 0)) -> b2Shape {
+        let circle = b2CircleShape.Create()!
+        circle.m_p = center
+        let shape = asShape(circle)
+        shape.m_radius = radius
+        return shape
+    }
+
+    private func createPolygon(_ halfWidth: Float, _ halfHeight: Float,
+                               _ center: b2Vec2 = b2Vec2(0, 0), _ angle: Float = 0) -> b2Shape {
+        let box = b2PolygonShape.Create()!
+        box.SetAsBox(halfWidth, halfHeight, center, angle)
+        return asShape(box)
+    }
+
+    private func distance(_ shapeA: b2Shape, _ xfA: b2Transform, _ shapeB: b2Shape, _ xfB: b2Transform,
+                          useRadii: Bool = true) -> b2DistanceOutput {
+        var input = b2DistanceInput()
+        input.proxyA.Set(shapeA, 0)
+        input.proxyB.Set(shapeB, 0)
+        input.transformA = xfA
+        input.transformB = xfB
+        input.useRadii = useRadii
+        var cache = b2SimplexCache()
+        var output = b2DistanceOutput()
+        b2Distance(&output, &cache, &input)
+        return output
+    }
+
+    private func assertEqual(_ a: b2Vec2, _ b: b2Vec2, accuracy: Float, _ message: String = "",
+                             file: StaticString = #filePath, line: UInt = #line) {
+        XCTAssertEqual(a.x, b.x, accuracy: accuracy, message, file: file, line: line)
+        XCTAssertEqual(a.y, b.y, accuracy: accuracy, message, file: file, line: line)
+    }
+
+    func testCircleCircle() {
+        let circleA = createCircle(0.5)
+        let circleB = createCircle(0.25, b2Vec2(1, 0))
+        let xfA = b2Transform(b2Vec2(0, 0), b2Rot(0))
+        let xfB = b2Transform(b2Vec2(2, 0), b2Rot(0))
+
+        let output = distance(circleA, xfA, circleB, xfB)
+        XCTAssertEqual(output.distance, 2.25, accuracy: 1e-5)
+        assertEqual(output.pointA, b2Vec2(0.5, 0), accuracy: 1e-5)
+        assertEqual(output.pointB, b2Vec2(2.75, 0), accuracy: 1e-5)
+
+        let centers = distance(circleA, xfA, circleB, xfB, useRadii: false)
+        XCTAssertEqual(centers.distance, 3, accuracy: 1e-5)
+    }
+
+    /// Polygons carry the b2_polygonRadius skin, so compare the core distances.
+    func testBoxBox() {
+        let box = createPolygon(0.5, 0.5)
+        let xfA = b2Transform(b2Vec2(0, 0), b2Rot(0))
+
+        // Parallel faces
+        let faces = distance(box, xfA, box, b2Transform(b2Vec2(3, 0.2), b2Rot(0)), useRadii: false)
+        XCTAssertEqual(faces.distance, 2, accuracy: 1e-5)
+
+        // A corner of the rotated box faces the side of the other box.
+        let corner = distance(box, xfA, box, b2Transform(b2Vec2(3, 0), b2Rot(0.25 * Float.pi)), useRadii: false)
+        XCTAssertEqual(corner.distance, 2.5 - 0.5 * Float(2).squareRoot(), accuracy: 1e-5)
+        assertEqual(corner.pointB, b2Vec2(3 - 0.5 * Float(2).squareRoot(), 0), accuracy: 1e-5)
+
+        // Corner to corner along the diagonal
+        let diagonal = distance(box, xfA, box, b2Transform(b2Vec2(2, 2), b2Rot(0)), useRadii: false)
+        XCTAssertEqual(diagonal.distance, Float(2).squareRoot(), accuracy: 1e-5)
+        assertEqual(diagonal.pointA, b2Vec2(0.5, 0.5), accuracy: 1e-5)
+    }
+
+    /// Random circle and polygon pairs from a fixed seed, more pairs than one parallel
+    /// range holds.
+    private func createInputs(_ count: Int) -> [b2ShapeDistanceInput] {
+        var seed: UInt32 = 12345
+        func random(_ lower: Float, _ upper: Float) -> Float {
+            seed = seed &* 1664525 &+ 1013904223
+            return lower + (upper - lower) * Float(seed >> 8) / Float(1 << 24)
+        }
+
+        var shapes: [b2Shape] = []
+        for i in 0..<24 {
+            if i % 2 == 0 {
+                shapes.append(createCircle(random(0.1, 1), b2Vec2(random(-0.5, 0.5), random(-0.5, 0.5))))
+            } else {
+                shapes.append(createPolygon(random(0.1, 1), random(0.1, 1),
+                                            b2Vec2(random(-0.3, 0.3), 0), random(0, 3)))
+            }
+        }
+
+        var inputs: [b2ShapeDistanceInput] = []
+        for i in 0..<count {
+            var input = b2ShapeDistanceInput()
+            input.shapeA = shapes[i % shapes.count]
+            input.shapeB = shapes[(i * 7 + 3) % shapes.count]
+            input.childIndexA = 0
+            input.childIndexB = 0
+            input.transformA = b2Transform(b2Vec2(random(-3, 3), random(-3, 3)), b2Rot(random(-3, 3)))
+            input.transformB = b2Transform(b2Vec2(random(-3, 3), random(-3, 3)), b2Rot(random(-3, 3)))
+            input.useRadii = i % 2 == 0
+            inputs.append(input)
+        }
+        return inputs
+    }
+
+    private func distanceMany(_ inputs: [b2ShapeDistanceInput], _ executor: SwiftTaskExecutor?) -> [b2DistanceOutput] {
+        var outputs = [b2DistanceOutput](repeating: b2DistanceOutput(), count: inputs.count)
+        var caches = [b2SimplexCache](repeating: b2SimplexCache(), count: inputs.count)
+        b2DistanceMany(&outputs, &caches, inputs, Int32(inputs.count), executor)
+        return outputs
+    }
+
+    /// Closed form pairs may differ from GJK in the last bits, so compare with a tolerance.
+    func testDistanceManyMatchesDistance() {
+        let inputs = createInputs(1000)
+        let serial = distanceMany(inputs, nil)
+
+        let executor = ThreadedExecutor()
+        let parallel = distanceMany(inputs, executor.executor)
+        XCTAssertEqual(executor.loopCount, 1)
+
+        for i in 0..<inputs.count {
+            let input = inputs[i]
+            let expected = distance(input.shapeA!, input.transformA, input.shapeB!, input.transformB,
+                                    useRadii: input.useRadii)
+
+            XCTAssertEqual(serial[i].distance, expected.distance, accuracy: 1e-4, "pair \(i)")
+            if expected.distance > 0 {
+                assertEqual(serial[i].pointA, expected.pointA, accuracy: 1e-3, "pair \(i)")
+                assertEqual(serial[i].pointB, expected.pointB, accuracy: 1e-3, "pair \(i)")
+            }
+
+            // The executor only splits the pairs, the results are the same.
+            XCTAssertEqual(parallel[i].distance, serial[i].distance, "pair \(i)")
+            XCTAssertEqual(parallel[i].pointA.x, serial[i].pointA.x, "pair \(i)")
+            XCTAssertEqual(parallel[i].pointA.y, serial[i].pointA.y, "pair \(i)")
+            XCTAssertEqual(parallel[i].pointB.x, serial[i].pointB.x, "pair \(i)")
+            XCTAssertEqual(parallel[i].pointB.y, serial[i].pointB.y, "pair \(i)")
+        }
+    }
+}
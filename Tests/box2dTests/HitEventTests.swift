@@ -0,0 +1,70 @@
+import XCTest
+import box2d
+
+final class HitEventTests: XCTestCase {
+
+    private final class Recorder {
+        var points: [b2Vec2] = []
+        var hits: [b2ContactHitEvent] = []
+        var listener: SwiftContactListener2D!
+
+        init() {
+            listener = SwiftContactListener2D.Create(UnsafeRawPointer(Unmanaged.passUnretained(self).toOpaque()))
+            listener.m_PreSolve = { userData, contact, _ in
+                let recorder = Unmanaged<Recorder>.fromOpaque(userData!).takeUnretainedValue()
+                var worldManifold = b2WorldManifold()
+                contact!.GetWorldManifold(&worldManifold)
+                let count = Int(contact!.GetManifold()!.pointee.pointCount)
+                recorder.points = Array([worldManifold.points.0, worldManifold.points.1].prefix(count))
+            }
+            listener.m_ContactHit = { userData, _, event in
+                let recorder = Unmanaged<Recorder>.fromOpaque(userData!).takeUnretainedValue()
+                recorder.hits.append(event!.pointee)
+            }
+        }
+
+        deinit {
+            SwiftContactListener2D.Destroy(listener)
+        }
+    }
+
+    /// A box lands while sliding fast. The hit point must be the manifold point the
+    /// solver started from, not one shifted by the motion of the step.
+    func testHitPointIsTheManifoldPoint() {
+        let world = b2World.CreateWorld(b2Vec2(0, -10))
+        world.SetContinuousPhysics(false)
+        let recorder = Recorder()
+        world.SetContactListener(recorder.listener)
+
+        // Created before the ground, so the moving box is fixture A.
+        var bodyDef = b2BodyDef()
+        bodyDef.type = b2_dynamicBody
+        bodyDef.position = b2Vec2(0, 0.6)
+        bodyDef.linearVelocity = b2Vec2(20, -3)
+        let body = world.CreateBody(&bodyDef)!
+        let box = b2PolygonShape.Create()!
+        box.SetAsBox(0.5, 0.5)
+        var fixtureDef = b2FixtureDef()
+        fixtureDef.shape = asShape(box)
+        fixtureDef.density = 1
+        fixtureDef.enableHitEvents = true
+        body.CreateFixture(&fixtureDef)
+        createGround(world)
+
+        for _ in 0..<30 {
+            let hitCount = recorder.hits.count
+            step(world, 1)
+            guard recorder.hits.count > hitCount else {
+                continue
+            }
+
+            let hit = recorder.hits[hitCount]
+            XCTAssertEqual(hit.fixtureA!.GetBody()!.GetType(), b2_dynamicBody)
+            let closest = recorder.points.map { b2Distance(hit.point, $0) }.min() ?? .infinity
+            XCTAssertLessThan(closest, 1e-5)
+        }
+
+        XCTAssertEqual(recorder.hits.count, 1)
+        world.SetContactListener(nil)
+    }
+}
@@ -0,0 +1,75 @@
+import XCTest
+import box2d
+
+final class ManifoldReuseTests: XCTestCase {
+
+    /// A triangle resting on a box without gravity, so only the test moves it. The
+    /// manifold is computed in the first step.
+    private func createWorld() -> (b2World, b2Body) {
+        let world = b2World.CreateWorld(b2Vec2(0, 0))
+        world.SetManifoldReuseTolerance(0.05, 0.05)
+        createBox(world, 0, 0, halfWidth: 2, halfHeight: 0.5, type: b2_staticBody)
+
+        var bodyDef = b2BodyDef()
+        bodyDef.type = b2_dynamicBody
+        bodyDef.position = b2Vec2(0.3, 1.015)
+        let body = world.CreateBody(&bodyDef)!
+        let triangle = b2PolygonShape.Create()!
+        let vertices = [b2Vec2(-0.5, -0.5), b2Vec2(0.5, -0.5), b2Vec2(0, 0.8)]
+        triangle.Set(vertices, Int32(vertices.count))
+        body.CreateFixture(asShape(triangle), 1)
+
+        step(world, 1)
+        XCTAssertTrue(world.GetContactList()!.IsTouching())
+        XCTAssertEqual(world.GetProfile().manifoldReuses, 0)
+        return (world, body)
+    }
+
+    /// The manifold of the only contact computed from scratch at the current transforms.
+    private func computeManifold(_ world: b2World) -> b2Manifold {
+        let contact = world.GetContactList()!
+        let fixtureA = contact.GetFixtureA()!
+        let fixtureB = contact.GetFixtureB()!
+        var manifold = b2Manifold()
+        b2CollidePolygons(&manifold,
+                          unsafeBitCast(fixtureA.GetShape()!, to: b2PolygonShape.self), fixtureA.GetBody()!.GetTransform(),
+                          unsafeBitCast(fixtureB.GetShape()!, to: b2PolygonShape.self), fixtureB.GetBody()!.GetTransform())
+        return manifold
+    }
+
+    /// Moving less than the tolerances keeps the manifold, even though the tilt lifts
+    /// one corner out of reach and a new manifold would only have one point. Rotating
+    /// past the angular tolerance computes it again.
+    func testSmallMotionKeepsManifold() {
+        let (world, body) = createWorld()
+        let original = world.GetContactList()!.GetManifold()!.pointee
+
+        body.SetTransform(b2Vec2(body.GetPosition().x + 0.02, body.GetPosition().y), 0.02)
+        let moved = computeManifold(world)
+        XCTAssertEqual(original.pointCount, 2)
+        XCTAssertEqual(moved.pointCount, 1)
+        step(world, 1)
+        XCTAssertEqual(world.GetProfile().manifoldReuses, 1)
+        assertSameManifold(world.GetContactList()!.GetManifold()!.pointee, original)
+
+        body.SetTransform(body.GetPosition(), 0.3)
+        let rotated = computeManifold(world)
+        step(world, 1)
+        XCTAssertEqual(world.GetProfile().manifoldReuses, 0)
+        assertSameManifold(world.GetContactList()!.GetManifold()!.pointee, rotated)
+    }
+
+    /// The sine of a half turn is as small as the sine of no turn at all, but the
+    /// triangle now stands on its tip and the manifold must change.
+    func testHalfTurnRecomputes() {
+        let (world, body) = createWorld()
+        let original = world.GetContactList()!.GetManifold()!.pointee
+
+        body.SetTransform(body.GetPosition(), Float.pi)
+        let turned = computeManifold(world)
+        XCTAssertNotEqual(turned.points.0.localPoint.x, original.points.0.localPoint.x)
+        step(world, 1)
+        XCTAssertEqual(world.GetProfile().manifoldReuses, 0)
+        assertSameManifold(world.GetContactList()!.GetManifold()!.pointee, turned)
+    }
+}
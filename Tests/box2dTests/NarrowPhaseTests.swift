@@ -0,0 +1,151 @@
+import XCTest
+import box2d
+
+final class NarrowPhaseTests: XCTestCase {
+
+    private struct ContactEvent: Equatable {
+        var begin: Bool
+        var fixtureA: Int32
+        var childA: Int32
+        var fixtureB: Int32
+        var childB: Int32
+    }
+
+    private struct ManifoldRecord: Equatable {
+        var touching: Bool
+        var type: Int
+        var values: [Float]
+        var keys: [UInt32]
+    }
+
+    private struct StepRecord: Equatable {
+        var events: [ContactEvent]
+        var manifolds: [ManifoldRecord]
+    }
+
+    private final class Recorder {
+        var events: [ContactEvent] = []
+        var listener: SwiftContactListener2D!
+
+        init() {
+            listener = SwiftContactListener2D.Create(UnsafeRawPointer(Unmanaged.passUnretained(self).toOpaque()))
+            listener.m_BeginContact = { userData, contact in
+                let recorder = Unmanaged<Recorder>.fromOpaque(userData!).takeUnretainedValue()
+                recorder.record(contact!, begin: true)
+            }
+            listener.m_EndContact = { userData, contact in
+                let recorder = Unmanaged<Recorder>.fromOpaque(userData!).takeUnretainedValue()
+                recorder.record(contact!, begin: false)
+            }
+        }
+
+        deinit {
+            SwiftContactListener2D.Destroy(listener)
+        }
+
+        func record(_ contact: b2Contact, begin: Bool) {
+            events.append(ContactEvent(begin: begin,
+                                       fixtureA: contact.GetFixtureA()!.GetId().index, childA: contact.GetChildIndexA(),
+                                       fixtureB: contact.GetFixtureB()!.GetId().index, childB: contact.GetChildIndexB()))
+        }
+    }
+
+    /// Circles, boxes, capsules and hexagons fall on a height field and a ground box, so
+    /// the batches cover every pair of these shape types.
+    private func createWorld() -> b2World {
+        let world = b2World.CreateWorld(b2Vec2(0, -10))
+        createGround(world)
+
+        var terrainDef = b2BodyDef()
+        terrainDef.position = b2Vec2(-20, 0)
+        let terrain = world.CreateBody(&terrainDef)!
+        let heights = (0..<41).map { 1 + sin(0.7 * Float($0)) }
+        let heightField = b2HeightFieldShape.Create()!
+        heightField.CreateHeights(heights, Int32(heights.count), 1, -1, 3)
+        terrain.CreateFixture(asShape(heightField), 0)
+
+        let hexagon = (0..<6).map { b2Vec2(0.5 * cos(Float.pi / 3 * Float($0)), 0.5 * sin(Float.pi / 3 * Float($0))) }
+        for i in 0..<160 {
+            var bodyDef = b2BodyDef()
+            bodyDef.type = b2_dynamicBody
+            bodyDef.position = b2Vec2(-18 + Float(i % 20) * 1.8, 4 + Float(i / 20) * 1.6)
+            bodyDef.angle = 0.3 * Float(i)
+            let body = world.CreateBody(&bodyDef)!
+
+            switch i % 4 {
+            case 0:
+                let circle = b2CircleShape.Create()!
+                let shape = asShape(circle)
+                shape.m_radius = 0.4
+                body.CreateFixture(shape, 1)
+            case 1:
+                let box = b2PolygonShape.Create()!
+                box.SetAsBox(0.5, 0.3)
+                body.CreateFixture(asShape(box), 1)
+            case 2:
+                let capsule = b2CapsuleShape.Create()!
+                capsule.Set(b2Vec2(-0.4, 0), b2Vec2(0.4, 0), 0.25)
+                body.CreateFixture(asShape(capsule), 1)
+            default:
+                let polygon = b2PolygonShape.Create()!
+                polygon.Set(hexagon, Int32(hexagon.count))
+                body.CreateFixture(asShape(polygon), 1)
+            }
+        }
+        return world
+    }
+
+    private func run(_ world: b2World) -> [StepRecord] {
+        let recorder = Recorder()
+        world.SetContactListener(recorder.listener)
+        var steps: [StepRecord] = []
+        for _ in 0..<300 {
+            step(world, 1)
+
+            var manifolds: [ManifoldRecord] = []
+            var contact = world.GetContactList()
+            while let c = contact {
+                let manifold = c.GetManifold()!.pointee
+                let points = [manifold.points.0, manifold.points.1].prefix(Int(manifold.pointCount))
+                var values = [manifold.localNormal.x, manifold.localNormal.y, manifold.localPoint.x, manifold.localPoint.y]
+                values += points.flatMap { [$0.localPoint.x, $0.localPoint.y, $0.normalImpulse, $0.tangentImpulse] }
+                manifolds.append(ManifoldRecord(touching: c.IsTouching(), type: Int(manifold.type.rawValue),
+                                                values: values, keys: points.map { $0.id.key }))
+                contact = c.GetNext()
+            }
+
+            steps.append(StepRecord(events: recorder.events, manifolds: manifolds))
+            recorder.events.removeAll()
+        }
+        world.SetContactListener(nil)
+        return steps
+    }
+
+    /// Updating the contacts in batches grouped by shape pair must give the same
+    /// manifolds and the same begin and end events, in the same order, as updating
+    /// each contact on its own. This holds with and without an executor.
+    func testBatchedMatchesPerContact() {
+        let perContact = run(createWorld())
+
+        let world = createWorld()
+        world.SetBatchedNarrowPhase(true)
+        let batched = run(world)
+
+        let executor = ThreadedExecutor()
+        let threadedWorld = createWorld()
+        threadedWorld.SetBatchedNarrowPhase(true)
+        threadedWorld.SetTaskExecutor(executor.executor)
+        let threaded = run(threadedWorld)
+        threadedWorld.SetTaskExecutor(nil)
+
+        let events = perContact.flatMap { $0.events }
+        XCTAssertGreaterThan(events.filter { $0.begin }.count, 500)
+        XCTAssertGreaterThan(events.filter { !$0.begin }.count, 100)
+        XCTAssertGreaterThan(executor.loopCount, 0)
+
+        for i in 0..<perContact.count {
+            XCTAssertEqual(batched[i], perContact[i], "step \(i)")
+            XCTAssertEqual(threaded[i], perContact[i], "step \(i)")
+        }
+    }
+}
@@ -0,0 +1,49 @@
+import XCTest
+import box2d
+
+final class PolygonCollisionTests: XCTestCase {
+
+    /// The vector separating axis test performs the same operations in the same order
+    /// as the scalar loops, so the manifolds must match bit for bit. Random convex
+    /// polygons from a fixed seed, with three to eight vertices.
+    func testVectorMatchesScalar() {
+        var seed: UInt32 = 2024
+        func random(_ lower: Float, _ upper: Float) -> Float {
+            seed = seed &* 1664525 &+ 1013904223
+            return lower + (upper - lower) * Float(seed >> 8) / Float(1 << 24)
+        }
+
+        let polygonA = b2PolygonShape.Create()!
+        let polygonB = b2PolygonShape.Create()!
+        var touching = 0
+        for i in 0..<5000 {
+            for polygon in [polygonA, polygonB] {
+                let count = 3 + Int(random(0, 6))
+                var vertices: [b2Vec2] = []
+                for j in 0..<count {
+                    let angle = 2 * Float.pi * (Float(j) + random(0, 0.8)) / Float(count)
+                    let radius = random(0.2, 1.2)
+                    vertices.append(b2Vec2(radius * cos(angle), radius * sin(angle)))
+                }
+                polygon.Set(vertices, Int32(count))
+            }
+
+            let xfA = b2Transform(b2Vec2(random(-1, 1), random(-1, 1)), b2Rot(random(-3, 3)))
+            let xfB = b2Transform(b2Vec2(random(-1, 1), random(-1, 1)), b2Rot(random(-3, 3)))
+
+            var vector = b2Manifold()
+            var scalar = b2Manifold()
+            b2CollidePolygons(&vector, polygonA, xfA, polygonB, xfB)
+            b2CollidePolygonsScalar(&scalar, polygonA, xfA, polygonB, xfB)
+            assertSameManifold(vector, scalar, "pair \(i)")
+
+            if vector.pointCount > 0 {
+                touching += 1
+            }
+        }
+
+        // Both outcomes are covered.
+        XCTAssertGreaterThan(touching, 1000)
+        XCTAssertLessThan(touching, 4000)
+    }
+}
@@ -0,0 +1,88 @@
+import XCTest
+import box2d
+
+final class SensorTests: XCTestCase {
+
+    private struct OverlapEvent: Equatable {
+        var begin: Bool
+        var sensor: Int32
+        var visitor: Int32
+    }
+
+    private final class Recorder {
+        var events: [OverlapEvent] = []
+        var listener: SwiftContactListener2D!
+
+        init() {
+            listener = SwiftContactListener2D.Create(UnsafeRawPointer(Unmanaged.passUnretained(self).toOpaque()))
+            listener.m_BeginSensorOverlap = { userData, sensor, visitor in
+                let recorder = Unmanaged<Recorder>.fromOpaque(userData!).takeUnretainedValue()
+                recorder.events.append(OverlapEvent(begin: true, sensor: sensor!.GetId().index, visitor: visitor!.GetId().index))
+            }
+            listener.m_EndSensorOverlap = { userData, sensor, visitor in
+                let recorder = Unmanaged<Recorder>.fromOpaque(userData!).takeUnretainedValue()
+                recorder.events.append(OverlapEvent(begin: false, sensor: sensor!.GetId().index, visitor: visitor!.GetId().index))
+            }
+        }
+
+        deinit {
+            SwiftContactListener2D.Destroy(listener)
+        }
+    }
+
+    /// Boxes fall through a row of sensors, more sensors than one parallel range holds.
+    private func createWorld() -> b2World {
+        let world = b2World.CreateWorld(b2Vec2(0, -10))
+        createGround(world)
+
+        for i in 0..<48 {
+            var bodyDef = b2BodyDef()
+            bodyDef.position = b2Vec2(Float(i) * 0.8 - 19, 3)
+            let body = world.CreateBody(&bodyDef)!
+            let box = b2PolygonShape.Create()!
+            box.SetAsBox(0.35, 1)
+            var fixtureDef = b2FixtureDef()
+            fixtureDef.shape = asShape(box)
+            fixtureDef.isSensor = true
+            body.CreateFixture(&fixtureDef)
+        }
+
+        for i in 0..<60 {
+            createBox(world, Float(i % 30) * 1.3 - 19.5, 6 + Float(i / 30) * 1.5, angle: 0.1 * Float(i),
+                      halfWidth: 0.3, halfHeight: 0.3)
+        }
+        return world
+    }
+
+    private func run(_ world: b2World) -> [[OverlapEvent]] {
+        let recorder = Recorder()
+        world.SetContactListener(recorder.listener)
+        var steps: [[OverlapEvent]] = []
+        for _ in 0..<120 {
+            step(world, 1)
+            steps.append(recorder.events)
+            recorder.events.removeAll()
+        }
+        world.SetContactListener(nil)
+        return steps
+    }
+
+    /// The overlap queries run on the executor's threads. They must report the same
+    /// events in the same order as the serial queries.
+    func testParallelOverlapsMatchSerial() {
+        let serial = run(createWorld())
+
+        let executor = ThreadedExecutor()
+        let world = createWorld()
+        world.SetTaskExecutor(executor.executor)
+        let parallel = run(world)
+        world.SetTaskExecutor(nil)
+
+        XCTAssertGreaterThan(executor.loopCount, 0)
+        XCTAssertGreaterThan(serial.joined().filter { $0.begin }.count, 48)
+        XCTAssertGreaterThan(serial.joined().filter { !$0.begin }.count, 0)
+        for i in 0..<serial.count {
+            XCTAssertEqual(parallel[i], serial[i], "step \(i)")
+        }
+    }
+}
@@ -0,0 +1,80 @@
+import XCTest
+import box2d
+
+final class SnapshotTests: XCTestCase {
+
+    private func save(_ world: b2World) -> [UInt8] {
+        let size = world.SaveSnapshot(nil, 0)
+        var snapshot = [UInt8](repeating: 0, count: Int(size))
+        let written = snapshot.withUnsafeMutableBytes { world.SaveSnapshot($0.baseAddress, size) }
+        XCTAssertEqual(written, size)
+        return snapshot
+    }
+
+    private func restore(_ world: b2World, _ snapshot: [UInt8], size: Int? = nil) -> Bool {
+        snapshot.withUnsafeBytes { world.RestoreSnapshot($0.baseAddress, Int32(size ?? snapshot.count)) }
+    }
+
+    /// A stack with a motorized pendulum, so joint impulses are part of the state.
+    private func createWorld() -> (b2World, b2Body) {
+        let world = createStackWorld()
+        let pivot = createBox(world, 7, 4, halfWidth: 0.1, halfHeight: 0.1, type: b2_staticBody)
+        let arm = createBox(world, 8, 4, halfWidth: 1, halfHeight: 0.1)
+        var jointDef = b2RevoluteJointDef()
+        jointDef.Initialize(pivot, arm, b2Vec2(7, 4))
+        jointDef.enableMotor = true
+        jointDef.motorSpeed = 2
+        jointDef.maxMotorTorque = 20
+        createJoint(world, &jointDef)
+        return (world, arm)
+    }
+
+    func testRestoreReplaysTheSameSteps() {
+        let (world, _) = createWorld()
+        step(world, 30)
+        let snapshot = save(world)
+
+        var hashes: [UInt32] = []
+        for _ in 0..<60 {
+            step(world, 1)
+            hashes.append(world.GetStateHash())
+        }
+
+        for round in 0..<2 {
+            XCTAssertTrue(restore(world, snapshot))
+            for i in 0..<60 {
+                step(world, 1)
+                XCTAssertEqual(world.GetStateHash(), hashes[i], "round \(round) step \(i)")
+            }
+        }
+    }
+
+    /// A disabled body has no proxies, so the saved proxy records no longer line up.
+    func testEnabledFlagChangeRejectsSnapshot() {
+        let (world, arm) = createWorld()
+        step(world, 10)
+        let snapshot = save(world)
+        step(world, 10)
+        let hash = world.GetStateHash()
+
+        arm.SetEnabled(false)
+        XCTAssertFalse(restore(world, snapshot))
+        XCTAssertEqual(world.GetStateHash(), hash)
+
+        arm.SetEnabled(true)
+        XCTAssertTrue(restore(world, snapshot))
+    }
+
+    func testTruncatedSnapshotIsRejected() {
+        let (world, _) = createWorld()
+        step(world, 10)
+        let snapshot = save(world)
+        let hash = world.GetStateHash()
+
+        for size in [0, 16, snapshot.count / 2, snapshot.count - 1] {
+            XCTAssertFalse(restore(world, snapshot, size: size), "size \(size)")
+        }
+
+        XCTAssertEqual(world.GetStateHash(), hash)
+    }
+}
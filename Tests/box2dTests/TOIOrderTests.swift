@@ -0,0 +1,60 @@
+import XCTest
+import box2d
+
+final class TOIOrderTests: XCTestCase {
+
+    private final class Recorder {
+        var contacts: [ObjectIdentifier] = []
+        var listener: SwiftContactListener2D!
+
+        init() {
+            listener = SwiftContactListener2D.Create(UnsafeRawPointer(Unmanaged.passUnretained(self).toOpaque()))
+            listener.m_ContactHit = { userData, contact, _ in
+                let recorder = Unmanaged<Recorder>.fromOpaque(userData!).takeUnretainedValue()
+                recorder.contacts.append(ObjectIdentifier(contact!))
+            }
+        }
+
+        deinit {
+            SwiftContactListener2D.Destroy(listener)
+        }
+    }
+
+    /// Identical boxes fall through the ground in one step, so their TOI events tie. The
+    /// list scan that the event queue replaced solved ties in contact list order, and the
+    /// queue must do the same. Each TOI event reports one hit event.
+    func testEqualTimesOfImpactFollowContactOrder() {
+        let world = b2World.CreateWorld(b2Vec2(0, -10))
+        let recorder = Recorder()
+        world.SetContactListener(recorder.listener)
+        createGround(world)
+
+        for i in 0..<12 {
+            var bodyDef = b2BodyDef()
+            bodyDef.type = b2_dynamicBody
+            bodyDef.position = b2Vec2(Float(3 * i - 18), 0.3)
+            bodyDef.linearVelocity = b2Vec2(0, -150)
+            let body = world.CreateBody(&bodyDef)!
+            let box = b2PolygonShape.Create()!
+            box.SetAsBox(0.25, 0.25)
+            var fixtureDef = b2FixtureDef()
+            fixtureDef.shape = asShape(box)
+            fixtureDef.density = 1
+            fixtureDef.enableHitEvents = true
+            body.CreateFixture(&fixtureDef)
+        }
+
+        step(world, 1)
+        world.SetContactListener(nil)
+
+        var listOrder: [ObjectIdentifier] = []
+        var contact = world.GetContactList()
+        while let c = contact {
+            listOrder.append(ObjectIdentifier(c))
+            contact = c.GetNext()
+        }
+
+        XCTAssertEqual(listOrder.count, 12)
+        XCTAssertEqual(recorder.contacts, listOrder)
+    }
+}
@@ -0,0 +1,103 @@
+import Dispatch
+import XCTest
+import box2d
+
+/// The shape classes are imported without their b2Shape base, but share its address.
+func asShape<Shape: AnyObject>(_ shape: Shape) -> b2Shape {
+    unsafeBitCast(shape, to: b2Shape.self)
+}
+
+/// Create a joint from a concrete joint definition.
+func createJoint<Def>(_ world: b2World, _ def: inout Def) {
+    withUnsafePointer(to: &def) {
+        $0.withMemoryRebound(to: b2JointDef.self, capacity: 1) { _ = world.CreateJoint($0) }
+    }
+}
+
+@discardableResult
+func createBox(_ world: b2World, _ x: Float, _ y: Float, angle: Float = 0,
+               halfWidth: Float = 0.5, halfHeight: Float = 0.5, type: b2BodyType = b2_dynamicBody) -> b2Body {
+    var bodyDef = b2BodyDef()
+    bodyDef.type = type
+    bodyDef.position = b2Vec2(x, y)
+    bodyDef.angle = angle
+    let body = world.CreateBody(&bodyDef)!
+    let box = b2PolygonShape.Create()!
+    box.SetAsBox(halfWidth, halfHeight)
+    body.CreateFixture(asShape(box), 1)
+    return body
+}
+
+/// A static slab with its top at y = 0.
+@discardableResult
+func createGround(_ world: b2World) -> b2Body {
+    createBox(world, 0, -0.5, halfWidth: 40, halfHeight: 0.5, type: b2_staticBody)
+}
+
+/// A stack of boxes on the ground.
+func createStackWorld() -> b2World {
+    let world = b2World.CreateWorld(b2Vec2(0, -10))
+    _ = createGround(world)
+    for i in 0..<40 {
+        createBox(world, Float(i % 5) * 1.05 - 2, 0.5 + Float(i / 5) * 1.1, angle: 0.01 * Float(i))
+    }
+    return world
+}
+
+func step(_ world: b2World, _ count: Int) {
+    for _ in 0..<count {
+        world.Step(1.0 / 60.0, 8, 3)
+    }
+}
+
+/// Compare two manifolds bit for bit, ignoring the unused points and the impulses.
+func assertSameManifold(_ a: b2Manifold, _ b: b2Manifold, _ message: String = "",
+                        file: StaticString = #filePath, line: UInt = #line) {
+    XCTAssertEqual(a.pointCount, b.pointCount, message, file: file, line: line)
+    guard a.pointCount > 0, a.pointCount == b.pointCount else {
+        return
+    }
+
+    XCTAssertEqual(a.type, b.type, message, file: file, line: line)
+    XCTAssertEqual(a.localNormal.x, b.localNormal.x, message, file: file, line: line)
+    XCTAssertEqual(a.localNormal.y, b.localNormal.y, message, file: file, line: line)
+    XCTAssertEqual(a.localPoint.x, b.localPoint.x, message, file: file, line: line)
+    XCTAssertEqual(a.localPoint.y, b.localPoint.y, message, file: file, line: line)
+
+    let pointsA = [a.points.0, a.points.1]
+    let pointsB = [b.points.0, b.points.1]
+    for i in 0..<Int(a.pointCount) {
+        XCTAssertEqual(pointsA[i].localPoint.x, pointsB[i].localPoint.x, message, file: file, line: line)
+        XCTAssertEqual(pointsA[i].localPoint.y, pointsB[i].localPoint.y, message, file: file, line: line)
+        XCTAssertEqual(pointsA[i].id.key, pointsB[i].id.key, message, file: file, line: line)
+    }
+}
+
+/// Runs parallel loops on Dispatch worker threads and counts the loops it was given.
+/// Remove it from the world before releasing it.
+final class ThreadedExecutor {
+    private(set) var executor: SwiftTaskExecutor!
+    private(set) var loopCount = 0
+
+    init() {
+        executor = SwiftTaskExecutor.Create(UnsafeRawPointer(Unmanaged.passUnretained(self).toOpaque()))
+        executor.m_ParallelFor = { userData, task, itemCount, minRange, context in
+            let owner = Unmanaged<ThreadedExecutor>.fromOpaque(userData!).takeUnretainedValue()
+            owner.loopCount += 1
+
+            let rangeCount = max(1, min(4, Int(itemCount / max(minRange, 1))))
+            let rangeSize = (Int(itemCount) + rangeCount - 1) / rangeCount
+            DispatchQueue.concurrentPerform(iterations: rangeCount) { i in
+                let start = i * rangeSize
+                let end = min(start + rangeSize, Int(itemCount))
+                if start < end {
+                    task!(Int32(start), Int32(end), context)
+                }
+            }
+        }
+    }
+
+    deinit {
+        SwiftTaskExecutor.Destroy(executor)
+    }
+}